@@ -0,0 +1,157 @@
+/* cache.c, Recently browsed launch.dat records for x68Launcher.
+ Copyright (C) 2020  John Snowdon
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#ifndef __HAS_DATA
+#include "data.h"
+#define __HAS_DATA
+#endif
+#include "cache.h"
+
+int cache_Init(launchcache_t *cache, int size){
+	/* Allocate an empty cache of size launch.dat records */
+	
+	// A size of 0 (or less) disables the cache; cache_Get() then always reads from disk.
+	
+	cache->entries = NULL;
+	cache->hardware = NULL;
+	cache->gameids = NULL;
+	cache->used = NULL;
+	cache->size = 0;
+	cache->clock = 0;
+	cache->hits = 0;
+	cache->misses = 0;
+	
+	if (size < 1){
+		return CACHE_OK;
+	}
+	if (size > CACHE_MAX_SIZE){
+		size = CACHE_MAX_SIZE;
+	}
+	cache->entries = (launchdat_t *) malloc(size * sizeof(launchdat_t));
+	cache->hardware = (hwdata_t *) malloc(size * sizeof(hwdata_t));
+	cache->gameids = (int *) malloc(size * sizeof(int));
+	cache->used = (unsigned long *) malloc(size * sizeof(unsigned long));
+	if ((cache->entries == NULL) || (cache->hardware == NULL) || (cache->gameids == NULL) || (cache->used == NULL)){
+		// Carry on without a cache, rather than failing
+		cache_Free(cache);
+		return CACHE_ERR_MEM;
+	}
+	cache->size = size;
+	cache_Clear(cache);
+	if (CACHE_VERBOSE){
+		printf("%s.%d\t cache_Init() Allocated %d entries [%d bytes]\n", __FILE__, __LINE__, size, (int)(size * (sizeof(launchdat_t) + sizeof(hwdata_t) + sizeof(int) + sizeof(unsigned long))));
+	}
+	return CACHE_OK;
+}
+
+void cache_Clear(launchcache_t *cache){
+	/* Forget every cached record, e.g. when a rescan gives out new game ids */
+	
+	int i;
+	
+	for(i = 0; i < cache->size; i++){
+		cache->gameids[i] = -1;
+		cache->used[i] = 0;
+	}
+	cache->clock = 0;
+}
+
+void cache_Free(launchcache_t *cache){
+	/* Release the memory of the cache */
+	
+	free(cache->entries);
+	free(cache->hardware);
+	free(cache->gameids);
+	free(cache->used);
+	cache->entries = NULL;
+	cache->hardware = NULL;
+	cache->gameids = NULL;
+	cache->used = NULL;
+	cache->size = 0;
+}
+
+launchdat_t * cache_Find(launchcache_t *cache, int gameid){
+	/* Return the cached record of a game, or NULL, without counting it as a lookup */
+	
+	// The hardware pointer of the record is NULL; the record must not be changed.
+	
+	int i;
+	
+	for(i = 0; i < cache->size; i++){
+		if (cache->gameids[i] == gameid){
+			return &cache->entries[i];
+		}
+	}
+	return NULL;
+}
+
+int cache_Get(launchcache_t *cache, gamedata_t *gamedata, launchdat_t *launchdat){
+	/* Fill in launchdat for a game, from the cache if it was read recently, otherwise from disk */
+	
+	// Returns the same as getLaunchdata(). The hardware data is copied into whatever
+	// launchdat->hardware already points at. Only successful loads are cached, so a
+	// missing launch.dat is tried again the next time the game is selected.
+	
+	int i;
+	int status;
+	int oldest;
+	hwdata_t *hardware;
+	
+	cache->clock++;
+	oldest = 0;
+	for(i = 0; i < cache->size; i++){
+		if (cache->gameids[i] == gamedata->gameid){
+			hardware = launchdat->hardware;
+			memcpy(launchdat, &cache->entries[i], sizeof(launchdat_t));
+			launchdat->hardware = hardware;
+			if (hardware != NULL){
+				memcpy(hardware, &cache->hardware[i], sizeof(hwdata_t));
+			}
+			cache->used[i] = cache->clock;
+			cache->hits++;
+			if (CACHE_VERBOSE){
+				printf("%s.%d\t cache_Get() Hit for gameid %d in entry %d\n", __FILE__, __LINE__, gamedata->gameid, i);
+			}
+			return 0;
+		}
+		if (cache->used[i] < cache->used[oldest]){
+			oldest = i;
+		}
+	}
+	
+	cache->misses++;
+	status = getLaunchdata(gamedata, launchdat);
+	if ((status == 0) && (cache->size > 0)){
+		if (CACHE_VERBOSE){
+			printf("%s.%d\t cache_Get() Miss for gameid %d, replacing entry %d [gameid:%d]\n", __FILE__, __LINE__, gamedata->gameid, oldest, cache->gameids[oldest]);
+		}
+		memcpy(&cache->entries[oldest], launchdat, sizeof(launchdat_t));
+		cache->entries[oldest].hardware = NULL;
+		if (launchdat->hardware != NULL){
+			memcpy(&cache->hardware[oldest], launchdat->hardware, sizeof(hwdata_t));
+		} else {
+			memset(&cache->hardware[oldest], '\0', sizeof(hwdata_t));
+		}
+		cache->gameids[oldest] = gamedata->gameid;
+		cache->used[oldest] = cache->clock;
+	}
+	return status;
+}
@@ -0,0 +1,47 @@
+/* cache.h, Recently browsed launch.dat records for x68Launcher.
+ Copyright (C) 2020  John Snowdon
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __HAS_DATA
+#include "data.h"
+#define __HAS_DATA
+#endif
+
+#define CACHE_VERBOSE		0		// Enable/disable launch.dat cache verbose/debug output
+#define CACHE_MAX_SIZE		256		// Upper limit on metadata_cache
+
+// Return codes
+#define CACHE_OK			0
+#define CACHE_ERR_MEM		-1		// Unable to allocate memory
+
+// Parsed launch.dat of the most recently selected games
+typedef struct launchcache {
+	launchdat_t *entries;		// Parsed launch.dat of each entry; the hardware pointer is not used
+	hwdata_t *hardware;			// Hardware data of each entry
+	int *gameids;				// Game id of each entry, or -1 if the entry is empty
+	unsigned long *used;		// Value of clock when each entry was last looked up
+	int size;					// Number of entries; 0 if the cache is disabled
+	unsigned long clock;		// Bumped on every lookup, to find the least recently used entry
+	int hits;					// Lookups answered from the cache
+	int misses;					// Lookups that had to read the launch.dat from disk
+} __attribute__((__packed__)) __attribute__((aligned (2))) launchcache_t;
+
+// Function prototypes
+int		cache_Init(launchcache_t *cache, int size);
+void	cache_Clear(launchcache_t *cache);
+void	cache_Free(launchcache_t *cache);
+int		cache_Get(launchcache_t *cache, gamedata_t *gamedata, launchdat_t *launchdat);
+launchdat_t *	cache_Find(launchcache_t *cache, int gameid);
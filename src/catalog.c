@@ -0,0 +1,342 @@
+/* catalog.c, Binary game catalog cache for x68Launcher.
+ Copyright (C) 2020  John Snowdon
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <dos.h>
+
+#ifndef __HAS_DATA
+#include "data.h"
+#define __HAS_DATA
+#endif
+#include "catalog.h"
+#include "search.h"
+
+int catalog_LoadTrigrams(int f, catalog_header_t *header, gametable_t *gametable){
+	/* Read the trigram index that follows the records of the catalog file */
+	
+	// The game table must already be indexed, as every posting is checked against it.
+	// Returns CATALOG_ERR_INDEX, with no index loaded, if what was read does not add
+	// up; search_Fuzzy() trusts the offsets and postings, so they are never used.
+	
+	int status;
+	int i;
+	trigramindex_t *trigrams;
+	
+	trigrams = &gametable->trigrams;
+	search_FreeTrigrams(trigrams);
+	if (header->trigram_keys < 1){
+		// Nothing was saved; the index is built when it is first needed
+		return CATALOG_OK;
+	}
+	if (header->trigram_postings < 0){
+		return CATALOG_ERR_INDEX;
+	}
+	trigrams->keys = (unsigned short *) malloc(header->trigram_keys * sizeof(unsigned short));
+	trigrams->offsets = (long *) malloc((header->trigram_keys + 1) * sizeof(long));
+	trigrams->postings = (unsigned short *) malloc((header->trigram_postings + 1) * sizeof(unsigned short));
+	if ((trigrams->keys == NULL) || (trigrams->offsets == NULL) || (trigrams->postings == NULL)){
+		search_FreeTrigrams(trigrams);
+		return CATALOG_ERR_MEM;
+	}
+	
+	status = _dos_read(f, (char *) trigrams->keys, header->trigram_keys * sizeof(unsigned short));
+	if (status == (int)(header->trigram_keys * sizeof(unsigned short))){
+		status = _dos_read(f, (char *) trigrams->offsets, (header->trigram_keys + 1) * sizeof(long));
+		if (status == (int)((header->trigram_keys + 1) * sizeof(long))){
+			status = _dos_read(f, (char *) trigrams->postings, header->trigram_postings * sizeof(unsigned short));
+			if (status == (int)(header->trigram_postings * sizeof(unsigned short))){
+				trigrams->keys_size = header->trigram_keys;
+				trigrams->postings_size = header->trigram_postings;
+				
+				// Offsets must run from 0 to the number of postings without going
+				// backwards, and every posting must be a game in the table
+				status = CATALOG_OK;
+				if ((trigrams->offsets[0] != 0) || (trigrams->offsets[trigrams->keys_size] != trigrams->postings_size)){
+					status = CATALOG_ERR_INDEX;
+				}
+				for(i = 0; (i < trigrams->keys_size) && (status == CATALOG_OK); i++){
+					if (trigrams->offsets[i + 1] < trigrams->offsets[i]){
+						status = CATALOG_ERR_INDEX;
+					}
+				}
+				for(i = 0; (i < trigrams->postings_size) && (status == CATALOG_OK); i++){
+					if (trigrams->postings[i] >= gametable->ids_size){
+						status = CATALOG_ERR_INDEX;
+					}
+				}
+				if (status != CATALOG_OK){
+					if (CATALOG_VERBOSE){
+						printf("%s.%d\t catalog_LoadTrigrams() Trigram index is inconsistent, dropping it\n", __FILE__, __LINE__);
+					}
+					search_FreeTrigrams(trigrams);
+				}
+				return status;
+			}
+		}
+	}
+	if (CATALOG_VERBOSE){
+		printf("%s.%d\t catalog_LoadTrigrams() Short read of trigram index\n", __FILE__, __LINE__);
+	}
+	search_FreeTrigrams(trigrams);
+	return CATALOG_ERR_READ;
+}
+
+int catalog_SaveTrigrams(int f, trigramindex_t *trigrams){
+	/* Write the trigram index out after the records of the catalog file */
+	
+	int status;
+	
+	if (trigrams->keys_size < 1){
+		return CATALOG_OK;
+	}
+	status = _dos_write(f, (char *) trigrams->keys, trigrams->keys_size * sizeof(unsigned short));
+	if (status != (int)(trigrams->keys_size * sizeof(unsigned short))){
+		return CATALOG_ERR_WRITE;
+	}
+	status = _dos_write(f, (char *) trigrams->offsets, (trigrams->keys_size + 1) * sizeof(long));
+	if (status != (int)((trigrams->keys_size + 1) * sizeof(long))){
+		return CATALOG_ERR_WRITE;
+	}
+	status = _dos_write(f, (char *) trigrams->postings, trigrams->postings_size * sizeof(unsigned short));
+	if (status != (int)(trigrams->postings_size * sizeof(unsigned short))){
+		return CATALOG_ERR_WRITE;
+	}
+	return CATALOG_OK;
+}
+
+int catalog_Load(config_t *config, gametable_t *gametable, int *changed){
+	/* Load the sorted list of games from the catalog file, appending each one to the game table */
+
+	// Returns the number of games loaded, or one of the CATALOG_ERR_ codes if the catalog
+	// is missing, damaged or was built with a different configuration - in which
+	// case the caller should fall back to scraping the game directories.
+	// changed: set to the number of game search paths whose date and time no longer
+	//          match those recorded in the catalog.
+
+	int f;
+	int i;
+	int status;
+	catalog_header_t header;
+	catalog_record_t *records;
+	catalog_record_t *record;
+	gamedata_t *gamedata;
+	gamedir_t *gamedir;
+
+	*changed = 0;
+	f = _dos_open(CATALOGFILE, 0);
+	if (f < 0){
+		if (CATALOG_VERBOSE){
+			printf("%s.%d\t catalog_Load() No catalog file [%s]\n", __FILE__, __LINE__, CATALOGFILE);
+		}
+		return CATALOG_ERR_OPEN;
+	}
+
+	status = _dos_read(f, (char *) &header, sizeof(catalog_header_t));
+	if (status != sizeof(catalog_header_t)){
+		_dos_close(f);
+		return CATALOG_ERR_READ;
+	}
+
+	if ((strncmp(header.magic, CATALOG_MAGIC, sizeof(header.magic)) != 0) || (header.version != CATALOG_VERSION) || (header.record_size != sizeof(catalog_record_t))){
+		if (CATALOG_VERBOSE){
+			printf("%s.%d\t catalog_Load() Catalog version mismatch [version:%d]\n", __FILE__, __LINE__, header.version);
+		}
+		_dos_close(f);
+		return CATALOG_ERR_VERSION;
+	}
+
+	// Any change to the search paths or name preloading makes the catalog stale
+	if ((header.preload_names != config->preload_names) || (strncmp(header.dirs, config->dirs, MAX_SEARCHDIRS_SIZE) != 0)){
+		if (CATALOG_VERBOSE){
+			printf("%s.%d\t catalog_Load() Catalog was built with different settings\n", __FILE__, __LINE__);
+		}
+		_dos_close(f);
+		return CATALOG_ERR_CONFIG;
+	}
+
+	if (header.games < 1){
+		_dos_close(f);
+		return CATALOG_ERR_READ;
+	}
+
+	// Has anything been added to, or removed from, any of the search paths?
+	i = 0;
+	gamedir = config->dir;
+	while ((gamedir != NULL) && (gamedir->next != NULL) && (i < MAX_DIRS)){
+		gamedir = gamedir->next;
+		if ((gamedir->stamp == 0) || (gamedir->stamp != header.dir_stamps[i])){
+			if (CATALOG_VERBOSE){
+				printf("%s.%d\t catalog_Load() Search path %s has changed\n", __FILE__, __LINE__, gamedir->path);
+			}
+			*changed += 1;
+		}
+		i++;
+	}
+
+	// All of the records are pulled in with one sequential read
+	records = (catalog_record_t *) malloc(header.games * sizeof(catalog_record_t));
+	if (records == NULL){
+		_dos_close(f);
+		return CATALOG_ERR_MEM;
+	}
+	status = _dos_read(f, (char *) records, header.games * sizeof(catalog_record_t));
+	if (status != (int)(header.games * sizeof(catalog_record_t))){
+		if (CATALOG_VERBOSE){
+			printf("%s.%d\t catalog_Load() Short read [%d of %d bytes]\n", __FILE__, __LINE__, status, (int)(header.games * sizeof(catalog_record_t)));
+		}
+		_dos_close(f);
+		free(records);
+		return CATALOG_ERR_READ;
+	}
+
+	// Records are stored in sorted order, so just add them on the end of the table
+	for(i = 0; i < header.games; i++){
+		record = &records[i];
+		record->path[MAX_PATH_SIZE - 1] = '\0';
+		record->name[MAX_NAME_SIZE - 1] = '\0';
+		gamedata = addGamedata(gametable);
+		if (gamedata == NULL){
+			_dos_close(f);
+			free(records);
+			return CATALOG_ERR_MEM;
+		}
+		if ((setGamedataPath(gametable, gamedata, record->path) != 0) || (setGamedataName(gametable, gamedata, record->name) != 0)){
+			_dos_close(f);
+			free(records);
+			return CATALOG_ERR_MEM;
+		}
+		gamedata->gameid = record->gameid;
+		gamedata->drive = record->drive;
+		gamedata->has_dat = record->has_dat;
+		gamedata->dat_size = record->dat_size;
+		gamedata->stamp = record->stamp;
+	}
+	free(records);
+	if (indexGamedata(gametable) < 0){
+		_dos_close(f);
+		return CATALOG_ERR_MEM;
+	}
+	
+	// The trigram index is read straight into place, rather than being built again.
+	// A damaged index is dropped; the games are still good, and the index is built
+	// again the first time a fuzzy search needs it.
+	status = catalog_LoadTrigrams(f, &header, gametable);
+	_dos_close(f);
+	if ((status != CATALOG_OK) && (status != CATALOG_ERR_INDEX)){
+		return status;
+	}
+
+	if (CATALOG_VERBOSE){
+		printf("%s.%d\t catalog_Load() Loaded %d games from %s\n", __FILE__, __LINE__, header.games, CATALOGFILE);
+	}
+	return header.games;
+}
+
+int catalog_Save(config_t *config, gametable_t *gametable){
+	/* Write the (already sorted) table of games out to the catalog file */
+
+	int f;
+	int i;
+	int n;
+	int status;
+	catalog_header_t header;
+	catalog_record_t *records;
+	catalog_record_t *record;
+	gamedata_t *gamedata;
+	gamedir_t *gamedir;
+
+	memset(&header, '\0', sizeof(catalog_header_t));
+	strcpy(header.magic, CATALOG_MAGIC);
+	header.version = CATALOG_VERSION;
+	header.record_size = sizeof(catalog_record_t);
+	header.preload_names = config->preload_names;
+	header.games = gametable->size;
+	header.trigram_keys = gametable->trigrams.keys_size;
+	header.trigram_postings = gametable->trigrams.postings_size;
+	strncpy(header.dirs, config->dirs, MAX_SEARCHDIRS_SIZE);
+	i = 0;
+	gamedir = config->dir;
+	while ((gamedir != NULL) && (gamedir->next != NULL) && (i < MAX_DIRS)){
+		gamedir = gamedir->next;
+		header.dir_stamps[i] = gamedir->stamp;
+		i++;
+	}
+
+	// Records are gathered up and written CATALOG_SAVE_RECORDS at a time, rather than one DOS call each
+	records = (catalog_record_t *) malloc(CATALOG_SAVE_RECORDS * sizeof(catalog_record_t));
+	if (records == NULL){
+		return CATALOG_ERR_MEM;
+	}
+
+	_dos_delete(CATALOGFILE);
+	f = _dos_create(CATALOGFILE, 0x8000);
+	if (f < 0){
+		if (CATALOG_VERBOSE){
+			printf("%s.%d\t catalog_Save() Unable to create %s [status:%d]\n", __FILE__, __LINE__, CATALOGFILE, f);
+		}
+		free(records);
+		return CATALOG_ERR_OPEN;
+	}
+
+	status = _dos_write(f, (char *) &header, sizeof(catalog_header_t));
+	if (status != sizeof(catalog_header_t)){
+		_dos_close(f);
+		_dos_delete(CATALOGFILE);
+		free(records);
+		return CATALOG_ERR_WRITE;
+	}
+
+	n = 0;
+	for(i = 0; i < gametable->size; i++){
+		gamedata = &gametable->games[i];
+		record = &records[n];
+		memset(record, '\0', sizeof(catalog_record_t));
+		record->gameid = gamedata->gameid;
+		record->drive = gamedata->drive;
+		getGamedataPath(gamedata, record->path);
+		strncpy(record->name, gamedata->name, MAX_NAME_SIZE - 1);
+		record->has_dat = gamedata->has_dat;
+		record->dat_size = gamedata->dat_size;
+		record->stamp = gamedata->stamp;
+		n++;
+		if ((n == CATALOG_SAVE_RECORDS) || (i == gametable->size - 1)){
+			status = _dos_write(f, (char *) records, n * sizeof(catalog_record_t));
+			if (status != (int)(n * sizeof(catalog_record_t))){
+				// Never leave a truncated catalog behind
+				_dos_close(f);
+				_dos_delete(CATALOGFILE);
+				free(records);
+				return CATALOG_ERR_WRITE;
+			}
+			n = 0;
+		}
+	}
+	free(records);
+	if (catalog_SaveTrigrams(f, &gametable->trigrams) != CATALOG_OK){
+		_dos_close(f);
+		_dos_delete(CATALOGFILE);
+		return CATALOG_ERR_WRITE;
+	}
+	_dos_close(f);
+
+	if (CATALOG_VERBOSE){
+		printf("%s.%d\t catalog_Save() Saved %d games to %s\n", __FILE__, __LINE__, header.games, CATALOGFILE);
+	}
+	return header.games;
+}
@@ -0,0 +1,70 @@
+/* catalog.h, Binary game catalog cache for x68Launcher.
+ Copyright (C) 2020  John Snowdon
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __HAS_DATA
+#include "data.h"
+#define __HAS_DATA
+#endif
+
+#define CATALOGFILE			"launcher.cat"		// Binary cache of the scraped and sorted game list
+#define CATALOG_MAGIC		"X68LCAT"			// 7 characters + end-of-string
+#define CATALOG_VERSION		5					// Bump this whenever the header or record layout changes
+#define CATALOG_VERBOSE		0					// Enable/disable catalog verbose/debug output
+#define CATALOG_SAVE_RECORDS	128				// Records written by each _dos_write() when saving
+
+// Return codes
+#define CATALOG_OK			0
+#define CATALOG_ERR_OPEN		-1				// No catalog file, or unable to create one
+#define CATALOG_ERR_READ		-2				// Short read or corrupt catalog
+#define CATALOG_ERR_VERSION	-3				// Catalog written by a different version of the launcher
+#define CATALOG_ERR_CONFIG	-4				// Catalog built with different gamedirs or preload_names settings
+#define CATALOG_ERR_WRITE	-5				// Unable to write catalog
+#define CATALOG_ERR_MEM		-6				// Unable to allocate memory
+#define CATALOG_ERR_INDEX	-7				// Trigram index is inconsistent; it is built again when needed
+
+// Header at the start of the catalog file
+typedef struct catalog_header {
+	char magic[8];						// CATALOG_MAGIC
+	unsigned short version;				// CATALOG_VERSION
+	unsigned short record_size;			// sizeof(catalog_record_t) at the time of writing
+	short preload_names;				// Value of config->preload_names at the time of writing
+	int games;							// Number of catalog_record_t entries following the header
+	char dirs[MAX_SEARCHDIRS_SIZE];		// Value of config->dirs at the time of writing
+	unsigned long dir_stamps[MAX_DIRS];	// Date and time of each game search path at the time of writing
+	int trigram_keys;					// Number of trigrams in the fuzzy search index following the records
+	long trigram_postings;				// Number of postings in the fuzzy search index
+} __attribute__((__packed__)) __attribute__((aligned (2))) catalog_header_t;
+
+// The records are followed by the trigram index: trigram_keys keys (unsigned short),
+// trigram_keys + 1 offsets (long) and trigram_postings postings (unsigned short).
+
+// A single game, as stored on disk
+typedef struct catalog_record {
+	int gameid;
+	char drive;
+	char path[MAX_PATH_SIZE];
+	char name[MAX_NAME_SIZE];
+	int has_dat;
+	unsigned short dat_size;
+	unsigned long stamp;
+} __attribute__((__packed__)) __attribute__((aligned (2))) catalog_record_t;
+
+// Function prototypes
+int		catalog_Load(config_t *config, gametable_t *gametable, int *changed);
+int		catalog_Save(config_t *config, gametable_t *gametable);
+int		catalog_LoadTrigrams(int f, catalog_header_t *header, gametable_t *gametable);
+int		catalog_SaveTrigrams(int f, trigramindex_t *trigrams);
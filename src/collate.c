@@ -0,0 +1,89 @@
+/* collate.c, Natural, case-insensitive ordering of names for x68Launcher.
+ Copyright (C) 2020  John Snowdon
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <string.h>
+#include <ctype.h>
+
+#include "collate.h"
+
+void collate_Key(const char *s, unsigned char *key){
+	/* Write the sort key of a name to key, which must be COLLATE_KEY_SIZE bytes */
+	
+	// Keys compare with memcmp(), and put names in the order a person would
+	// expect: case is ignored, a leading "The " is skipped and runs of digits
+	// compare by value, so "Game 2" comes before "Game 10".
+	// A run of digits becomes COLLATE_NUMBER, the number of digits (leading zeros
+	// dropped) and then the digits, so a shorter number is always smaller.
+	// Unused bytes are zero, so a name sorts before any longer name it starts.
+	
+	const unsigned char *p;
+	const unsigned char *digits;
+	int len;
+	int n;
+	
+	memset(key, '\0', COLLATE_KEY_SIZE);
+	p = (const unsigned char *) s;
+	for(n = 0; (COLLATE_ARTICLE[n] != '\0') && (tolower(p[n]) == COLLATE_ARTICLE[n]); n++){
+	}
+	if ((COLLATE_ARTICLE[n] == '\0') && (p[n] != '\0')){
+		p += n;
+	}
+	
+	len = 0;
+	while ((*p != '\0') && (len < COLLATE_KEY_SIZE)){
+		if (isdigit(*p)){
+			while ((*p == '0') && isdigit(p[1])){
+				p++;
+			}
+			digits = p;
+			while (isdigit(*p)){
+				p++;
+			}
+			n = p - digits;
+			if (len < COLLATE_KEY_SIZE){
+				key[len++] = COLLATE_NUMBER;
+			}
+			if (len < COLLATE_KEY_SIZE){
+				key[len++] = (n > 0xFF) ? 0xFF : n;
+			}
+			while ((digits < p) && (len < COLLATE_KEY_SIZE)){
+				key[len++] = *digits++;
+			}
+		} else {
+			if (*p >= 0x80){
+				// Shift-JIS and other 8 bit characters are kept as they are
+				key[len++] = *p;
+			} else if (*p >= ' '){
+				key[len++] = tolower(*p);
+			}
+			p++;
+		}
+	}
+}
+
+int collate_Compare(const char *a, const char *b){
+	/* Compare two names in natural, case-insensitive order; less than, equal to or more than 0 */
+	
+	// For sorting many names, build each key once with collate_Key() instead.
+	
+	unsigned char key_a[COLLATE_KEY_SIZE];
+	unsigned char key_b[COLLATE_KEY_SIZE];
+	
+	collate_Key(a, key_a);
+	collate_Key(b, key_b);
+	return memcmp(key_a, key_b, COLLATE_KEY_SIZE);
+}
@@ -0,0 +1,24 @@
+/* collate.h, Natural, case-insensitive ordering of names for x68Launcher.
+ Copyright (C) 2020  John Snowdon
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#define COLLATE_KEY_SIZE		32		// Bytes in a sort key; names that differ only after this are equal
+#define COLLATE_NUMBER		0x30	// Marks a run of digits in a key; the same as '0', so numbers sort before letters
+#define COLLATE_ARTICLE		"the "	// Leading word ignored when ordering names
+
+// Function prototypes
+void	collate_Key(const char *s, unsigned char *key);
+int		collate_Compare(const char *a, const char *b);
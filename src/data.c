@@ -18,6 +18,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include <dos.h>
 
 #include "ini.h"
@@ -26,30 +27,211 @@
 #define __HAS_DATA
 #endif
 #include "fstools.h"
+#include "meta.h"
+#include "search.h"
+#include "sort.h"
+#include "collate.h"
 #ifndef __HAS_MAIN
 #include "main.h"
 #define __HAS_MAIN
 #endif
 
-gamedata_t * getGameid(int gameid, gamedata_t *gamedata){
-	// Find a given gameid from the list	
+gamedata_t * getGameid(int gameid, gametable_t *gametable){
+	// Find a given gameid from the game table
 	
-	while (gamedata->next != NULL){
-		if (gamedata->gameid == gameid){
-			return gamedata;
+	// This is a direct lookup in the id index built by indexGamedata(), as it is
+	// called for every line of the browser pane on every page change.
+	
+	int pos;
+	
+	if ((gameid < 0) || (gameid >= gametable->ids_size)){
+		return NULL;
+	}
+	pos = gametable->ids[gameid];
+	if (pos < 0){
+		return NULL;
+	}
+	return &gametable->games[pos];
+}
+
+int indexGamedata(gametable_t *gametable){
+	/* (Re)build the gameid to table position index used by getGameid() */
+	
+	// Must be called whenever the table has been added to or re-ordered.
+	// Game IDs are handed out sequentially by findDirs(), so a plain
+	// array indexed by gameid is all that is needed.
+	
+	int i;
+	int max_id;
+	
+	if (gametable->ids != NULL){
+		free(gametable->ids);
+		gametable->ids = NULL;
+		gametable->ids_size = 0;
+	}
+	
+	max_id = -1;
+	for(i = 0; i < gametable->size; i++){
+		if (gametable->games[i].gameid > max_id){
+			max_id = gametable->games[i].gameid;
 		}
-		gamedata = gamedata->next;
 	}
-	return NULL;
+	if (max_id < 0){
+		return 0;
+	}
+	
+	gametable->ids = (int *) malloc((max_id + 1) * sizeof(int));
+	if (gametable->ids == NULL){
+		if (DATA_VERBOSE){
+			printf("%s.%d\t indexGamedata() Unable to allocate index for %d ids\n", __FILE__, __LINE__, max_id + 1);
+		}
+		return -1;
+	}
+	gametable->ids_size = max_id + 1;
+	for(i = 0; i < gametable->ids_size; i++){
+		gametable->ids[i] = -1;
+	}
+	for(i = 0; i < gametable->size; i++){
+		if (gametable->games[i].gameid >= 0){
+			gametable->ids[gametable->games[i].gameid] = i;
+		}
+	}
+	
+	// Any metadata or search index under the old ids is no longer valid
+	if (meta_Reset(&gametable->meta, gametable->ids_size) != META_OK){
+		return -1;
+	}
+	search_Free(&gametable->search);
+	search_FreeTrigrams(&gametable->trigrams);
+	sort_Free(&gametable->sort);
+	
+	if (DATA_VERBOSE){
+		printf("%s.%d\t indexGamedata() Indexed %d games [%d ids]\n", __FILE__, __LINE__, gametable->size, gametable->ids_size);
+	}
+	return gametable->size;
 }
 
-gamedata_t * getLastGamedata(gamedata_t *gamedata){
-	/* Given a gamedata item, find the last entry of the list */
+char * getGamedataPath(gamedata_t *gamedata, char *buffer){
+	/* Write the full drive and path name of a game into buffer; e.g. A:\Games\FinalFight */
+	
+	// buffer must be at least MAX_PATH_SIZE bytes
 	
-	while (gamedata->next != NULL){
-		gamedata = gamedata->next;
+	snprintf(buffer, MAX_PATH_SIZE, "%s%s", gamedata->prefix, gamedata->dir);
+	return buffer;
+}
+
+int setGamedataPath(gametable_t *gametable, gamedata_t *gamedata, char *path){
+	/* Store the full path name of a game as a shared search path prefix and a directory name */
+	
+	char *dir;
+	
+	// Everything up to and including the last backslash is the prefix
+	dir = strrchr(path, '\\');
+	if (dir == NULL){
+		dir = path;
+	} else {
+		dir++;
 	}
-	return gamedata;
+	gamedata->prefix = strpool_AddPrefix(&gametable->strings, path, dir - path);
+	gamedata->dir = strpool_Add(&gametable->strings, dir);
+	if ((gamedata->prefix == NULL) || (gamedata->dir == NULL)){
+		return -1;
+	}
+	return 0;
+}
+
+int setGamedataName(gametable_t *gametable, gamedata_t *gamedata, char *name){
+	/* Store the display name of a game - re-using the directory name if it is the same */
+	
+	// setGamedataPath() must have been called first
+	
+	int len;
+	
+	if (strcmp(name, gamedata->dir) == 0){
+		gamedata->name = gamedata->dir;
+	} else {
+		len = strlen(name);
+		if (len > (MAX_NAME_SIZE - 1)){
+			len = MAX_NAME_SIZE - 1;
+		}
+		gamedata->name = strpool_AddLength(&gametable->strings, name, len);
+		if (gamedata->name == NULL){
+			return -1;
+		}
+	}
+	return 0;
+}
+
+void printGametableMemory(gametable_t *gametable){
+	/* Print how much memory the game table is using, and where */
+	
+	long total;
+	
+	total = (gametable->capacity * sizeof(gamedata_t)) + (gametable->ids_size * sizeof(int)) + gametable->strings.bytes_allocated;
+	total += (gametable->trigrams.keys_size * (sizeof(unsigned short) + sizeof(long))) + (gametable->trigrams.postings_size * sizeof(unsigned short));
+	total += (gametable->meta.size * 12) + (gametable->meta.strings_capacity * sizeof(char *)) + (gametable->meta.hash_size * sizeof(unsigned short)) + gametable->meta.pool.bytes_allocated;
+	total += gametable->sort.size * SORT_MAX * sizeof(unsigned short);
+	total += gametable->meta.years_size * sizeof(yearentry_t);
+	printf("%s.%d\t Memory - game table: %d/%d entries of %d bytes, %ld bytes\n", __FILE__, __LINE__, gametable->size, gametable->capacity, (int)sizeof(gamedata_t), (long)(gametable->capacity * sizeof(gamedata_t)));
+	printf("%s.%d\t Memory - gameid index: %d entries, %ld bytes\n", __FILE__, __LINE__, gametable->ids_size, (long)(gametable->ids_size * sizeof(int)));
+	printf("%s.%d\t Memory - strings: %d stored, %d prefixes shared, %ld bytes used, %ld bytes allocated\n", __FILE__, __LINE__, gametable->strings.strings, gametable->strings.shared, gametable->strings.bytes_used, gametable->strings.bytes_allocated);
+	printf("%s.%d\t Memory - trigram index: %d trigrams, %ld postings, %ld bytes\n", __FILE__, __LINE__, gametable->trigrams.keys_size, gametable->trigrams.postings_size, (long)((gametable->trigrams.keys_size * (sizeof(unsigned short) + sizeof(long))) + (gametable->trigrams.postings_size * sizeof(unsigned short))));
+	printf("%s.%d\t Memory - metadata index: %d games, %d strings interned, %ld bytes\n", __FILE__, __LINE__, gametable->meta.size, gametable->meta.strings_size, (long)((gametable->meta.size * 12) + (gametable->meta.strings_capacity * sizeof(char *)) + (gametable->meta.hash_size * sizeof(unsigned short)) + gametable->meta.pool.bytes_allocated));
+	printf("%s.%d\t Memory - year index: %d games, %ld bytes\n", __FILE__, __LINE__, gametable->meta.years_size, (long)(gametable->meta.years_size * sizeof(yearentry_t)));
+	printf("%s.%d\t Memory - sort orders: %d orders of %d games, %ld bytes\n", __FILE__, __LINE__, (gametable->sort.orders != NULL) ? SORT_MAX : 0, gametable->sort.size, (long)(gametable->sort.size * SORT_MAX * sizeof(unsigned short)));
+	if (gametable->size > 0){
+		printf("%s.%d\t Memory - total: %ld bytes, %ld bytes per game\n", __FILE__, __LINE__, total, total / gametable->size);
+	}
+}
+
+void initGametable(gametable_t *gametable){
+	/* Set up an empty game table - nothing is allocated until the first game is added */
+	
+	gametable->games = NULL;
+	gametable->size = 0;
+	gametable->capacity = 0;
+	gametable->ids = NULL;
+	gametable->ids_size = 0;
+	strpool_Init(&gametable->strings);
+	meta_Init(&gametable->meta);
+	search_Init(&gametable->search);
+	search_InitTrigrams(&gametable->trigrams);
+	sort_Init(&gametable->sort);
+}
+
+gamedata_t * addGamedata(gametable_t *gametable){
+	/* Append a new, zeroed, gamedata entry to the end of the game table */
+	
+	// The table doubles in size whenever it is full, so adding n games costs
+	// O(log n) reallocations rather than n separate allocations.
+	// Returns NULL if the table could not be grown. Any gamedata pointer taken
+	// from the table before this call may no longer be valid afterwards.
+	
+	int capacity;
+	gamedata_t *games;
+	
+	if (gametable->size >= gametable->capacity){
+		if (gametable->capacity == 0){
+			capacity = GAMETABLE_INITIAL_SIZE;
+		} else {
+			capacity = gametable->capacity * 2;
+		}
+		games = (gamedata_t *) realloc(gametable->games, capacity * sizeof(gamedata_t));
+		if (games == NULL){
+			if (DATA_VERBOSE){
+				printf("%s.%d\t addGamedata() Unable to grow game table to %d entries\n", __FILE__, __LINE__, capacity);
+			}
+			return NULL;
+		}
+		if (DATA_VERBOSE){
+			printf("%s.%d\t addGamedata() Game table grown to %d entries\n", __FILE__, __LINE__, capacity);
+		}
+		gametable->games = games;
+		gametable->capacity = capacity;
+	}
+	memset(&gametable->games[gametable->size], '\0', sizeof(gamedata_t));
+	gametable->size++;
+	return &gametable->games[gametable->size - 1];
 }
 
 gamedir_t * getLastGameDir(gamedir_t *gamedir){
@@ -61,161 +243,418 @@ gamedir_t * getLastGameDir(gamedir_t *gamedir){
 	return gamedir;
 }
 
-int removeGamedata(gamedata_t *gamedata){
-	/* Remove all nodes of a given imagefile list */
+static int comparePath(gamedata_t *gamedata, char *path){
+	// Compare the full path of a game with a path string, as strcmp() would,
+	// without having to join its prefix and directory name together first
 	
-	gamedata_t * current = gamedata;
-	gamedata_t * next = NULL;
+	int compare;
+	int len;
 	
-	if (current->next == NULL){
-		if (DATA_VERBOSE){
-			printf("%s.%d\t removeGamedata() Freeing gamedata single object\n", __FILE__, __LINE__);	
-		}
-		free(current);
-		gamedata = NULL;
+	len = strlen(gamedata->prefix);
+	compare = strncmp(gamedata->prefix, path, len);
+	if (compare != 0){
+		return compare;
+	}
+	return strcmp(gamedata->dir, path + len);
+}
+
+static int comparePaths(const void *op1, const void *op2){
+	// Order two gamedata pointers by their full path
+	
+	char path[MAX_PATH_SIZE];
+	
+	getGamedataPath(*(gamedata_t * const *)op2, path);
+	return comparePath(*(gamedata_t * const *)op1, path);
+}
+
+int indexGamedataPaths(gametable_t *gametable, pathindex_t *pathindex){
+	/* Build an index of a game table, sorted by path, for findGamedataPath() */
+	
+	// The game table must not grow while the index is in use
+	
+	int i;
+	
+	pathindex->games = NULL;
+	pathindex->size = 0;
+	if (gametable->size == 0){
 		return 0;
 	}
 	
-	while(current != NULL){
-		if (current->next != NULL){
-			/* There's another element, so free() this one and
-			    then move on to the next */
-			next = current->next;
-			if (DATA_VERBOSE){
-				printf("%s.%d\t removeGamedata() Freeing gamedata list object [%s]\n", __FILE__, __LINE__, current->next->name);	
-			}
-			free(current);
-			current = next;
+	pathindex->games = (gamedata_t **) malloc(gametable->size * sizeof(gamedata_t *));
+	if (pathindex->games == NULL){
+		return -1;
+	}
+	pathindex->size = gametable->size;
+	for(i = 0; i < pathindex->size; i++){
+		pathindex->games[i] = &gametable->games[i];
+	}
+	qsort(pathindex->games, pathindex->size, sizeof(gamedata_t *), comparePaths);
+	
+	if (DATA_VERBOSE){
+		printf("%s.%d\t indexGamedataPaths() Indexed %d paths\n", __FILE__, __LINE__, pathindex->size);
+	}
+	return pathindex->size;
+}
+
+gamedata_t * findGamedataPath(pathindex_t *pathindex, char *path){
+	/* Binary search a path index for a game directory, returns NULL if not present */
+	
+	int low;
+	int high;
+	int mid;
+	int compare;
+	
+	low = 0;
+	high = pathindex->size - 1;
+	while (low <= high){
+		mid = (low + high) / 2;
+		compare = comparePath(pathindex->games[mid], path);
+		if (compare == 0){
+			return pathindex->games[mid];
+		}
+		if (compare < 0){
+			low = mid + 1;
 		} else {
-			/* There are no more elements linked */
-			free(current);
-			current = NULL;
-			return 0;
+			high = mid - 1;
 		}
 	}
-	return 0;
+	return NULL;
 }
 
-int sortGamedata(gamedata_t *gamedata){
-	// Sort the list of game data objects by name
-	// This is bubble sort, so it's reasonably slow, but 
-	// simple to implement.
+void removePathindex(pathindex_t *pathindex){
+	/* Free a path index - the gamedata entries it points to are not touched */
 	
-	int swapped;
-	int compare;
+	if (pathindex->games != NULL){
+		free(pathindex->games);
+	}
+	pathindex->games = NULL;
+	pathindex->size = 0;
+}
+
+int removeGamedata(gametable_t *gametable){
+	/* Free all entries of a game table in one go, leaving it empty */
 	
-	gamedata_t *gdata1 = NULL;
-	gamedata_t *gdata2 = NULL;
+	if (DATA_VERBOSE){
+		printf("%s.%d\t removeGamedata() Freeing game table [%d entries]\n", __FILE__, __LINE__, gametable->size);
+	}
+	if (gametable->games != NULL){
+		free(gametable->games);
+	}
+	if (gametable->ids != NULL){
+		free(gametable->ids);
+	}
+	strpool_Free(&gametable->strings);
+	meta_Free(&gametable->meta);
+	search_Free(&gametable->search);
+	search_FreeTrigrams(&gametable->trigrams);
+	sort_Free(&gametable->sort);
+	initGametable(gametable);
+	return 0;
+}
+
+static void mergeNames(unsigned char *keys, int *src, int *dst, int low, int mid, int high){
+	// Merge the two sorted runs src[low..mid-1] and src[mid..high-1] into dst, by name sort key.
+	// Ties are taken from the left hand run first, which keeps the sort stable.
+	
+	int left;
+	int right;
+	int i;
+	
+	left = low;
+	right = mid;
+	for(i = low; i < high; i++){
+		if ((left < mid) && ((right >= high) || (memcmp(keys + (src[left] * COLLATE_KEY_SIZE), keys + (src[right] * COLLATE_KEY_SIZE), COLLATE_KEY_SIZE) <= 0))){
+			dst[i] = src[left];
+			left++;
+		} else {
+			dst[i] = src[right];
+			right++;
+		}
+	}
+}
+
+int sortGamedata(gametable_t *gametable){
+	// Sort the game table by name
+	// This is a stable, bottom-up merge sort of the table positions, so only
+	// ints are moved while sorting. The entries themselves are then put into
+	// the new order in one pass, each one being copied just once.
+	// Names are ordered by collate_Key(): ignoring case and a leading "The ",
+	// with numbers in numeric order. Each key is built once, up front, so every
+	// comparison is a memcmp().
+	
+	int n;
+	int i;
+	int j;
+	int k;
+	int width;
+	int low;
+	int mid;
+	int high;
+	int *order;
+	int *scratch;
+	int *tmp;
+	unsigned char *keys;
+	gamedata_t *games;
+	gamedata_t gdata_temp;
+	
+	n = gametable->size;
+	games = gametable->games;
 	
 	/* Nothing more after this point, consider it sorted */
-	if (gamedata->next == NULL){
+	if (n < 2){
 		return 0;
 	}
 	
-	do {
-		swapped = 0;
-		gdata1 = gamedata;
-		while (gdata1->next != gdata2){
-			compare = strcmp(gdata1->name, gdata1->next->name);
-			if (compare > 0){
-				/* swap objects */
-				swapGamedata(gdata1, gdata1->next);
-				swapped = 1;
+	order = (int *) malloc(n * sizeof(int));
+	scratch = (int *) malloc(n * sizeof(int));
+	keys = (unsigned char *) malloc(n * COLLATE_KEY_SIZE);
+	if ((order == NULL) || (scratch == NULL) || (keys == NULL)){
+		if (DATA_VERBOSE){
+			printf("%s.%d\t sortGamedata() Unable to allocate sort buffers for %d games\n", __FILE__, __LINE__, n);
+		}
+		if (order != NULL){
+			free(order);
+		}
+		if (scratch != NULL){
+			free(scratch);
+		}
+		if (keys != NULL){
+			free(keys);
+		}
+		return -1;
+	}
+	for(i = 0; i < n; i++){
+		order[i] = i;
+		collate_Key(games[i].name, keys + (i * COLLATE_KEY_SIZE));
+	}
+	
+	// Merge runs of 1, 2, 4... entries, flipping between the two buffers
+	for(width = 1; width < n; width = width * 2){
+		for(low = 0; low < n; low = low + (2 * width)){
+			mid = low + width;
+			high = low + (2 * width);
+			if (mid > n){
+				mid = n;
+			}
+			if (high > n){
+				high = n;
+			}
+			mergeNames(keys, order, scratch, low, mid, high);
+		}
+		tmp = order;
+		order = scratch;
+		scratch = tmp;
+	}
+	
+	// order[i] is now the current position of the entry that belongs at i;
+	// follow each cycle of that permutation to move the entries into place
+	for(i = 0; i < n; i++){
+		if (order[i] != i){
+			memcpy(&gdata_temp, &games[i], sizeof(gamedata_t));
+			j = i;
+			while (order[j] != i){
+				k = order[j];
+				memcpy(&games[j], &games[k], sizeof(gamedata_t));
+				order[j] = j;
+				j = k;
 			}
-			gdata1 = gdata1->next;
+			memcpy(&games[j], &gdata_temp, sizeof(gamedata_t));
+			order[j] = j;
 		}
-		gdata2 = gdata1;
 	}
-	while (swapped);
+	
+	// Game IDs follow table position, as they always have after sorting
+	for(i = 0; i < n; i++){
+		games[i].gameid = i;
+	}
+	
+	free(keys);
+	free(order);
+	free(scratch);
 	return 0;
 }
 
-int swapGamedata(gamedata_t *gamedata1, gamedata_t *gamedata2){
-	/* swap one game object with another */
+// Declare an entry of a field table; the key length is worked out by the compiler
+#define FIELD(section, key, type, st, member, size, mask)	{ section, key, sizeof(key) - 1, type, offsetof(st, member), size, mask }
+
+// Every key of launch.dat, other than the hardware keys in meta.c
+static inifield_t launchdat_fields[] = {
+	FIELD("default", "name",		FIELD_STRING,	launchdat_t, realname,	MAX_NAME_SIZE,	LAUNCHDAT_NAME),
+	FIELD("default", "genre",		FIELD_STRING,	launchdat_t, genre,		MAX_STRING_SIZE,	LAUNCHDAT_GENRE),
+	FIELD("default", "developer",	FIELD_STRING,	launchdat_t, developer,	MAX_STRING_SIZE,	LAUNCHDAT_DEVELOPER),
+	FIELD("default", "publisher",	FIELD_STRING,	launchdat_t, publisher,	MAX_STRING_SIZE,	LAUNCHDAT_PUBLISHER),
+	FIELD("default", "year",		FIELD_INT,		launchdat_t, year,		sizeof(int),	LAUNCHDAT_YEAR),
+	FIELD("default", "start",		FIELD_STRING,	launchdat_t, start,		MAX_FILENAME_SIZE,	LAUNCHDAT_START),
+	FIELD("default", "alt_start",	FIELD_STRING,	launchdat_t, alt_start,	MAX_FILENAME_SIZE,	LAUNCHDAT_ALT_START),
+	FIELD("default", "images",		FIELD_STRING,	launchdat_t, images,	IMAGE_BUFFER_SIZE,	LAUNCHDAT_IMAGES),
+	FIELD("default", "series",		FIELD_STRING,	launchdat_t, series,	MAX_STRING_SIZE,	LAUNCHDAT_SERIES),
+	{ NULL, NULL, 0, 0, 0, 0, 0 }
+};
+
+// Every key of launcher.ini
+static inifield_t config_fields[] = {
+	FIELD("default", "verbose",			FIELD_SHORT,	config_t, verbose,			sizeof(short),	FIELD_ALWAYS),
+	FIELD("default", "gamedirs",		FIELD_STRING,	config_t, dirs,				MAX_SEARCHDIRS_SIZE,	FIELD_ALWAYS),
+	FIELD("default", "savedirs",		FIELD_SHORT,	config_t, save,				sizeof(short),	FIELD_ALWAYS),
+	FIELD("default", "preload_names",	FIELD_SHORT,	config_t, preload_names,	sizeof(short),	FIELD_ALWAYS),
+	FIELD("default", "keyboard_test",	FIELD_SHORT,	config_t, keyboard_test,	sizeof(short),	FIELD_ALWAYS),
+	FIELD("default", "sort_filters",	FIELD_SHORT,	config_t, sort_filters,		sizeof(short),	FIELD_ALWAYS),
+	FIELD("default", "timers",			FIELD_SHORT,	config_t, timers,			sizeof(short),	FIELD_ALWAYS),
+	FIELD("default", "rescan",			FIELD_SHORT,	config_t, rescan,			sizeof(short),	FIELD_ALWAYS),
+	FIELD("default", "metadata_cache",	FIELD_SHORT,	config_t, metadata_cache,	sizeof(short),	FIELD_ALWAYS),
+	FIELD("default", "prefetch",		FIELD_SHORT,	config_t, prefetch,			sizeof(short),	FIELD_ALWAYS),
+	{ NULL, NULL, 0, 0, 0, 0, 0 }
+};
+
+static int setField(inifield_t *fields, void *base, const char* section, const char* name, const char* value, int wanted){
+	/* Store the value of a key in base, if the key is in the field table and wanted */
 	
-	gamedata_t *gdata_temp = NULL;
-	gdata_temp = (gamedata_t *) malloc(sizeof(gamedata_t));
+	// Returns the mask of the field, or 0 if the key is not in the table at all.
 	
-	/* keep temp store of gamedata1 */
-	gdata_temp->drive = gamedata1->drive;
-	strcpy(gdata_temp->path, gamedata1->path);
-	strcpy(gdata_temp->name, gamedata1->name);
-	gdata_temp->has_dat = gamedata1->has_dat;
+	// Only a key of the right length and first letter is ever passed to strcmp(),
+	// so an ini line costs a handful of byte compares, rather than a strcmp() of
+	// the section and name for every key in turn.
 	
-	/* swap a with b */
-	gamedata1->drive = gamedata2->drive;
-	strcpy(gamedata1->path, gamedata2->path);
-	strcpy(gamedata1->name, gamedata2->name);
-	gamedata1->has_dat = gamedata2->has_dat;
+	int len;
+	char *p;
+	inifield_t *field;
+	
+	len = strlen(name);
+	for(field = fields; field->key != NULL; field++){
+		if ((field->len == len) && (field->key[0] == name[0]) && (strcmp(field->key, name) == 0) && (strcmp(field->section, section) == 0)){
+			if ((field->mask & wanted) == 0){
+				// A known key, just not one the caller asked for
+				return field->mask;
+			}
+			p = (char *) base + field->offset;
+			switch(field->type){
+				case(FIELD_STRING):
+					strncpy(p, value, field->size);
+					break;
+				case(FIELD_INT):
+					*(int *) p = atoi(value);
+					break;
+				case(FIELD_SHORT):
+					*(short *) p = atoi(value);
+					break;
+				default:
+					return 0;
+			}
+			return field->mask;
+		}
+	}
+	return 0;
+}
+
+// Reusable buffer that each ini file is read into whole; only ever grown
+static char *ini_buffer = NULL;
+static int ini_buffer_size = 0;
+
+static int growIniBuffer(int size){
+	/* Make sure ini_buffer holds at least size bytes; returns 0, or -1 if out of memory */
 	
-	/* swap b with temp */
-	gamedata2->drive = gdata_temp->drive;
-	strcpy(gamedata2->path, gdata_temp->path);
-	strcpy(gamedata2->name, gdata_temp->name);
-	gamedata2->has_dat = gdata_temp->has_dat;
+	char *buffer;
 	
-	/* Free up temp store */
-	free(gdata_temp);
+	if (size > ini_buffer_size){
+		buffer = (char *) realloc(ini_buffer, size);
+		if (buffer == NULL){
+			return -1;
+		}
+		ini_buffer = buffer;
+		ini_buffer_size = size;
+	}
 	return 0;
 }
 
+static int parseIniFile(const char *filepath, unsigned short known_size, ini_handler handler, void *user){
+	/* Read an ini file with a single DOS call and parse it in place */
+	
+	// known_size: size of the file when the game directories were scanned, or 0 to measure it
+	// Returns the same as ini_parse(): 0 on success, the line number of the first
+	// error, -1 if the file could not be opened or read, -2 if out of memory.
+	
+	// With a known size one more byte than that is asked for, so a file that has grown
+	// since the scan is noticed, and measured with two seeks as an unknown one would be.
+	// Buffers always have room for the terminator the parser puts after the last line.
+	
+	int f;
+	int size;
+	int status;
+	char *eof;
+	
+	f = _dos_open(filepath, 0);
+	if (f < 0){
+		return -1;
+	}
+	size = -1;
+	if (known_size > 0){
+		if (growIniBuffer(known_size + 2) < 0){
+			_dos_close(f);
+			return -2;
+		}
+		status = _dos_read(f, ini_buffer, known_size + 1);
+		if ((status >= 0) && (status <= known_size)){
+			size = status;
+		} else if (DATA_VERBOSE){
+			printf("%s.%d\t parseIniFile() %s is no longer %d bytes\n", __FILE__, __LINE__, filepath, known_size);
+		}
+	}
+	if (size < 0){
+		size = _dos_seek(f, 0, 2);
+		if ((size < 0) || (_dos_seek(f, 0, 0) < 0)){
+			_dos_close(f);
+			return -1;
+		}
+		if (growIniBuffer(size + 1) < 0){
+			_dos_close(f);
+			return -2;
+		}
+		status = _dos_read(f, ini_buffer, size);
+		if (status != size){
+			_dos_close(f);
+			if (DATA_VERBOSE){
+				printf("%s.%d\t parseIniFile() Short read of %s [%d of %d bytes]\n", __FILE__, __LINE__, filepath, status, size);
+			}
+			return -1;
+		}
+	}
+	_dos_close(f);
+	
+	// Anything after a DOS end-of-file marker is not part of the file
+	eof = memchr(ini_buffer, 0x1A, size);
+	if (eof != NULL){
+		size = eof - ini_buffer;
+	}
+	return ini_parse_buffer(ini_buffer, size, handler, user);
+}
+
 static int launchdatHandler(void* user, const char* section, const char* name, const char* value){
 	/* Based on reference implementation of inih parser:
 	    https://github.com/benhoyt/inih
 	    */
 	    
-	launchdat_t* launchdat = (launchdat_t*)user;
-		
-	#define MATCH(s, n) strcmp(section, s) == 0 && strcmp(name, n) == 0
-	if (MATCH("default", "name")){
-		strncpy(launchdat->realname, value, MAX_NAME_SIZE);
-		
-	} else if (MATCH("default", "genre")){
-		strncpy(launchdat->genre, value, MAX_STRING_SIZE);
-		
-	} else if (MATCH("default", "developer")){
-		strncpy(launchdat->developer, value, MAX_STRING_SIZE);
-		
-	} else if (MATCH("default", "publisher")){
-		strncpy(launchdat->publisher, value, MAX_STRING_SIZE);
-		
-	} else if (MATCH("default", "year")){
-		launchdat->year = atoi(value);
-		
-	} else if (MATCH("default", "midi_mpu")){
-		if (atoi(value) == 1){
-			launchdat->midi = 1;
-		}
-	} else if (MATCH("default", "start")){
-		strncpy(launchdat->start, value, MAX_FILENAME_SIZE);
-	
-	} else if (MATCH("default", "alt_start")){
-		strncpy(launchdat->alt_start, value, MAX_FILENAME_SIZE);
-		
-	} else if (MATCH("default", "images")){
-		strncpy(launchdat->images, value, IMAGE_BUFFER_SIZE);
-		
-	} else if (MATCH("default", "series")){
-		strncpy(launchdat->series, value, MAX_STRING_SIZE);
-		
-	} else if (MATCH("misc", "cyberstick")){
-		if (atoi(value) == 1){
-			launchdat->hardware->cyberstick = 1;
-		}
-	} else if (MATCH("misc", "fpu")){
-		if (atoi(value) == 1){
-			launchdat->hardware->fpu = 1;
-		}
-	} else if (MATCH("misc", "2hdboot")){
-		if (atoi(value) == 1){
-			launchdat->hardware->uses_2hdboot = 1;
-		}
-	} else if (MATCH("misc", "2hdsim")){
-		if (atoi(value) == 1){
-			launchdat->hardware->uses_2hdsim = 1;
+	launchload_t* load = (launchload_t*)user;
+	unsigned char flag;
+	int mask;
+	
+	mask = setField(launchdat_fields, load->launchdat, section, name, value, load->wanted);
+	if (mask == 0){
+		// Hardware keys, e.g. [misc] fpu=1, are looked up in the table in meta.c
+		flag = meta_HardwareKey(section, name);
+		if (flag == 0){
+			return 0;  /* unknown section/name, error */
 		}
-	} else {
-		return 0;  /* unknown section/name, error */
+		if ((load->wanted & LAUNCHDAT_HARDWARE) && (atoi(value) == 1)){
+			load->launchdat->hardware->flags |= flag;
+		}
+		// Any line of the file could set another flag, so this is never 'found'
+		return 1;
+	}
+	
+	// Nothing more to do once every field asked for has been seen
+	load->found |= mask;
+	if ((load->found & load->wanted) == load->wanted){
+		return INI_STOP;
 	}
 	return 1;
 }
@@ -232,11 +671,7 @@ void launchdataDefaults(launchdat_t *launchdat){
 	memset(launchdat->images, '\0', strlen(launchdat->images));
 	memset(launchdat->series, '\0', strlen(launchdat->series));
 	launchdat->year = DEFAULT_YEAR;
-	launchdat->midi = 0;
-	launchdat->hardware->fpu = 0;
-	launchdat->hardware->cyberstick = 0;
-	launchdat->hardware->uses_2hdsim = 0;
-	launchdat->hardware->uses_2hdboot = 0;
+	launchdat->hardware->flags = 0;
 }
 
 void configDefaults(config_t *config){
@@ -248,37 +683,55 @@ void configDefaults(config_t *config){
 	config->dir = NULL;
 	config->preload_names = 0;
 	config->keyboard_test = 0;
+	config->sort_filters = 0;
+	config->rescan = 0;
+	config->metadata_cache = 16;
+	config->prefetch = 20;
 }
 
 int getLaunchdata(gamedata_t *gamedata, launchdat_t *launchdat){
 	/* load and return a launch.dat from from disk, for a given gamedata object */
 	
-	char filepath[MAX_PATH_SIZE];
+	return getLaunchdataFields(gamedata, launchdat, LAUNCHDAT_ALL);
+}
+
+int getLaunchdataFields(gamedata_t *gamedata, launchdat_t *launchdat, int fields){
+	/* load only some fields of a launch.dat from disk, for a given gamedata object */
+	
+	// fields: LAUNCHDAT_ mask of the fields wanted. Parsing stops at the line that
+	//         fills in the last of them, e.g. LAUNCHDAT_NAME usually only parses the
+	//         first line or two. Other fields are left at their defaults.
+	
+	char filepath[MAX_PATH_SIZE + MAX_FILENAME_SIZE];
+	launchload_t load;
 	
 	if (gamedata->has_dat != 1){
 		return -1;
 	}
 	
-	strcpy(filepath, gamedata->path);
+	getGamedataPath(gamedata, filepath);
 	strcat(filepath, "\\");
 	strcat(filepath, GAMEDAT);
 	
 	
 	if (DATA_VERBOSE){
-		printf("%s.%d\t getLaunchdata() Setting defaults\n", __FILE__, __LINE__);
+		printf("%s.%d\t getLaunchdataFields() Setting defaults\n", __FILE__, __LINE__);
 	}
 	launchdataDefaults(launchdat);
+	load.launchdat = launchdat;
+	load.wanted = fields;
+	load.found = 0;
 	if (DATA_VERBOSE){
-		printf("%s.%d\t getLaunchdata() Attempting load of %s\n", __FILE__, __LINE__, filepath);
+		printf("%s.%d\t getLaunchdataFields() Attempting load of %s [fields:0x%04x]\n", __FILE__, __LINE__, filepath, fields);
 	}
-	if (ini_parse(filepath, launchdatHandler, launchdat) < 0) {
+	if (parseIniFile(filepath, gamedata->dat_size, launchdatHandler, &load) < 0) {
 		if (DATA_VERBOSE){
-			printf("%s.%d\t getLaunchdata() Cannot load %s\n", __FILE__, __LINE__, filepath);
+			printf("%s.%d\t getLaunchdataFields() Cannot load %s\n", __FILE__, __LINE__, filepath);
 		}
 		return -1;
 	} else {
 		if (DATA_VERBOSE){
-			printf("%s.%d\t getLaunchdata() Loaded %s\n", __FILE__, __LINE__, filepath);
+			printf("%s.%d\t getLaunchdataFields() Loaded %s\n", __FILE__, __LINE__, filepath);
 		}
 		return 0;
 	}
@@ -288,26 +741,9 @@ static int configHandler(void* user, const char* section, const char* name, cons
 	/* Based on reference implementation of inih parser:
 	    https://github.com/benhoyt/inih
 	    */
-	    
-	config_t* config = (config_t*)user;
-		
-	#define MATCH(s, n) strcmp(section, s) == 0 && strcmp(name, n) == 0
-	if (MATCH("default", "verbose")){
-		config->verbose =  atoi(value);
-	} else if (MATCH("default", "gamedirs")){
-		strncpy(config->dirs, value, MAX_SEARCHDIRS_SIZE);
-	} else if (MATCH("default", "savedirs")){
-		config->save =  atoi(value);
-	} else if (MATCH("default", "preload_names")){
-		config->preload_names =  atoi(value);
-	} else if (MATCH("default", "keyboard_test")){
-		config->keyboard_test =  atoi(value);
-	} else if (MATCH("default", "timers")){
-		config->timers =  atoi(value);
-	} else {
-		return 0;  /* unknown section/name, error */
-	}
-	return 1;
+	
+	// Returns 0 for an unknown section/name, which is an error
+	return setField(config_fields, user, section, name, value, FIELD_ALWAYS) != 0;
 }
 
 int getIni(config_t *config){
@@ -355,7 +791,7 @@ int getIni(config_t *config){
 	if (DATA_VERBOSE){
 		printf("%s.%d\t getIni() Calling parser\n", __FILE__, __LINE__);
 	}
-	if (ini_parse(my_path, configHandler, config) < 0) {
+	if (parseIniFile(my_path, 0, configHandler, config) < 0) {
 		printf("%s.%d\t getIni() Cannot load %s\n", __FILE__, __LINE__, my_path);
 		return -1;
 	} else {
@@ -379,7 +815,7 @@ int getImageList(launchdat_t *launchdat, imagefile_t *imagefile){
 	
 	// Reset the imagefile list array
 	for(found =0; found < MAX_IMAGES; found++){
-		memset(imagefile->filename[found], '\0', MAX_STRING_SIZE);
+		memset(imagefile->filename[found], '\0', MAX_FILENAME_SIZE);
 	}
 	found = 0;
 	imagefile->selected = -1;
@@ -387,7 +823,7 @@ int getImageList(launchdat_t *launchdat, imagefile_t *imagefile){
 	imagefile->last = -1;
 
 	if (launchdat != NULL){
-		if (launchdat->images != NULL){
+		if (launchdat->images[0] != '\0'){
 			strncpy(buffer, launchdat->images, IMAGE_BUFFER_SIZE);
 			p = strtok(buffer, ",; ");
 			while (p != NULL){
@@ -438,7 +874,7 @@ int getDirList(config_t *config, gamedir_t *gamedir){
 	int found;	// Counter for number of found game search directories
 	found = 0;
 	
-	if (config->dirs != NULL){
+	if (config->dirs[0] != '\0'){
 		strcpy(buffer, config->dirs);
 		p = strtok(buffer, ",");
 		while (p != NULL){
@@ -450,6 +886,7 @@ int getDirList(config_t *config, gamedir_t *gamedir){
 				gamedir = getLastGameDir(gamedir);
 				gamedir->next = (gamedir_t *) malloc(sizeof(gamedir_t));
 				strcpy(gamedir->next->path, p);
+				gamedir->next->stamp = dirStamp(p);
 				gamedir->next->next = NULL;
 				
 				// If this was the first gamedir found, add it as the head item to the config data object
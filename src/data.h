@@ -15,7 +15,13 @@
  along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#ifndef __HAS_STRPOOL
+#include "strpool.h"
+#define __HAS_STRPOOL
+#endif
+
 #define SAVEFILE				"launcher.txt"		// A text file holding the list of all found directories
+#define RECENTFILE			"launcher.rec"		// A text file holding the paths of the most recently played games
 #define INIFILE				"launcher.ini"		// the ini file holding settings for the main application
 #define GAMEDAT				"launch.dat"			// the name of the data file in the game dir to load
 #define RUNBAT				"run.bat"			// the name of the batch file which will contain the path to the chosen game exe
@@ -33,39 +39,144 @@
 #define MAX_SEARCHDIRS_SIZE	1024
 #define DATA_VERBOSE			0
 #define MAX_PATH_SIZE		65
+#define GAMETABLE_INITIAL_SIZE	64				// Number of gamedata entries allocated when the game table is first used
+
+// Fields of launchdat_t, for loading only some of them with getLaunchdataFields()
+#define LAUNCHDAT_NAME			0x0001				// realname
+#define LAUNCHDAT_GENRE			0x0002
+#define LAUNCHDAT_YEAR			0x0004
+#define LAUNCHDAT_SERIES		0x0008
+#define LAUNCHDAT_PUBLISHER		0x0010
+#define LAUNCHDAT_DEVELOPER		0x0020
+#define LAUNCHDAT_START			0x0040
+#define LAUNCHDAT_ALT_START		0x0080
+#define LAUNCHDAT_IMAGES		0x0100
+#define LAUNCHDAT_HARDWARE		0x0200				// Every hardware flag; means reading the whole file
+#define LAUNCHDAT_ALL			0x03FF
+#define LAUNCHDAT_META			(LAUNCHDAT_GENRE | LAUNCHDAT_YEAR | LAUNCHDAT_SERIES | LAUNCHDAT_PUBLISHER | LAUNCHDAT_DEVELOPER | LAUNCHDAT_HARDWARE)
+#define FIELD_ALWAYS			0xFFFF				// inifield_t.mask of a field that is always stored
+
+// Types of inifield_t.type
+#define FIELD_STRING			0					// strncpy() into a char array of size bytes
+#define FIELD_INT			1					// atoi() into an int
+#define FIELD_SHORT			2					// atoi() into a short
 
 typedef struct gamedata {
 	int gameid;					// Unique ID for this game - assigned at scan time
 	char drive;					// Drive letter
-	char path[MAX_PATH_SIZE];	// Full drive and path name; e.g. A:\Games\FinalFight
-	char name[MAX_NAME_SIZE];	// Just the directory name; e.g. FinalFight
+	char *prefix;				// Drive and search path, shared by all games in that search path; e.g. "A:\Games\"
+	char *dir;					// Just the directory name; e.g. FinalFight
+	char *name;					// Name to display; the same string as dir, unless a realname was preloaded
 	int has_dat;				// Flag to indicate __launch.dat was found in the game directory
-	struct gamedata *next;		// Pointer to next gamedata entry
+	unsigned short dat_size;	// Size of __launch.dat in bytes, as found at scan time (0 if unknown)
+	unsigned long stamp;		// Date and time of the game directory at scan time; (date << 16) | time
 } __attribute__((__packed__)) __attribute__((aligned (2))) gamedata_t;
 
+// One game in the year index
+typedef struct yearentry {
+	short year;					// Year of release
+	unsigned short gameid;		// Game released that year
+} __attribute__((__packed__)) __attribute__((aligned (2))) yearentry_t;
+
+// Metadata of every game, one array per field, indexed by gameid. Strings are
+// interned, so each field is just the id of a string in the strings array.
+typedef struct metaindex {
+	int size;					// Number of games in each of the arrays below
+	unsigned char *state;		// Whether the metadata of each game has been read; META_STATE_
+	unsigned short *genre;		// String id of the genre of each game
+	unsigned short *series;		// String id of the series of each game
+	unsigned short *developer;	// String id of the developer of each game
+	unsigned short *publisher;	// String id of the publisher of each game
+	short *year;				// Year of release of each game
+	unsigned char *hardware;	// Hardware flags of each game; META_HW_
+	char **strings;				// Interned strings, by string id; id 0 is always the empty string
+	int strings_size;			// Number of interned strings, including the empty string
+	int strings_capacity;		// Number of entries allocated in strings
+	unsigned short *hash;		// Open addressed hash table of string ids; 0 is an empty slot
+	int hash_size;				// Number of slots in hash, always a power of 2
+	strpool_t pool;				// Storage for the interned strings
+	yearentry_t *years;			// Every game with a year, by year then gameid; NULL until first filtered on
+	int years_size;				// Number of entries in years
+	unsigned long changes;		// Incremented whenever the index is reset or a game's metadata changes
+} __attribute__((__packed__)) __attribute__((aligned (2))) metaindex_t;
+
+// Every game sorted by name, ignoring case, for type-ahead search
+typedef struct searchindex {
+	int *order;					// Gameids in case-insensitive name order; NULL until first searched
+	int size;					// Number of entries in order
+} __attribute__((__packed__)) __attribute__((aligned (2))) searchindex_t;
+
+// Trigrams of every game name, each with the list of games containing it, for fuzzy search
+typedef struct trigramindex {
+	int keys_size;				// Number of distinct trigrams
+	unsigned short *keys;		// Distinct trigrams, in ascending order
+	long *offsets;				// Start of each trigram's games in postings; keys_size + 1 entries
+	long postings_size;			// Number of entries in postings
+	unsigned short *postings;	// Gameids, grouped by trigram
+} __attribute__((__packed__)) __attribute__((aligned (2))) trigramindex_t;
+
+// Alternative orders of every game, each a permutation of gameids, for the browser
+typedef struct sortindex {
+	unsigned short *orders;		// SORT_MAX permutations of size gameids, one after another; NULL until first sorted
+	int size;					// Number of gameids in each permutation
+} __attribute__((__packed__)) __attribute__((aligned (2))) sortindex_t;
+
+// All of the games found, held in one contiguous, growable array
+typedef struct gametable {
+	gamedata_t *games;			// Array of gamedata entries
+	int size;					// Number of entries in use
+	int capacity;				// Number of entries allocated
+	int *ids;					// Position in games[] of each gameid, or -1; built by indexGamedata()
+	int ids_size;				// Number of entries in ids
+	strpool_t strings;			// Storage for the prefix, dir and name strings of every entry
+	metaindex_t meta;			// Metadata of every entry, filled in as each launch.dat is read
+	searchindex_t search;		// Name order for type-ahead search, built the first time it is needed
+	trigramindex_t trigrams;	// Trigrams for fuzzy search, built at scan time or loaded from the catalog
+	sortindex_t sort;			// Year, company, genre and recently played orders, built the first time they are needed
+} __attribute__((__packed__)) __attribute__((aligned (2))) gametable_t;
+
+// Games from a previous scan, sorted by path, so that unchanged game directories can be re-used
+typedef struct pathindex {
+	gamedata_t **games;			// Array of pointers into a game table
+	int size;					// Number of entries in the array
+} __attribute__((__packed__)) __attribute__((aligned (2))) pathindex_t;
+
 // Hardware metadata for a game
 typedef struct hwdata {
-	unsigned char fpu;			// The game can use an fpu
-	unsigned char cyberstick;	// The game can use the cyber flight stick
-	unsigned char uses_2hdsim;	// Uses 2hdsim to emulate floppy drives
-	unsigned char uses_2hdboot;	// Uses 2hdboot to load floppies into RAM and reboot
+	unsigned char flags;		// META_HW_ bits; fpu, cyberstick, 2hdsim, 2hdboot, midi etc.
 } __attribute__((__packed__)) __attribute__((aligned (2))) hwdata_t;
 
+// A key of launch.dat or launcher.ini, and where its value is stored
+typedef struct inifield {
+	char *section;						// Section the key is in, e.g. "default"
+	char *key;							// Name of the key
+	unsigned char len;					// strlen(key), so most keys are ruled out without a strcmp()
+	unsigned char type;					// How the value is stored; FIELD_
+	unsigned short offset;				// offsetof() the value in the struct being filled in
+	unsigned short size;				// Size of the value, for FIELD_STRING
+	unsigned short mask;				// Which field this is, e.g. LAUNCHDAT_GENRE; or FIELD_ALWAYS
+} __attribute__((__packed__)) __attribute__((aligned (2))) inifield_t;
+
 typedef struct launchdat {
 	char realname[MAX_NAME_SIZE];		// A 'friendly' name to display the game as, instead of just the directory name
 	char genre[MAX_STRING_SIZE];		// A string to represent the genre, in case we want to filter by genre
 	int year;							// Year the game was released
-	int midi;							// Supports MIDI out
-	int midi_serial;					// Supports MIDI serial out
 	char series[MAX_STRING_SIZE];		// Series name; e.g. Gradius, Streetfighter, etc.
 	char publisher[MAX_STRING_SIZE];	// The name of the publisher
 	char developer[MAX_STRING_SIZE];	// The name of the developer
 	char start[MAX_FILENAME_SIZE];		// Name of the main start file
 	char alt_start[MAX_FILENAME_SIZE];	// Name of an alternative start file (e.g a config utility)
 	char images[IMAGE_BUFFER_SIZE];		// String containing all the image filenames
-	struct hwdata *hardware;			// Pointer to hardware data
+	struct hwdata *hardware;			// Pointer to hardware data, including MIDI support
 } __attribute__((__packed__)) __attribute__((aligned (2))) launchdat_t;
 
+// A launch.dat being parsed by launchdatHandler()
+typedef struct launchload {
+	launchdat_t *launchdat;				// Where the values are stored
+	unsigned short wanted;				// LAUNCHDAT_ fields to store; parsing stops once they are all found
+	unsigned short found;				// LAUNCHDAT_ fields found so far
+} __attribute__((__packed__)) __attribute__((aligned (2))) launchload_t;
+
 // List of images for the current game
 typedef struct imagefile {
 	char filename[MAX_IMAGES][MAX_FILENAME_SIZE];	// Filename of an image
@@ -76,6 +187,7 @@ typedef struct imagefile {
 
 typedef struct gamedir {
 	char path[MAX_PATH_SIZE];			// Path to search for games
+	unsigned long stamp;				// Date and time of the search path directory; (date << 16) | time
 	struct gamedir *next;				// Link to the next search path
 } __attribute__((__packed__)) __attribute__((aligned (2))) gamedir_t;
 
@@ -85,19 +197,32 @@ typedef struct config {
 	short save;							// Save the list of all games to a text file
 	short preload_names;				// Flag to indicate wheter a launch.dat is loaded at scrape-time to pick up real names
 	short keyboard_test;
+	short sort_filters;					// Flag to list filter choices by number of games, rather than by name
+	short rescan;						// Flag to ignore the game catalog and always scrape the game dirs at startup
+	short metadata_cache;				// Number of recently selected launch.dat files to keep parsed in memory; 0 to disable
+	short prefetch;						// Milliseconds per pass of the main loop to spend reading ahead the games around the cursor; 0 to disable
 	char dirs[MAX_SEARCHDIRS_SIZE];		// String containing all game dirs to search - it will then be parsed into a list below:
 	struct gamedir *dir;				// List of all the game search dirs
 } __attribute__((__packed__)) __attribute__((aligned (2))) config_t;
 
 // Function prototypes
-gamedata_t *	getLastGamedata(gamedata_t *gamedata);
+void			initGametable(gametable_t *gametable);
+gamedata_t *	addGamedata(gametable_t *gametable);
 imagefile_t *	getLastImage(imagefile_t *imagefile);
-int				removeGamedata(gamedata_t *gamedata);
+int				removeGamedata(gametable_t *gametable);
 int 			removeImagefile(imagefile_t *imagefile);
-int 			sortGamedata(gamedata_t *gamedata);
-int 			swapGamedata(gamedata_t *gamedata1, gamedata_t *gamedata2);
+int 			sortGamedata(gametable_t *gametable);
 int 			getLaunchdata(gamedata_t *gamedata, launchdat_t *launchdat);
+int 			getLaunchdataFields(gamedata_t *gamedata, launchdat_t *launchdat, int fields);
 int 			getImageList(launchdat_t *launchdat, imagefile_t *imagefile);
 int 			getIni(config_t *config);
 int 			getDirList(config_t *config, gamedir_t *gamedir);
-gamedata_t * getGameid(int gameid, gamedata_t *gamedata);
\ No newline at end of file
+gamedata_t * getGameid(int gameid, gametable_t *gametable);
+char *			getGamedataPath(gamedata_t *gamedata, char *buffer);
+int				setGamedataPath(gametable_t *gametable, gamedata_t *gamedata, char *path);
+int				setGamedataName(gametable_t *gametable, gamedata_t *gamedata, char *name);
+void			printGametableMemory(gametable_t *gametable);
+int				indexGamedata(gametable_t *gametable);
+int				indexGamedataPaths(gametable_t *gametable, pathindex_t *pathindex);
+gamedata_t *	findGamedataPath(pathindex_t *pathindex, char *path);
+void			removePathindex(pathindex_t *pathindex);
\ No newline at end of file
@@ -29,205 +29,554 @@
 #define __HAS_MAIN
 #endif
 #include "filter.h"
+#include "meta.h"
+#include "search.h"
+#include "sort.h"
 #include "ui.h"
 
-int compare(const void *op1, const void *op2){
-	// As defined in the OpenWatcom C Library reference guide
-    
-    return(strcmp(*(const char**)op1, *(const char**)op1));
+int compareKeyNames(const void *op1, const void *op2){
+	// Order two filter keys by name
+	
+	// Names that only differ after COLLATE_KEY_SIZE bytes of key are
+	// put in character order, so that the list is always the same.
+	
+	const filterkey_t *a = (const filterkey_t *)op1;
+	const filterkey_t *b = (const filterkey_t *)op2;
+	int compare;
+	
+	compare = memcmp(a->key, b->key, COLLATE_KEY_SIZE);
+	if (compare != 0){
+		return compare;
+	}
+	return strcmp(a->name, b->name);
 }
 
-int sortFilterKeys(state_t *state, int items){
-	// Sort the list of filter keys by name
+int compareKeyCounts(const void *op1, const void *op2){
+	// Order two filter keys by number of games, most first, then by name
 	
-	qsort(state->filter_strings, items, MAX_STRING_SIZE, compare);
-	return FILTER_OK;
+	const filterkey_t *a = (const filterkey_t *)op1;
+	const filterkey_t *b = (const filterkey_t *)op2;
+	
+	if (a->count != b->count){
+		return b->count - a->count;
+	}
+	return compareKeyNames(op1, op2);
 }
 
-int filter_GetGenres(state_t *state, gamedata_t *gamedata, launchdat_t *filterdat){
-	// Get all of the genres set in game metadata
+int sortFilterKeys(state_t *state, int items){
+	// Sort the list of filter keys, and their game counts, by name or by count
+	
+	// The keys are sorted as (name, count) pairs and then copied back, so
+	// each count stays with its name. Names are ordered the same way as the
+	// game list, by a collate_Key() built once for each.
 	
 	int i;
-	int a;
-	int c;
-	int found;
-	int status;
-	int next_pos;
-	gamedata_t *gamedata_head;
-	gamedata_head = gamedata; // Store first item
+	filterkey_t *keys;
 	
-	if (FILTER_VERBOSE){
-		printf("%s.%d\t Building genre keyword selection list\n", __FILE__, __LINE__);
+	if (items < 2){
+		return FILTER_OK;
 	}
-	if (FILTER_VERBOSE){
-		printf("%s.%d\t Info - Clearing existing filter keywords list\n", __FILE__, __LINE__);
+	keys = (filterkey_t *) malloc(items * sizeof(filterkey_t));
+	if (keys == NULL){
+		return FILTER_ERR;
 	}
-	// Empty list
-	for(i =0; i <MAXIMUM_FILTER_STRINGS; i++){
-		memset(state->filter_strings[i], '\0', MAX_STRING_SIZE);
+	for(i = 0; i < items; i++){
+		keys[i].name = state->filter_strings[i];
+		keys[i].count = state->filter_counts[i];
+		collate_Key(keys[i].name, keys[i].key);
 	}
+	if (state->filter_sort == FILTER_SORT_COUNT){
+		qsort(keys, items, sizeof(filterkey_t), compareKeyCounts);
+	} else {
+		qsort(keys, items, sizeof(filterkey_t), compareKeyNames);
+	}
+	for(i = 0; i < items; i++){
+		state->filter_strings[i] = keys[i].name;
+		state->filter_counts[i] = keys[i].count;
+	}
+	free(keys);
+	return FILTER_OK;
+}
+
+void filter_ClearStrings(state_t *state){
+	// Empty the list of filter strings, freeing the text of all of them at once
 	
-	i = 0;
-	c = 0;
-	next_pos = 0;
-	while(gamedata != NULL){
-		
-		// Does game have metadata
-		if (gamedata->has_dat){
-			
-			// Load launch metadata
-			status = getLaunchdata(gamedata, filterdat);
-			if (status == 0){
-				
-				// Does the genre field match?
-				if (strcmp(filterdat->genre, "") != 0){
-				
-					// Does this genre already exist?
-					found = 0;
-					for(a=0;a<MAXIMUM_FILTER_STRINGS;a++){
-						if (strcmp(state->filter_strings[a], filterdat->genre) == 0){
-							found = 1;
-						}
-					}
-					// This genre isn't found yet, add it to the list of keywords
-					if (found == 0){
-						if (FILTER_VERBOSE){
-							printf("%s.%d\t Info - Found genre: [%s]\n", __FILE__, __LINE__, filterdat->genre);
-						}
-						strncpy(state->filter_strings[next_pos], filterdat->genre, MAX_STRING_SIZE);
-						next_pos++;
-					}
+	strpool_Free(&state->filter_pool);
+	strpool_Init(&state->filter_pool);
+	state->available_filter_strings = 0;
+	state->available_filter_pages = 0;
+	state->current_filter_page = 0;
+}
+
+int filter_AddString(state_t *state, char *s, int count){
+	// Add a filter string, and the number of games it matches, to the end of the list
+	
+	// The arrays double in size whenever they are full, so there is no limit
+	// on how many genres, series or companies can be listed, and the text is
+	// copied in full into the string pool.
+	
+	int size;
+	char **strings;
+	int *counts;
+	unsigned char *selected;
+	
+	if (state->available_filter_strings >= state->filter_strings_size){
+		size = state->filter_strings_size * 2;
+		if (size < FILTER_STRINGS_INITIAL_SIZE){
+			size = FILTER_STRINGS_INITIAL_SIZE;
+		}
+		strings = (char **) realloc(state->filter_strings, size * sizeof(char *));
+		if (strings == NULL){
+			return FILTER_ERR;
+		}
+		state->filter_strings = strings;
+		counts = (int *) realloc(state->filter_counts, size * sizeof(int));
+		if (counts == NULL){
+			return FILTER_ERR;
+		}
+		state->filter_counts = counts;
+		selected = (unsigned char *) realloc(state->filter_strings_selected, size * sizeof(unsigned char));
+		if (selected == NULL){
+			return FILTER_ERR;
+		}
+		state->filter_strings_selected = selected;
+		state->filter_strings_size = size;
+		if (FILTER_VERBOSE){
+			printf("%s.%d\t Info - Grew filter string list to %d entries\n", __FILE__, __LINE__, size);
+		}
+	}
+	
+	state->filter_strings[state->available_filter_strings] = strpool_Add(&state->filter_pool, s);
+	if (state->filter_strings[state->available_filter_strings] == NULL){
+		return FILTER_ERR;
+	}
+	state->filter_counts[state->available_filter_strings] = count;
+	state->filter_strings_selected[state->available_filter_strings] = 0;
+	state->available_filter_strings++;
+	return FILTER_OK;
+}
+
+int listFilterCounts(state_t *state, metaindex_t *meta, int *counts, char *type){
+	// Turn the game count of each string id, from a genre, series or company pass, into the sorted list of filter strings
+	
+	int id;
+	int a;
+	
+	for(id = META_NONE + 1; id < meta->strings_size; id++){
+		if (counts[id] > 0){
+			if (FILTER_VERBOSE){
+				printf("%s.%d\t Info - Found %s: [%s]\n", __FILE__, __LINE__, type, meta_String(meta, id));
+			}
+			if (filter_AddString(state, meta_String(meta, id), counts[id]) != FILTER_OK){
+				if (FILTER_VERBOSE){
+					printf("%s.%d\t Error - Unable to add %s filter string\n", __FILE__, __LINE__, type);
 				}
+				return FILTER_ERR;
 			}
 		}
-		c++;
-		gamedata = gamedata->next;
 	}
-	gamedata = gamedata_head;
 	
 	if (FILTER_VERBOSE){
 		printf("%s.%d\t Sorting keywords\n", __FILE__, __LINE__);
 	}
-	sortFilterKeys(state, next_pos);
+	sortFilterKeys(state, state->available_filter_strings);
 	if (FILTER_VERBOSE){
-		for(a=0;a<next_pos;a++){
-			printf("%s.%d\t Info - Keyword %d: [%s]\n", __FILE__, __LINE__, a, state->filter_strings[a]);
+		for(a = 0; a < state->available_filter_strings; a++){
+			printf("%s.%d\t Info - Keyword %d: [%s] %d games\n", __FILE__, __LINE__, a, state->filter_strings[a], state->filter_counts[a]);
 		}
 	}
-	
-	state->available_filter_strings = next_pos;
 	state->current_filter_page = 0;
-	state->available_filter_pages = ceil(((float)next_pos / (float)MAXIMUM_FILTER_STRINGS_PER_PAGE));
-	for(i = 0; i < MAXIMUM_FILTER_STRINGS; i++){
-		state->filter_strings_selected[i] = 0;
-	}
+	state->available_filter_pages = ceil(((float)state->available_filter_strings / (float)MAXIMUM_FILTER_STRINGS_PER_PAGE));
 	
 	if (FILTER_VERBOSE){
-		printf("%s.%d\t Searched %d games\n", __FILE__, __LINE__, c);
-		printf("%s.%d\t Total of %d genre filters added\n", __FILE__, __LINE__, next_pos);
+		printf("%s.%d\t Total of %d %s filters added\n", __FILE__, __LINE__, state->available_filter_strings, type);
 		printf("%s.%d\t Total of %d pages of filters\n", __FILE__, __LINE__, state->available_filter_pages);
-	} 
+	}
 	return FILTER_OK;
 }
 
-int filter_GetSeries(state_t *state, gamedata_t *gamedata, launchdat_t *filterdat){
-	// Get all of the series names set in game metadata
+int filter_ResetSelection(state_t *state, int games){
+	// Make sure the selection list can hold every game in the game table, then empty it
+	
+	// The list is only ever grown, so after the first filter this is just the
+	// loop to clear it.
 	
 	int i;
-	int a;
+	int *selected_list;
+	
+	if (games < 1){
+		games = 1;
+	}
+	if (games > state->selected_list_size){
+		selected_list = (int *) realloc(state->selected_list, games * sizeof(int));
+		if (selected_list == NULL){
+			if (FILTER_VERBOSE){
+				printf("%s.%d\t Error - Unable to grow selection list to %d entries\n", __FILE__, __LINE__, games);
+			}
+			return FILTER_ERR;
+		}
+		state->selected_list = selected_list;
+		state->selected_list_size = games;
+	}
+	for(i = 0; i < state->selected_list_size; i++){
+		state->selected_list[i] = -1;
+	}
+	return FILTER_OK;
+}
+
+void filter_SetPages(state_t *state){
+	// Work out how many pages of the game browser the current selection list needs
+	
+	// There is always at least one page, even if it is empty
+	state->total_pages = (state->selected_max + ui_browser_max_lines - 1) / ui_browser_max_lines;
+	if (state->total_pages < 1){
+		state->total_pages = 1;
+	}
+}
+
+int filter_ResetBitsets(state_t *state, gametable_t *gametable){
+	// Make sure there is a bitset of every game for each filter type, then mark them all unused
+	
+	int words;
+	unsigned long *bits;
+	
+	words = meta_BitsetWords(&gametable->meta);
+	if (words < 1){
+		words = 1;
+	}
+	if (words != state->filter_bits_words){
+		bits = (unsigned long *) realloc(state->filter_bits, (FILTER_MAX + 1) * words * sizeof(unsigned long));
+		if (bits == NULL){
+			if (FILTER_VERBOSE){
+				printf("%s.%d\t Error - Unable to allocate filter bitsets of %d words\n", __FILE__, __LINE__, words);
+			}
+			return FILTER_ERR;
+		}
+		state->filter_bits = bits;
+		state->filter_bits_words = words;
+	}
+	memset(state->filter_bits, '\0', (FILTER_MAX + 1) * words * sizeof(unsigned long));
+	memset(state->filter_active, 0, sizeof(state->filter_active));
+	return FILTER_OK;
+}
+
+unsigned long * filter_NewBitset(state_t *state, gametable_t *gametable, int type, long key){
+	// Return the empty bitset for a filter type, replacing any earlier filter of that type
+	
+	// The bitsets are reset if the game table has changed size since they were made.
+	// key: what the filter is matching (string id, hardware mask etc.), so that the
+	//      result can be found in the filter cache next time.
+	
+	unsigned long *bits;
+	
+	if ((state->filter_bits == NULL) || (state->filter_bits_words != meta_BitsetWords(&gametable->meta))){
+		if (filter_ResetBitsets(state, gametable) != FILTER_OK){
+			return NULL;
+		}
+	}
+	bits = state->filter_bits + (type * state->filter_bits_words);
+	memset(bits, '\0', state->filter_bits_words * sizeof(unsigned long));
+	state->filter_active[type] = 1;
+	state->filter_keys[type] = key;
+	return bits;
+}
+
+int filter_ApplyBitsets(state_t *state, gametable_t *gametable){
+	// Fill the selection list with the games matched by every active filter
+	
+	// Filters of different types are combined with AND, so picking a genre and
+	// then a tech spec shows only the games that have both. Returns the number
+	// of games selected.
+	
+	int t;
+	int i;
+	unsigned long *result;
+	unsigned long *bits;
+	
+	result = state->filter_bits;
+	for(i = 0; i < state->filter_bits_words; i++){
+		result[i] = ~0UL;
+	}
+	for(t = 1; t <= FILTER_MAX; t++){
+		if (state->filter_active[t]){
+			bits = state->filter_bits + (t * state->filter_bits_words);
+			meta_BitsetAnd(result, bits, state->filter_bits_words);
+			if (FILTER_VERBOSE){
+				printf("%s.%d\t Info - Combining filter type %d\n", __FILE__, __LINE__, t);
+			}
+		}
+	}
+	i = sort_List(&gametable->sort, state->sort_order, result, state->filter_bits_words, state->selected_list);
+	filter_CacheAdd(state, gametable, i);
+	return i;
+}
+
+void filter_StateInit(state_t *state){
+	// Set up the UI state for an empty browser, before the first filter has been applied
+	
+	memset(state, 0, sizeof(state_t));
+	state->selected_page = 1;			// Default to first page of selected games
+	state->selected_line = 0;			// Default to first line selected
+	state->selected_list = NULL;		// Allocated by the first filter, once we know how many games there are
+	state->filter_bits = NULL;			// Allocated by the first filter, along with the selection list
+	state->filter_sort = FILTER_SORT_NAME;	// Until the config file says otherwise
+	state->filter_strings = NULL;		// Grown by the first filter popup to fit its genres, series etc.
+	state->filter_counts = NULL;
+	state->filter_strings_selected = NULL;
+	strpool_Init(&state->filter_pool);
+	filter_CacheInit(state);			// Results of recent filters, so switching back to one is quick
+	state->sort_order = SORT_NAME;		// Game ids are in name order, so this needs no sorting
+	state->selected_gameid = -1;		// Current selected game
+	state->active_pane = BROWSER_PANE;
+}
+
+void filter_CacheInit(state_t *state){
+	// Set up an empty filter cache - entries are allocated as they are first used
+	
+	int i;
+	
+	for(i = 0; i < FILTER_CACHE_SIZE; i++){
+		state->filter_cache[i].bits = NULL;
+		state->filter_cache[i].list = NULL;
+		state->filter_cache[i].list_size = 0;
+		state->filter_cache[i].count = -1;
+		state->filter_cache[i].words = 0;
+		state->filter_cache[i].used = 0;
+	}
+	state->filter_cache_clock = 0;
+	state->filter_cache_hits = 0;
+	state->filter_cache_misses = 0;
+}
+
+void filter_CacheClear(state_t *state){
+	// Forget every cached filter result, e.g. when the game table is replaced by a rescan
+	
+	// The memory of each entry is kept for re-use.
+	
+	int i;
+	
+	for(i = 0; i < FILTER_CACHE_SIZE; i++){
+		state->filter_cache[i].count = -1;
+	}
+}
+
+int filter_CacheFind(state_t *state, gametable_t *gametable, int type, long key){
+	// Look for the result of filtering type on key, combined with the other active filters
+	
+	// On a hit the bitsets and selection list are copied straight back from the
+	// cache and the number of games selected is returned; otherwise -1, and the
+	// caller works the filter out as normal. type FILTER_NONE looks for the
+	// filters exactly as they are now, e.g. after the order is changed.
+	
+	int i;
+	int t;
+	int match;
+	filtercache_t *entry;
+	
+	if ((state->filter_bits == NULL) || (state->filter_bits_words != meta_BitsetWords(&gametable->meta))){
+		state->filter_cache_misses++;
+		return -1;
+	}
+	for(i = 0; i < FILTER_CACHE_SIZE; i++){
+		entry = &state->filter_cache[i];
+		if ((entry->count < 0) || (entry->words != state->filter_bits_words) || (entry->sort_order != state->sort_order) || (entry->changes != gametable->meta.changes)){
+			continue;
+		}
+		match = 1;
+		for(t = 1; t <= FILTER_MAX; t++){
+			if (t == type){
+				if ((entry->active[t] == 0) || (entry->keys[t] != key)){
+					match = 0;
+				}
+			} else if ((entry->active[t] != state->filter_active[t]) || (state->filter_active[t] && (entry->keys[t] != state->filter_keys[t]))){
+				match = 0;
+			}
+		}
+		if (match){
+			memcpy(state->filter_bits, entry->bits, (FILTER_MAX + 1) * entry->words * sizeof(unsigned long));
+			memcpy(state->selected_list, entry->list, entry->count * sizeof(int));
+			memcpy(state->filter_active, entry->active, sizeof(state->filter_active));
+			memcpy(state->filter_keys, entry->keys, sizeof(state->filter_keys));
+			state->filter_cache_clock++;
+			entry->used = state->filter_cache_clock;
+			state->filter_cache_hits++;
+			if (FILTER_VERBOSE){
+				printf("%s.%d\t Info - Filter cache hit [entry:%d games:%d]\n", __FILE__, __LINE__, i, entry->count);
+			}
+			return entry->count;
+		}
+	}
+	state->filter_cache_misses++;
+	return -1;
+}
+
+int filter_CacheAdd(state_t *state, gametable_t *gametable, int count){
+	// Keep the result of the filters just applied, replacing the least recently used entry
+	
+	// Failing to allocate an entry only means the result is not cached.
+	
+	int i;
+	unsigned long *bits;
+	int *list;
+	filtercache_t *entry;
+	
+	entry = &state->filter_cache[0];
+	for(i = 1; i < FILTER_CACHE_SIZE; i++){
+		if ((entry->count >= 0) && ((state->filter_cache[i].count < 0) || (state->filter_cache[i].used < entry->used))){
+			entry = &state->filter_cache[i];
+		}
+	}
+	entry->count = -1;
+	
+	if (entry->words != state->filter_bits_words){
+		bits = (unsigned long *) realloc(entry->bits, (FILTER_MAX + 1) * state->filter_bits_words * sizeof(unsigned long));
+		if (bits == NULL){
+			return FILTER_ERR;
+		}
+		entry->bits = bits;
+		entry->words = state->filter_bits_words;
+	}
+	if (entry->list_size < count){
+		list = (int *) realloc(entry->list, count * sizeof(int));
+		if (list == NULL){
+			return FILTER_ERR;
+		}
+		entry->list = list;
+		entry->list_size = count;
+	}
+	
+	memcpy(entry->bits, state->filter_bits, (FILTER_MAX + 1) * entry->words * sizeof(unsigned long));
+	if (count > 0){
+		memcpy(entry->list, state->selected_list, count * sizeof(int));
+	}
+	memcpy(entry->active, state->filter_active, sizeof(entry->active));
+	memcpy(entry->keys, state->filter_keys, sizeof(entry->keys));
+	entry->sort_order = state->sort_order;
+	entry->changes = gametable->meta.changes;
+	state->filter_cache_clock++;
+	entry->used = state->filter_cache_clock;
+	entry->count = count;
+	return FILTER_OK;
+}
+
+int filter_GetGenres(state_t *state, gametable_t *gametable, launchdat_t *filterdat){
+	// Get all of the genres set in game metadata
+	
 	int c;
-	int found;
+	int id;
+	int g;
+	int gameid;
 	int status;
-	int next_pos;
-	gamedata_t *gamedata_head;
-	gamedata_head = gamedata; // Store first item
+	int *counts;
+	metaindex_t *meta;
 	
+	meta = &gametable->meta;
 	if (FILTER_VERBOSE){
-		printf("%s.%d\t Building series keyword selection list\n", __FILE__, __LINE__);
+		printf("%s.%d\t Building genre keyword selection list\n", __FILE__, __LINE__);
 	}
 	if (FILTER_VERBOSE){
 		printf("%s.%d\t Info - Clearing existing filter keywords list\n", __FILE__, __LINE__);
 	}
 	// Empty list
-	for(i =0; i <MAXIMUM_FILTER_STRINGS; i++){
-		memset(state->filter_strings[i], '\0', MAX_STRING_SIZE);
+	filter_ClearStrings(state);
+	
+	// Only the first filter after a (re)scan has to read any launch.dat files,
+	// after that this is one walk over the genre column of the metadata index,
+	// counting the games of every genre as it goes.
+	meta_LoadAll(meta, gametable, filterdat);
+	counts = (int *) calloc(meta->strings_size + 1, sizeof(int));
+	if (counts == NULL){
+		return FILTER_ERR;
 	}
 	
-	i = 0;
 	c = 0;
-	next_pos = 0;
-	while(gamedata != NULL){
+	for(g = 0; g < gametable->size; g++){
+		gameid = gametable->games[g].gameid;
 		
-		// Does game have metadata
-		if (gamedata->has_dat){
-			
-			// Load launch metadata
-			status = getLaunchdata(gamedata, filterdat);
-			if (status == 0){
-				
-				// Does the genre field match?
-				if (strcmp(filterdat->series, "") != 0){
-				
-					// Does this genre already exist?
-					found = 0;
-					for(a=0;a<MAXIMUM_FILTER_STRINGS;a++){
-						if (strcmp(state->filter_strings[a], filterdat->series) == 0){
-							found = 1;
-						}
-					}
-					// This genre isn't found yet, add it to the list of keywords
-					if (found == 0){
-						if (FILTER_VERBOSE){
-							printf("%s.%d\t Info - Found series: [%s]\n", __FILE__, __LINE__, filterdat->series);
-						}
-						strncpy(state->filter_strings[next_pos], filterdat->series, MAX_STRING_SIZE);
-						next_pos++;
-					}
-				}
+		// Count the games of each genre
+		if ((gameid >= 0) && (gameid < meta->size) && (meta->state[gameid] == META_STATE_LOADED)){
+			id = meta->genre[gameid];
+			if (id != META_NONE){
+				counts[id]++;
 			}
 		}
 		c++;
-		gamedata = gamedata->next;
 	}
-	gamedata = gamedata_head;
+	if (FILTER_VERBOSE){
+		printf("%s.%d\t Searched %d games\n", __FILE__, __LINE__, c);
+	}
+	
+	// Every genre with at least one game becomes a filter string
+	status = listFilterCounts(state, meta, counts, "genre");
+	free(counts);
+	return status;
+}
+
+int filter_GetSeries(state_t *state, gametable_t *gametable, launchdat_t *filterdat){
+	// Get all of the series names set in game metadata
 	
+	int c;
+	int id;
+	int g;
+	int gameid;
+	int status;
+	int *counts;
+	metaindex_t *meta;
+	
+	meta = &gametable->meta;
 	if (FILTER_VERBOSE){
-		printf("%s.%d\t Sorting keywords\n", __FILE__, __LINE__);
+		printf("%s.%d\t Building series keyword selection list\n", __FILE__, __LINE__);
 	}
-	sortFilterKeys(state, next_pos);
 	if (FILTER_VERBOSE){
-		for(a=0;a<next_pos;a++){
-			printf("%s.%d\t Info - Keyword %d: [%s]\n", __FILE__, __LINE__, a, state->filter_strings[a]);
-		}
+		printf("%s.%d\t Info - Clearing existing filter keywords list\n", __FILE__, __LINE__);
 	}
-	state->available_filter_strings = next_pos;
-	state->current_filter_page = 0;
-	state->available_filter_pages = ceil(((float)next_pos / (float)MAXIMUM_FILTER_STRINGS_PER_PAGE));
-	for(i = 0; i < MAXIMUM_FILTER_STRINGS; i++){
-		state->filter_strings_selected[i] = 0;
+	// Empty list
+	filter_ClearStrings(state);
+	
+	// Only the first filter after a (re)scan has to read any launch.dat files,
+	// after that this is one walk over the series column of the metadata index,
+	// counting the games of every series as it goes.
+	meta_LoadAll(meta, gametable, filterdat);
+	counts = (int *) calloc(meta->strings_size + 1, sizeof(int));
+	if (counts == NULL){
+		return FILTER_ERR;
 	}
 	
+	c = 0;
+	for(g = 0; g < gametable->size; g++){
+		gameid = gametable->games[g].gameid;
+		
+		// Count the games of each series
+		if ((gameid >= 0) && (gameid < meta->size) && (meta->state[gameid] == META_STATE_LOADED)){
+			id = meta->series[gameid];
+			if (id != META_NONE){
+				counts[id]++;
+			}
+		}
+		c++;
+	}
 	if (FILTER_VERBOSE){
 		printf("%s.%d\t Searched %d games\n", __FILE__, __LINE__, c);
-		printf("%s.%d\t Total of %d series filters added\n", __FILE__, __LINE__, next_pos);
-		printf("%s.%d\t Total of %d pages of filters\n", __FILE__, __LINE__, state->available_filter_pages);
 	}
-	return FILTER_OK;
+	
+	// Every series with at least one game becomes a filter string
+	status = listFilterCounts(state, meta, counts, "series");
+	free(counts);
+	return status;
 }
 
-int filter_GetCompany(state_t *state, gamedata_t *gamedata, launchdat_t *filterdat){
+int filter_GetCompany(state_t *state, gametable_t *gametable, launchdat_t *filterdat){
 	// Get all of the companies set in game metadata
 	
-	int i;
-	int a;
 	int c;
-	int found_dev;
-	int found_pub;
+	int id;
+	int g;
+	int gameid;
 	int status;
-	int next_pos;
-	gamedata_t *gamedata_head;
-	gamedata_head = gamedata; // Store first item
+	int *counts;
+	metaindex_t *meta;
 	
+	meta = &gametable->meta;
 	if (FILTER_VERBOSE){
 		printf("%s.%d\t Building company keyword selection list\n", __FILE__, __LINE__);
 	}
@@ -235,85 +584,45 @@ int filter_GetCompany(state_t *state, gamedata_t *gamedata, launchdat_t *filterd
 		printf("%s.%d\t Info - Clearing existing filter keywords list\n", __FILE__, __LINE__);
 	}
 	// Empty list
-	for(i =0; i <MAXIMUM_FILTER_STRINGS; i++){
-		memset(state->filter_strings[i], '\0', MAX_STRING_SIZE);
+	filter_ClearStrings(state);
+	
+	// Developers and publishers share the interned strings, so a company
+	// that is both developer and publisher of different games is only listed once.
+	meta_LoadAll(meta, gametable, filterdat);
+	counts = (int *) calloc(meta->strings_size + 1, sizeof(int));
+	if (counts == NULL){
+		return FILTER_ERR;
 	}
 	
-	i = 0;
 	c = 0;
-	next_pos = 0;
-	while(gamedata != NULL){
+	for(g = 0; g < gametable->size; g++){
+		gameid = gametable->games[g].gameid;
 		
-		// Does game have metadata
-		if (gamedata->has_dat){
-			
-			// Load launch metadata
-			status = getLaunchdata(gamedata, filterdat);
-			if (status == 0){
-				
-				// Does the developer or publisher field match?
-				if ((strcmp(filterdat->developer, "") != 0) || (strcmp(filterdat->publisher, "") != 0)){
-				
-					// Does this company already exist?
-					found_pub = 0;
-					found_dev = 0;
-					for(a=0;a<MAXIMUM_FILTER_STRINGS;a++){
-						if (strcmp(state->filter_strings[a], filterdat->developer) == 0){
-							found_dev = 1;
-						}
-						if (strcmp(state->filter_strings[a], filterdat->publisher) == 0){
-							found_pub = 1;
-						}
-					}
-					// This company isn't found yet, add it to the list of keywords
-					if (found_dev == 0){
-						if (FILTER_VERBOSE){
-							printf("%s.%d\t Info - Found developer: [%s]\n", __FILE__, __LINE__, filterdat->developer);
-						}
-						strncpy(state->filter_strings[next_pos], filterdat->developer, MAX_STRING_SIZE);
-						next_pos++;
-					}
-					if (found_pub == 0){
-						if (FILTER_VERBOSE){
-							printf("%s.%d\t Info - Found publisher: [%s]\n", __FILE__, __LINE__, filterdat->publisher);
-						}
-						strncpy(state->filter_strings[next_pos], filterdat->publisher, MAX_STRING_SIZE);
-						next_pos++;
-					}
-				}
+		// Count the games of each developer and publisher; a game is only counted
+		// once for a company that is both its developer and publisher.
+		if ((gameid >= 0) && (gameid < meta->size) && (meta->state[gameid] == META_STATE_LOADED)){
+			id = meta->developer[gameid];
+			if (id != META_NONE){
+				counts[id]++;
+			}
+			id = meta->publisher[gameid];
+			if ((id != META_NONE) && (id != meta->developer[gameid])){
+				counts[id]++;
 			}
 		}
 		c++;
-		gamedata = gamedata->next;
-	}
-	gamedata = gamedata_head;
-	
-	if (FILTER_VERBOSE){
-		printf("%s.%d\t Sorting keywords\n", __FILE__, __LINE__);
 	}
-	sortFilterKeys(state, next_pos);
 	if (FILTER_VERBOSE){
-		for(a=0;a<next_pos;a++){
-			printf("%s.%d\t Info - Keyword %d: [%s]\n", __FILE__, __LINE__, a, state->filter_strings[a]);
-		}
-	}
-	state->available_filter_strings = next_pos;
-	state->current_filter_page = 0;
-	state->available_filter_pages = ceil(((float)next_pos / (float)MAXIMUM_FILTER_STRINGS_PER_PAGE));
-	for(i = 0; i < MAXIMUM_FILTER_STRINGS; i++){
-		state->filter_strings_selected[i] = 0;
+		printf("%s.%d\t Searched %d games\n", __FILE__, __LINE__, c);
 	}
 	
-	if (FILTER_VERBOSE){
-		printf("%s.%d\t Searched %d games\n", __FILE__, __LINE__, c);
-		printf("%s.%d\t Total of %d company filters added\n", __FILE__, __LINE__, next_pos);
-		printf("%s.%d\t Total of %d pages of filters\n", __FILE__, __LINE__, state->available_filter_pages);
-	} 
-	return FILTER_OK;
+	// Every company with at least one game becomes a filter string
+	status = listFilterCounts(state, meta, counts, "company");
+	free(counts);
+	return status;
 }
 
-
-int filter_GetTechSpecs(state_t *state, gamedata_t *gamedata, launchdat_t *filterdat){
+int filter_GetTechSpecs(state_t *state, gametable_t *gametable, launchdat_t *filterdat){
 	// Get a list of tech specs that we can filter games on
 	
 	// Unlike genres, companies and series, these filters are not actually
@@ -322,51 +631,48 @@ int filter_GetTechSpecs(state_t *state, gamedata_t *gamedata, launchdat_t *filte
 	
 	int i;
 	int next_pos;
+	int counts[META_HW_BITS];
+	metaindex_t *meta;
+	
+	meta = &gametable->meta;
 	next_pos = 0;
 	
 	if (FILTER_VERBOSE){
-		printf("%s.%d\t Building company keyword selection list\n", __FILE__, __LINE__);
+		printf("%s.%d\t Building tech specs keyword selection list\n", __FILE__, __LINE__);
 	}
 	if (FILTER_VERBOSE){
 		printf("%s.%d\t Info - Clearing existing filter keywords list\n", __FILE__, __LINE__);
 	}
 	// Empty list
-	for(i =0; i <MAXIMUM_FILTER_STRINGS; i++){
-		memset(state->filter_strings[i], '\0', MAX_STRING_SIZE);
-	}
+	filter_ClearStrings(state);
 	
-	// Audio/Sound
-	strncpy(state->filter_strings[next_pos], FILTER_STRING_CONTROL_CYBERSTICK, MAX_STRING_SIZE);
-	next_pos++;
-	strncpy(state->filter_strings[next_pos], FILTER_STRING_MISC_FPU, MAX_STRING_SIZE);
-	next_pos++;
-	strncpy(state->filter_strings[next_pos], FILTER_STRING_FLOPPY_2HDBOOT, MAX_STRING_SIZE);
-	next_pos++;
-	strncpy(state->filter_strings[next_pos], FILTER_STRING_FLOPPY_2HDSIM, MAX_STRING_SIZE);
-	next_pos++;
+	// Count the games with each hardware flag, and offer every one of them
+	meta_LoadAll(meta, gametable, filterdat);
+	meta_CountHardware(meta, counts);
+	for(i = 0; i < META_HW_BITS; i++){
+		if (filter_AddString(state, meta_HardwareName(i), counts[i]) != FILTER_OK){
+			return FILTER_ERR;
+		}
+	}
+	next_pos = state->available_filter_strings;
 	
 	if (FILTER_VERBOSE){
 		printf("%s.%d\t Sorting keywords\n", __FILE__, __LINE__);
 	}
 	sortFilterKeys(state, next_pos);
 	
-	state->available_filter_strings = next_pos;
 	state->current_filter_page = 0;
 	state->available_filter_pages = ceil(((float)next_pos / (float)MAXIMUM_FILTER_STRINGS_PER_PAGE));
-	for(i = 0; i < MAXIMUM_FILTER_STRINGS; i++){
-		state->filter_strings_selected[i] = 0;
-	}
 	
 	return FILTER_OK;
 }
 
-int filter_None(state_t *state, gamedata_t *gamedata){
+int filter_None(state_t *state, gametable_t *gametable){
 	// Apply no filter to the list of gamedata - all games
 	
 	int i;
-	gamedata_t *gamedata_head;
-	
-	gamedata_head = gamedata; // Store first item
+	int g;
+	gamedata_t *gamedata;
 	
 	if (FILTER_VERBOSE){
 		printf("%s.%d\t Building unfiltered selection list\n", __FILE__, __LINE__);
@@ -375,30 +681,36 @@ int filter_None(state_t *state, gamedata_t *gamedata){
 		printf("%s.%d\t Info - Clearing existing selection list\n", __FILE__, __LINE__);
 	}
 	// Empty list
-	for(i =0; i <SELECTION_LIST_SIZE; i++){
-		state->selected_list[i] = -1;
+	if (filter_ResetSelection(state, gametable->size) != FILTER_OK){
+		return FILTER_ERR;
+	}
+	// All games, so no filters are combined any more
+	if (filter_ResetBitsets(state, gametable) != FILTER_OK){
+		return FILTER_ERR;
 	}
 	if (FILTER_VERBOSE){
 		printf("%s.%d\t Info - Clearing existing filter string list\n", __FILE__, __LINE__);
 	}
 	// Empty filter string list
-	for(i =0; i <MAXIMUM_FILTER_STRINGS; i++){
-		memset(state->filter_strings[i], '\0', MAX_STRING_SIZE);
-	}
+	filter_ClearStrings(state);
 	
 	i = 0;
-	while(gamedata != NULL){
-		if (FILTER_VERBOSE){
-			printf("%s.%d\t Info - adding Game ID: [%d], %s\n", __FILE__, __LINE__, gamedata->gameid, gamedata->name);
+	if ((state->sort_order != SORT_NAME) && (gametable->sort.orders != NULL)){
+		// Every game, in the order chosen by the user
+		i = sort_List(&gametable->sort, state->sort_order, NULL, 0, state->selected_list);
+	} else {
+		for(g = 0; g < gametable->size; g++){
+			gamedata = &gametable->games[g];
+			if (FILTER_VERBOSE){
+				printf("%s.%d\t Info - adding Game ID: [%d], %s\n", __FILE__, __LINE__, gamedata->gameid, gamedata->name);
+			}
+			state->selected_list[i] = gamedata->gameid;
+			i++;
 		}
-		state->selected_list[i] = gamedata->gameid;
-		gamedata = gamedata->next;
-		i++;
 	}
 	if (FILTER_VERBOSE){
 		printf("%s.%d\t Total of %d games in list\n", __FILE__, __LINE__, i);
 	}
-	gamedata = gamedata_head;	// Restore first item
 	state->selected_max = i; 	// Number of items in selection list
 	state->selected_page = 1;	// Start on page 1
 	state->selected_line = 0;	// Start on line 0
@@ -407,48 +719,42 @@ int filter_None(state_t *state, gamedata_t *gamedata){
 	state->current_filter_page = 0;
 	state->available_filter_pages = 0;
 	state->selected_gameid = state->selected_list[0]; 	// Initial game is the 0th element of the selection list
-	state->selected_game = getGameid(state->selected_gameid, gamedata);
-	for(i = 0; i <= state->selected_max ; i++){
-		if (i % ui_browser_max_lines == 0){
-			state->total_pages++;
-		}
-	}
-	for(i = 0; i < MAXIMUM_FILTER_STRINGS; i++){
-		state->filter_strings_selected[i] = 0;
-	}
+	state->selected_game = getGameid(state->selected_gameid, gametable);
+	filter_SetPages(state);
 	
 	return FILTER_OK;
 }
 
-int filter_Genre(state_t *state, gamedata_t *gamedata, launchdat_t *filterdat){
-	// Filter all games on a specific genre string
+int filterColumn(state_t *state, gametable_t *gametable, launchdat_t *filterdat, int type, char *name, unsigned short *column, unsigned short *column2){
+	// Filter all games on the selected string, matched against one or two columns of the metadata index
 	int i;
-	int c;
-	int status;
-	gamedata_t *gamedata_head;
+	int filter_id;
+	unsigned long *bits;
+	metaindex_t *meta;
 	char filter[MAX_STRING_SIZE];
 	
-	strncpy(filter, state->filter_strings[state->selected_filter_string], MAX_STRING_SIZE);
-	
-	gamedata_head = gamedata; // Store first item
+	// Copied, as clearing the filter strings below frees the selected one
+	memset(filter, '\0', MAX_STRING_SIZE);
+	if ((state->selected_filter_string >= 0) && (state->selected_filter_string < (int)state->available_filter_strings)){
+		strncpy(filter, state->filter_strings[state->selected_filter_string], MAX_STRING_SIZE - 1);
+	}
+	meta = &gametable->meta;
 	
 	if (FILTER_VERBOSE){
-		printf("%s.%d\t Building genre selection list [%s]\n", __FILE__, __LINE__, filter);
+		printf("%s.%d\t Building %s selection list [%s]\n", __FILE__, __LINE__, name, filter);
 	}
 	if (FILTER_VERBOSE){
 		printf("%s.%d\t Info - Clearing existing selection list\n", __FILE__, __LINE__);
 	}
 	// Empty list
-	for(i =0; i <SELECTION_LIST_SIZE; i++){
-		state->selected_list[i] = -1;
+	if (filter_ResetSelection(state, gametable->size) != FILTER_OK){
+		return FILTER_ERR;
 	}
 	if (FILTER_VERBOSE){
 		printf("%s.%d\t Info - Clearing existing filter string list\n", __FILE__, __LINE__);
 	}
 	// Empty filter string list
-	for(i =0; i <MAXIMUM_FILTER_STRINGS; i++){
-		memset(state->filter_strings[i], '\0', MAX_STRING_SIZE);
-	}
+	filter_ClearStrings(state);
 	
 	state->selected_max = 0; 	
 	state->selected_page = 1;	
@@ -457,360 +763,392 @@ int filter_Genre(state_t *state, gamedata_t *gamedata, launchdat_t *filterdat){
 	state->selected_gameid = -1;
 	state->selected_game = NULL;
 	
-	i = 0;
-	c = 0;
-	while(gamedata != NULL){
-		
-		// Does game have metadata
-		if (gamedata->has_dat){
-			
-			// Load launch metadata
-			status = getLaunchdata(gamedata, filterdat);
-			if (status == 0){
-				
-				if (FILTER_VERBOSE){
-					printf("%s.%d\t Info - Checking %s == %s\n", __FILE__, __LINE__, filterdat->genre, filter);
-				}
-				
-				// Does the genre field match?
-				if (strncmp(filterdat->genre, filter, MAX_STRING_SIZE) == 0){
-				
-					if (FILTER_VERBOSE){
-						printf("%s.%d\t Info - adding Game ID: [%d], %s\n", __FILE__, __LINE__, gamedata->gameid, gamedata->name);
-					}
-					
-					// Add the selected gameid to the selection list
-					state->selected_list[i] = gamedata->gameid;
-					i++;
-				}
-			} else {
-				if (FILTER_VERBOSE){
-					printf("%s.%d\t Warning, metadata not loaded for Game ID: [%d], %s\n", __FILE__, __LINE__, gamedata->gameid, gamedata->name);
-				}
+	// Normally already done when the list of filter strings was built
+	meta_LoadAll(meta, gametable, filterdat);
+	filter_id = meta_Find(meta, filter);
+	
+	i = filter_CacheFind(state, gametable, type, filter_id);
+	if (i < 0){
+		bits = filter_NewBitset(state, gametable, type, filter_id);
+		if (bits == NULL){
+			return FILTER_ERR;
+		}
+		if (filter_id != META_NONE){
+			meta_BitsetMatch(meta, column, filter_id, bits);
+			if (column2 != NULL){
+				meta_BitsetMatch(meta, column2, filter_id, bits);
 			}
 		}
-		c++;
-		gamedata = gamedata->next;
+		i = filter_ApplyBitsets(state, gametable);
 	}
 	if (FILTER_VERBOSE){
-		printf("%s.%d\t Searched %d games\n", __FILE__, __LINE__, c);
-		printf("%s.%d\t Total of %d filtered games in genre list\n", __FILE__, __LINE__, i);
+		printf("%s.%d\t Total of %d filtered games in %s list\n", __FILE__, __LINE__, i, name);
 	} 
 	
-	gamedata = gamedata_head;
 	state->selected_max = i; 	// Number of items in selection list
 	state->selected_page = 1;	// Start on page 1
 	state->selected_line = 0;	// Start on line 0
 	state->total_pages = 0;		
 	state->selected_filter_string = 0;
 	state->selected_gameid = state->selected_list[0]; 	// Initial game is the 0th element of the selection list
-	state->selected_game = getGameid(state->selected_gameid, gamedata);
-	for(i = 0; i <= state->selected_max ; i++){
-		if (i % ui_browser_max_lines == 0){
-			state->total_pages++;
-		}
-	}
+	state->selected_game = getGameid(state->selected_gameid, gametable);
+	filter_SetPages(state);
 	return FILTER_OK;
 }
 
-int filter_Series(state_t *state, gamedata_t *gamedata, launchdat_t *filterdat){
+int filter_Genre(state_t *state, gametable_t *gametable, launchdat_t *filterdat){
+	// Filter all games on a specific genre string
+	
+	return filterColumn(state, gametable, filterdat, FILTER_GENRE, "genre", gametable->meta.genre, NULL);
+}
+
+int filter_Series(state_t *state, gametable_t *gametable, launchdat_t *filterdat){
 	// Filter all games on a specific series string
-	int i;
-	int c;
-	int status;
-	gamedata_t *gamedata_head;
-	char filter[MAX_STRING_SIZE];
-	gamedata_head = gamedata; // Store first item
 	
-	strncpy(filter, state->filter_strings[state->selected_filter_string], MAX_STRING_SIZE);
+	return filterColumn(state, gametable, filterdat, FILTER_SERIES, "series", gametable->meta.series, NULL);
+}
+
+int filter_Company(state_t *state, gametable_t *gametable, launchdat_t *filterdat){
+	// Filter all games on a specific developer or publisher string
 	
+	return filterColumn(state, gametable, filterdat, FILTER_COMPANY, "company", gametable->meta.developer, gametable->meta.publisher);
+}
+
+int filter_TechSpecs(state_t *state, gametable_t *gametable, launchdat_t *filterdat){
+	// Filter the list of games based on one or more selected technical criteria
+	// set in the state->filter_strings_selected array
+	
+	int i, f;
+	unsigned char mask;
+	unsigned long *bits;
+	metaindex_t *meta;
+	
+	meta = &gametable->meta;
 	if (FILTER_VERBOSE){
-		printf("%s.%d\t Building series selection list [%s]\n", __FILE__, __LINE__, filter);
-	}
-	if (FILTER_VERBOSE){
+		printf("%s.%d\t Building tech specs selection list\n", __FILE__, __LINE__);
 		printf("%s.%d\t Info - Clearing existing selection list\n", __FILE__, __LINE__);
 	}
 	// Empty list
-	for(i =0; i <SELECTION_LIST_SIZE; i++){
-		state->selected_list[i] = -1;
+	if (filter_ResetSelection(state, gametable->size) != FILTER_OK){
+		return FILTER_ERR;
 	}
+	
+	// Determine if we are filtering any of cpu/video/audio tech specs
 	if (FILTER_VERBOSE){
-		printf("%s.%d\t Info - Clearing existing filter string list\n", __FILE__, __LINE__);
-	}
-	// Empty filter string list
-	for(i =0; i <MAXIMUM_FILTER_STRINGS; i++){
-		memset(state->filter_strings[i], '\0', MAX_STRING_SIZE);
+		for(f = 0; f < state->available_filter_strings; f++){
+			if (state->filter_strings_selected[f] == 1){
+				printf("%s.%d\t - Adding filter for: %s\n", __FILE__, __LINE__, state->filter_strings[f]);
+			}
+		}
 	}
 	
-	state->selected_max = 0; 	
-	state->selected_page = 1;	
-	state->selected_line = 0;	
-	state->total_pages = 0;		
-	state->selected_gameid = -1;
-	state->selected_game = NULL;
+	// Turn the selected filter strings into a mask of hardware bits once,
+	// so each game is then a single test against the metadata index.
+	mask = 0;
+	for(f = 0; f < state->available_filter_strings; f++){
+		if (state->filter_strings_selected[f] == 1){
+			mask |= meta_HardwareFlag(state->filter_strings[f]);
+		}
+	}
 	
-	i = 0;
-	c = 0;
-	while(gamedata != NULL){
-		
-		// Does game have metadata
-		if (gamedata->has_dat){
-			
-			// Load launch metadata
-			status = getLaunchdata(gamedata, filterdat);
-			if (status == 0){
-				
-				if (FILTER_VERBOSE){
-					printf("%s.%d\t Info - Checking %s == %s\n", __FILE__, __LINE__, filterdat->series, filter);
-				}
-				
-				// Does the genre field match?
-				if (strncmp(filterdat->series, filter, MAX_STRING_SIZE) == 0){
-				
-					if (FILTER_VERBOSE){
-						printf("%s.%d\t Info - adding Game ID: [%d], %s\n", __FILE__, __LINE__, gamedata->gameid, gamedata->name);
-					}
-					
-					// Add the selected gameid to the selection list
-					state->selected_list[i] = gamedata->gameid;
-					i++;
-				}
-			} else {
-				if (FILTER_VERBOSE){
-					printf("%s.%d\t Warning, metadata not loaded for Game ID: [%d], %s\n", __FILE__, __LINE__, gamedata->gameid, gamedata->name);
-				}
-			}
+	// The search is a composite AND statement, so every selected bit
+	// must be set for a game to match.
+	meta_LoadAll(meta, gametable, filterdat);
+	i = filter_CacheFind(state, gametable, FILTER_TECH, mask);
+	if (i < 0){
+		bits = filter_NewBitset(state, gametable, FILTER_TECH, mask);
+		if (bits == NULL){
+			return FILTER_ERR;
 		}
-		c++;
-		gamedata = gamedata->next;
+		meta_BitsetHardware(meta, mask, bits);
+		i = filter_ApplyBitsets(state, gametable);
 	}
 	if (FILTER_VERBOSE){
-		printf("%s.%d\t Searched %d games\n", __FILE__, __LINE__, c);
-		printf("%s.%d\t Total of %d filtered games in series list\n", __FILE__, __LINE__, i);
-	} 
+		printf("%s.%d\t Total of %d filtered games in tech specs list\n", __FILE__, __LINE__, i);
+	}
 	
-	gamedata = gamedata_head;
 	state->selected_max = i; 	// Number of items in selection list
 	state->selected_page = 1;	// Start on page 1
 	state->selected_line = 0;	// Start on line 0
 	state->total_pages = 0;		
 	state->selected_filter_string = 0;
 	state->selected_gameid = state->selected_list[0]; 	// Initial game is the 0th element of the selection list
-	state->selected_game = getGameid(state->selected_gameid, gamedata);
-	for(i = 0; i <= state->selected_max ; i++){
-		if (i % ui_browser_max_lines == 0){
-			state->total_pages++;
-		}
-	}
+	state->selected_game = getGameid(state->selected_gameid, gametable);
+	filter_SetPages(state);
+	
 	return FILTER_OK;
+	
 }
 
-int filter_Company(state_t *state, gamedata_t *gamedata, launchdat_t *filterdat){
-	// Filter all games on a specific developer or publisher string
-	int i;
-	int c;
-	int status;
-	gamedata_t *gamedata_head;
-	char filter[MAX_STRING_SIZE];
+int filter_GetYears(state_t *state, gametable_t *gametable, launchdat_t *filterdat){
+	// Get a histogram of release years, as a list of decades each followed by its years
 	
-	strncpy(filter, state->filter_strings[state->selected_filter_string], MAX_STRING_SIZE);
+	// The year index holds every game sorted by year, so the number of games
+	// in each year is just the length of its run of entries, and a decade is
+	// the sum of its years. Each entry is listed with its count, e.g. "1980-1989"
+	// then "1987", "1988" and so on, already in order.
 	
-	gamedata_head = gamedata; // Store first item
+	int i;
+	int end;
+	int year;
+	int decade;
+	char buf[MAX_STRING_SIZE];
+	metaindex_t *meta;
 	
+	meta = &gametable->meta;
 	if (FILTER_VERBOSE){
-		printf("%s.%d\t Building company selection list [%s]\n", __FILE__, __LINE__, filter);
+		printf("%s.%d\t Building year keyword selection list\n", __FILE__, __LINE__);
+	}
+	// Empty list
+	filter_ClearStrings(state);
+	
+	meta_LoadAll(meta, gametable, filterdat);
+	if ((meta->years == NULL) && (meta_BuildYears(meta) != META_OK)){
+		return FILTER_ERR;
+	}
+	
+	i = 0;
+	while (i < meta->years_size){
+		// A decade, then each year in it
+		decade = meta->years[i].year - (meta->years[i].year % 10);
+		end = meta_FindYear(meta, decade + 10);
+		sprintf(buf, FILTER_STRING_YEARS, decade, decade + 9);
+		if (filter_AddString(state, buf, end - i) != FILTER_OK){
+			return FILTER_ERR;
+		}
+		while (i < end){
+			year = meta->years[i].year;
+			sprintf(buf, "%d", year);
+			if (filter_AddString(state, buf, meta_FindYear(meta, year + 1) - i) != FILTER_OK){
+				return FILTER_ERR;
+			}
+			i = meta_FindYear(meta, year + 1);
+		}
 	}
+	
+	state->current_filter_page = 0;
+	state->available_filter_pages = ceil(((float)state->available_filter_strings / (float)MAXIMUM_FILTER_STRINGS_PER_PAGE));
 	if (FILTER_VERBOSE){
-		printf("%s.%d\t Info - Clearing existing selection list\n", __FILE__, __LINE__);
+		printf("%s.%d\t Total of %d year filters added from %d games\n", __FILE__, __LINE__, state->available_filter_strings, meta->years_size);
 	}
-	// Empty list
-	for(i =0; i <SELECTION_LIST_SIZE; i++){
-		state->selected_list[i] = -1;
+	return FILTER_OK;
+}
+
+int filter_Year(state_t *state, gametable_t *gametable, launchdat_t *filterdat){
+	// Filter all games on a single year, or a range of years, chosen from the year list
+	
+	int i;
+	int from;
+	int to;
+	unsigned long *bits;
+	metaindex_t *meta;
+	
+	meta = &gametable->meta;
+	from = 0;
+	to = -1;
+	if ((state->selected_filter_string >= 0) && (state->selected_filter_string < (int)state->available_filter_strings)){
+		if (sscanf(state->filter_strings[state->selected_filter_string], FILTER_STRING_YEARS, &from, &to) == 1){
+			to = from;
+		}
 	}
 	if (FILTER_VERBOSE){
-		printf("%s.%d\t Info - Clearing existing filter string list\n", __FILE__, __LINE__);
+		printf("%s.%d\t Building year selection list [%d to %d]\n", __FILE__, __LINE__, from, to);
 	}
-	// Empty filter string list
-	for(i =0; i <MAXIMUM_FILTER_STRINGS; i++){
-		memset(state->filter_strings[i], '\0', MAX_STRING_SIZE);
+	// Empty list
+	if (filter_ResetSelection(state, gametable->size) != FILTER_OK){
+		return FILTER_ERR;
 	}
+	// Empty filter string list
+	filter_ClearStrings(state);
 	
-	state->selected_max = 0; 	
-	state->selected_page = 1;	
-	state->selected_line = 0;	
-	state->total_pages = 0;		
-	state->selected_gameid = -1;
-	state->selected_game = NULL;
+	// Normally already done when the list of years was built
+	meta_LoadAll(meta, gametable, filterdat);
+	if ((meta->years == NULL) && (meta_BuildYears(meta) != META_OK)){
+		return FILTER_ERR;
+	}
 	
-	i = 0;
-	c = 0;
-	while(gamedata != NULL){
-		
-		// Does game have metadata
-		if (gamedata->has_dat){
-			
-			// Load launch metadata
-			status = getLaunchdata(gamedata, filterdat);
-			if (status == 0){
-				
-				if (FILTER_VERBOSE){
-					printf("%s.%d\t Info - Checking %s OR %s == %s\n", __FILE__, __LINE__, filterdat->developer, filterdat->publisher, filter);
-				}
-				
-				// Does the publisher or developer field match?
-				if ((strncmp(filterdat->developer, filter, MAX_STRING_SIZE) == 0) || (strncmp(filterdat->publisher, filter, MAX_STRING_SIZE) == 0)){
-				
-					if (FILTER_VERBOSE){
-						printf("%s.%d\t Yes - adding Game ID: [%d], %s\n", __FILE__, __LINE__, gamedata->gameid, gamedata->name);
-					}
-					
-					// Add the selected gameid to the selection list
-					state->selected_list[i] = gamedata->gameid;
-					i++;
-				}
-			} else {
-				if (FILTER_VERBOSE){
-					printf("%s.%d\t Warning, metadata not loaded for Game ID: [%d], %s\n", __FILE__, __LINE__, gamedata->gameid, gamedata->name);
-				}
-			}
+	i = filter_CacheFind(state, gametable, FILTER_YEAR, FILTER_KEY_YEARS(from, to));
+	if (i < 0){
+		bits = filter_NewBitset(state, gametable, FILTER_YEAR, FILTER_KEY_YEARS(from, to));
+		if (bits == NULL){
+			return FILTER_ERR;
 		}
-		c++;
-		gamedata = gamedata->next;
+		meta_BitsetYears(meta, from, to, bits);
+		i = filter_ApplyBitsets(state, gametable);
 	}
 	if (FILTER_VERBOSE){
-		printf("%s.%d\t Searched %d games\n", __FILE__, __LINE__, c);
-		printf("%s.%d\t Total of %d filtered games in company list\n", __FILE__, __LINE__, i);
-	} 
+		printf("%s.%d\t Total of %d filtered games in year list\n", __FILE__, __LINE__, i);
+	}
 	
-	gamedata = gamedata_head;
 	state->selected_max = i; 	// Number of items in selection list
 	state->selected_page = 1;	// Start on page 1
 	state->selected_line = 0;	// Start on line 0
 	state->total_pages = 0;		
 	state->selected_filter_string = 0;
 	state->selected_gameid = state->selected_list[0]; 	// Initial game is the 0th element of the selection list
-	state->selected_game = getGameid(state->selected_gameid, gamedata);
-	for(i = 0; i <= state->selected_max ; i++){
-		if (i % ui_browser_max_lines == 0){
-			state->total_pages++;
+	state->selected_game = getGameid(state->selected_gameid, gametable);
+	filter_SetPages(state);
+	return FILTER_OK;
+}
+
+int filter_HasGame(state_t *state, int gameid){
+	// Return 1 if a game is in the result of the last combined filter
+	
+	if ((gameid < 0) || (gameid >= (state->filter_bits_words * META_BITSET_BITS))){
+		return 0;
+	}
+	return (state->filter_bits[gameid / META_BITSET_BITS] & (1UL << (gameid % META_BITSET_BITS))) != 0;
+}
+
+int filter_Reapply(state_t *state, gametable_t *gametable){
+	// Rebuild the selection list from the active filters, e.g. after a search is cancelled
+	
+	int i;
+	int filtered;
+	
+	filtered = 0;
+	for(i = 1; i <= FILTER_MAX; i++){
+		if (state->filter_active[i]){
+			filtered = 1;
 		}
 	}
+	if (filtered == 0){
+		return filter_None(state, gametable);
+	}
+	
+	// A change of order is often back to one that was used before
+	i = filter_CacheFind(state, gametable, FILTER_NONE, 0);
+	if (i < 0){
+		i = filter_ApplyBitsets(state, gametable);
+	}
+	state->selected_max = i; 	// Number of items in selection list
+	state->selected_page = 1;	// Start on page 1
+	state->selected_line = 0;	// Start on line 0
+	state->selected_gameid = state->selected_list[0]; 	// Initial game is the 0th element of the selection list
+	state->selected_game = getGameid(state->selected_gameid, gametable);
+	filter_SetPages(state);
 	return FILTER_OK;
 }
 
-int filter_TechSpecs(state_t *state, gamedata_t *gamedata, launchdat_t *filterdat){
-	// Filter the list of games based on one or more selected technical criteria
-	// set in the state->filter_strings_selected array
+int filter_SetOrder(state_t *state, gametable_t *gametable, launchdat_t *filterdat, int order){
+	// Change the order games are listed in, keeping the current filters
+	
+	// The orders are all built together the first time anything other than name
+	// order is asked for, which means reading the metadata of every game. After
+	// that, changing order is just listing the games from a different permutation.
 	
-	char filter_string[MAX_STRING_SIZE];
-	int i, f;
 	int status;
-	unsigned short added_list[SELECTION_LIST_SIZE];
-	unsigned char continue_search;
 	
-	gamedata_t *gamedata_head;
+	if ((order != SORT_NAME) && (gametable->sort.orders == NULL)){
+		meta_LoadAll(&gametable->meta, gametable, filterdat);
+		status = sort_Build(&gametable->sort, gametable);
+		if (status != SORT_OK){
+			if (FILTER_VERBOSE){
+				printf("%s.%d\t Error - Unable to build sort orders [status:%d]\n", __FILE__, __LINE__, status);
+			}
+			state->sort_order = SORT_NAME;
+			filter_Reapply(state, gametable);
+			return FILTER_ERR;
+		}
+	}
+	state->sort_order = order;
+	return filter_Reapply(state, gametable);
+}
+
+int filter_SearchReset(state_t *state, gametable_t *gametable){
+	// Widen the search range to the whole search index, building the index if need be
 	
-	gamedata_head = gamedata; // Store first item
+	if (gametable->search.order == NULL){
+		if (search_Build(&gametable->search, gametable) != SEARCH_OK){
+			state->search_low = 0;
+			state->search_high = 0;
+			return FILTER_ERR;
+		}
+	}
+	state->search_low = 0;
+	state->search_high = gametable->search.size;
+	return FILTER_OK;
+}
+
+int filter_Search(state_t *state, gametable_t *gametable){
+	// Narrow the selection list to the games whose names start with state->search
 	
-	if (FILTER_VERBOSE){
-		printf("%s.%d\t Building tech specs selection list\n", __FILE__, __LINE__);
-		printf("%s.%d\t Info - Clearing existing selection list\n", __FILE__, __LINE__);
+	// Only games matching the active filters are kept. The range of the search
+	// index in state->search_low and state->search_high is narrowed in place, so
+	// reset it to the whole index whenever the search gets shorter.
+	// If no name starts with the search, the best fuzzy (trigram) matches are
+	// selected instead, so "Cho Ren Sha" still finds "Chorensha".
+	// Returns the number of games selected; if there are none, the selection
+	// list is left as it was.
+	
+	int i;
+	int n;
+	int low;
+	int high;
+	int gameid;
+	int filtered;
+	int found;
+	int fuzzy[FILTER_FUZZY_MAX];
+	searchindex_t *search;
+	
+	search = &gametable->search;
+	if (search->order == NULL){
+		if (filter_SearchReset(state, gametable) != FILTER_OK){
+			return FILTER_ERR;
+		}
 	}
-	// Empty list
-	for(i =0; i <SELECTION_LIST_SIZE; i++){
-		state->selected_list[i] = -1;
+	
+	// Are any of the other filters in use?
+	filtered = 0;
+	for(i = 1; i <= FILTER_MAX; i++){
+		if (state->filter_active[i]){
+			filtered = 1;
+		}
 	}
 	
-	// Determine if we are filtering any of cpu/video/audio tech specs
+	n = 0;
+	low = state->search_low;
+	high = state->search_high;
+	search_Narrow(search, gametable, state->search, &low, &high);
+	for(i = low; i < high; i++){
+		gameid = search->order[i];
+		if ((filtered == 0) || filter_HasGame(state, gameid)){
+			state->selected_list[n] = gameid;
+			n++;
+		}
+	}
 	if (FILTER_VERBOSE){
-		for(f = 0; f <MAXIMUM_FILTER_STRINGS; f++){
-			if (state->filter_strings_selected[f] == 1){
-				printf("%s.%d\t - Adding filter for: %s\n", __FILE__, __LINE__, state->filter_strings[f]);
+		printf("%s.%d\t Search [%s] matched %d names, %d games selected\n", __FILE__, __LINE__, state->search, high - low, n);
+	}
+	if (n > 0){
+		state->search_low = low;
+		state->search_high = high;
+		state->search_fuzzy = 0;
+	} else {
+		if (gametable->trigrams.keys == NULL){
+			search_BuildTrigrams(&gametable->trigrams, gametable);
+		}
+		found = search_Fuzzy(&gametable->trigrams, gametable, state->search, fuzzy, FILTER_FUZZY_MAX);
+		for(i = 0; i < found; i++){
+			if ((filtered == 0) || filter_HasGame(state, fuzzy[i])){
+				state->selected_list[n] = fuzzy[i];
+				n++;
 			}
 		}
-	}
-	
-	i = 0;
-	continue_search = 1;
-	while(gamedata != NULL){
-		
 		if (FILTER_VERBOSE){
-			printf("%s.%d\t Searching for matches in %s\n", __FILE__, __LINE__, gamedata->name);
-		}
-		// Does game have metadata
-		if (gamedata->has_dat){
-			status = getLaunchdata(gamedata, filterdat);
-			// Was metadata loaded
-			if (status == 0){
-				continue_search = 1;
-				// Yes, search for matching filter strings
-				for(f = 0; f <MAXIMUM_FILTER_STRINGS; f++){
-					
-					// This filter is selected
-					if (state->filter_strings_selected[f] == 1){
-
-						// Audio search criteria .........................
-						
-						if (strcmp(state->filter_strings[f], FILTER_STRING_MISC_FPU) == 0){
-							if (filterdat->hardware->fpu != 1){
-								continue_search = 0;
-							}
-						}
-						if (strcmp(state->filter_strings[f], FILTER_STRING_CONTROL_CYBERSTICK) == 0){
-							if (filterdat->hardware->cyberstick != 1){
-								continue_search = 0;
-							}
-						}
-						
-						if (strcmp(state->filter_strings[f], FILTER_STRING_FLOPPY_2HDBOOT) == 0){
-							if (filterdat->hardware->uses_2hdboot != 1){
-								continue_search = 0;
-							}
-						}
-						if (strcmp(state->filter_strings[f], FILTER_STRING_FLOPPY_2HDSIM) == 0){
-							if (filterdat->hardware->uses_2hdsim != 1){
-								continue_search = 0;
-							}
-						}
-						
-					}
-					
-					// The search is a composite AND statement,
-					// if any of the results is false, then we
-					// exit out of the search loop for this game.
-					if (continue_search != 1){
-						break;	
-					}
-				}
-			}
-			
-			// If continue_search was still set, then this search must
-			// have satisfied all critera. Therefore add it to the found list.
-			if (continue_search == 1){
-				if (FILTER_VERBOSE){
-					printf("%s.%d\t - All criteria matched for %s\n", __FILE__, __LINE__, filterdat->realname);
-				}
-				state->selected_list[i] = gamedata->gameid;
-				i++;	
-			}
+			printf("%s.%d\t Fuzzy search [%s] matched %d names, %d games selected\n", __FILE__, __LINE__, state->search, found, n);
 		}
-		gamedata = gamedata->next;
+		if (n == 0){
+			return 0;
+		}
+		state->search_fuzzy = 1;
 	}
 	
-	gamedata = gamedata_head;	// Restore head
-	state->selected_max = i; 	// Number of items in selection list
+	state->selected_max = n; 	// Number of items in selection list
 	state->selected_page = 1;	// Start on page 1
 	state->selected_line = 0;	// Start on line 0
-	state->total_pages = 0;		
-	state->selected_filter_string = 0;
 	state->selected_gameid = state->selected_list[0]; 	// Initial game is the 0th element of the selection list
-	state->selected_game = getGameid(state->selected_gameid, gamedata);
-	for(i = 0; i <= state->selected_max ; i++){
-		if (i % ui_browser_max_lines == 0){
-			state->total_pages++;
-		}
-	}
-	
-	return FILTER_OK;
-	
+	state->selected_game = getGameid(state->selected_gameid, gametable);
+	filter_SetPages(state);
+	return n;
 }
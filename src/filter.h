@@ -23,25 +23,55 @@
 #include "main.h"
 #define __HAS_MAIN
 #endif
+#include "collate.h"
 
 // Defaults
 #define FILTER_VERBOSE	0		// Enable/disable logging for these functions
 #define	FILTER_OK		0		// Success returncode
 #define FILTER_ERR		-1		// Failure returncode
+#define FILTER_FUZZY_MAX	40		// Most games a fuzzy search selects
+#define FILTER_SORT_NAME	0		// Filter keys are listed alphabetically
+#define FILTER_SORT_COUNT	1		// Filter keys are listed by number of games, most first
 
-// Custom filter strings
-#define FILTER_STRING_CONTROL_CYBERSTICK "Input: Cyberstick"
-#define FILTER_STRING_MISC_FPU	"Misc: FPU"
-#define FILTER_STRING_FLOPPY_2HDBOOT	"Floppy: 2HDBoot"
-#define FILTER_STRING_FLOPPY_2HDSIM	"Floppy: 2HDSim"
+// Custom filter strings; the tech specs names are in the table of hardware keys in meta.c
+#define FILTER_STRING_YEARS	"%d-%d"		// A decade in the year list; a single year is just "%d"
+
+// Filter cache key of a range of years
+#define FILTER_KEY_YEARS(from, to)	(((long)(from) << 16) | ((to) & 0xFFFF))
+
+// A filter key and the number of games it selects, used when sorting the keys
+typedef struct filterkey {
+	char *name;
+	int count;
+	unsigned char key[COLLATE_KEY_SIZE];	// Sort key of name, from collate_Key()
+} filterkey_t;
 
 // Function prototypes
-int filter_GetGenres(state_t *state, gamedata_t *gamedata, launchdat_t *filterdat);
-int filter_GetSeries(state_t *state, gamedata_t *gamedata, launchdat_t *filterdat);
-int filter_GetCompany(state_t *state, gamedata_t *gamedata, launchdat_t *filterdat);
-int filter_GetTechSpecs(state_t *state, gamedata_t *gamedata, launchdat_t *filterdat);
-int filter_None(state_t *state, gamedata_t *gamedata);
-int filter_Genre(state_t *state, gamedata_t *gamedata, launchdat_t *filterdat);
-int filter_Series(state_t *state, gamedata_t *gamedata, launchdat_t *filterdat);
-int filter_Company(state_t *state, gamedata_t *gamedata, launchdat_t *filterdat);
-int filter_TechSpecs(state_t *state, gamedata_t *gamedata, launchdat_t *filterdat);
+int filter_ResetSelection(state_t *state, int games);
+void filter_SetPages(state_t *state);
+void filter_ClearStrings(state_t *state);
+int filter_AddString(state_t *state, char *s, int count);
+int filter_ResetBitsets(state_t *state, gametable_t *gametable);
+unsigned long * filter_NewBitset(state_t *state, gametable_t *gametable, int type, long key);
+int filter_ApplyBitsets(state_t *state, gametable_t *gametable);
+void filter_StateInit(state_t *state);
+void filter_CacheInit(state_t *state);
+void filter_CacheClear(state_t *state);
+int filter_CacheFind(state_t *state, gametable_t *gametable, int type, long key);
+int filter_CacheAdd(state_t *state, gametable_t *gametable, int count);
+int filter_GetGenres(state_t *state, gametable_t *gametable, launchdat_t *filterdat);
+int filter_GetSeries(state_t *state, gametable_t *gametable, launchdat_t *filterdat);
+int filter_GetCompany(state_t *state, gametable_t *gametable, launchdat_t *filterdat);
+int filter_GetTechSpecs(state_t *state, gametable_t *gametable, launchdat_t *filterdat);
+int filter_None(state_t *state, gametable_t *gametable);
+int filter_Genre(state_t *state, gametable_t *gametable, launchdat_t *filterdat);
+int filter_Series(state_t *state, gametable_t *gametable, launchdat_t *filterdat);
+int filter_Company(state_t *state, gametable_t *gametable, launchdat_t *filterdat);
+int filter_TechSpecs(state_t *state, gametable_t *gametable, launchdat_t *filterdat);
+int filter_GetYears(state_t *state, gametable_t *gametable, launchdat_t *filterdat);
+int filter_Year(state_t *state, gametable_t *gametable, launchdat_t *filterdat);
+int filter_HasGame(state_t *state, int gameid);
+int filter_Reapply(state_t *state, gametable_t *gametable);
+int filter_SearchReset(state_t *state, gametable_t *gametable);
+int filter_Search(state_t *state, gametable_t *gametable);
+int filter_SetOrder(state_t *state, gametable_t *gametable, launchdat_t *filterdat, int order);
@@ -27,6 +27,7 @@
 #define __HAS_DATA
 #endif
 #include "fstools.h"
+#include "search.h"
 
 char drvNumToLetter(int drive_number){
 	/* Turn a drive number into a drive letter */
@@ -117,39 +118,75 @@ int isDir(char *path){
 	return dir_type;
 }
 
-int dirHasData(char *path){
+int dirHasData(char *path, unsigned short *size){
 	/* Return 1 if a __launch.dat file is found in a given directory, 0 if missing */
 	
-	char f;
+	// size: if not NULL, set to the size of the file in bytes (0 if missing)
+	
+	// This is a single directory lookup; it doesn't need to open and close
+	// the file, and it gets us the file size for free.
+	
+	int status;
 	int found;
 	char filepath[DIR_BUFFER_SIZE];
+	struct dos_exfilbuf buffer;
 	
 	strcpy(filepath, path);
 	strcat(filepath, "\\");
 	strcat(filepath, GAMEDAT);
 	
-	f = _dos_open(filepath, 0);
-	if (f > -1){
+	// Any normal file; read-only, hidden, system or archive
+	status = _dos_exfiles(&buffer, filepath, 0x27);
+	if (status >= 0){
 		found = 1;
 	} else {
 		found = 0;	
 	}
-	_dos_close(f);
+	if (size != NULL){
+		if ((found == 1) && (buffer.filelen < 0xFFFF)){
+			*size = buffer.filelen;
+		} else {
+			*size = 0;
+		}
+	}
 	return found;
 }
 
-int findDirs(char *path, gamedata_t *gamedata, int startnum, config_t *config, launchdat_t *launchdat){
+unsigned long dirStamp(char *path){
+	/* Return the date and time of a directory as (date << 16) | time, or 0 if it cannot be found */
+	
+	int status;
+	struct dos_exfilbuf buffer;
+	
+	status = _dos_exfiles(&buffer, path, 0x10);
+	if ((status < 0) || ((buffer.atr & 0x10) == 0)){
+		if (FS_VERBOSE){
+			printf("%s.%d\t dirStamp() Unable to read timestamp of %s [status:%d]\n", __FILE__, __LINE__, path, status);
+		}
+		return 0;
+	}
+	return ((unsigned long)buffer.date << 16) | buffer.time;
+}
+
+int findDirs(char *path, gametable_t *gametable, int startnum, config_t *config, launchdat_t *launchdat, pathindex_t *pathindex){
 	/* Open a search path and return a count of any directories found, creating a gamedata object for each one. */
 	
 	// path: Fully qualified path to search, e.g. "A:\Games"
-	// gamedata: An instance of the linked-list of game data
+	// gametable: The game table that a gamedata entry is appended to for each game found
 	// startnum: The starting number to tag each found 'game' with the next auto-incrementing ID
+	// pathindex: Optional index of the games found by a previous scan; any game directory whose
+	//            date and time are unchanged is copied from there instead of being examined again
 	
 	char drive, old_drive;
 	char drive_letter, old_drive_letter;
 	char status;
 	int go;
 	int found;
+	int reused;
+	unsigned long stamp;
+	unsigned short dat_size;
+	gamedata_t *gamedata;
+	gamedata_t *previous;
 	
 	/* store directory names */
 	char old_dir_buffer[DIR_BUFFER_SIZE];
@@ -164,6 +201,7 @@ int findDirs(char *path, gamedata_t *gamedata, int startnum, config_t *config, l
 	/* initialise counters */
 	go = 1;
 	found = 0;
+	reused = 0;
 	
 	/* initialise the directory or search dirname buffer */
 	memset(old_dir_buffer, '\0', sizeof(old_dir_buffer));
@@ -247,37 +285,67 @@ int findDirs(char *path, gamedata_t *gamedata, int startnum, config_t *config, l
 										printf("%s.%d\t Drive: %c\n", __FILE__, __LINE__, drvNumToLetter(buffer.driveno));
 										printf("%s.%d\t Path: %s\n", __FILE__, __LINE__, buffer.path);
 										printf("%s.%d\t Full Path: %s\n", __FILE__, __LINE__, search_dirname);
-										printf("%s.%d\t Has dat: %d\n", __FILE__, __LINE__, dirHasData(search_dirname));
+										printf("%s.%d\t Has dat: %d\n", __FILE__, __LINE__, dirHasData(search_dirname, NULL));
+									}
+									stamp = ((unsigned long)buffer.date << 16) | buffer.time;
+									gamedata = addGamedata(gametable);
+									if ((gamedata == NULL) || (setGamedataPath(gametable, gamedata, search_dirname) != 0)){
+										printf("%s.%d\t findDirs() Unable to allocate memory for game [%s]\n", __FILE__, __LINE__, search_dirname);
+										if (gamedata != NULL){
+											gametable->size--;
+										}
+										go = 0;
+										break;
 									}
 									found++;
-									gamedata = getLastGamedata(gamedata);
-									gamedata->next = (gamedata_t *) calloc(sizeof(gamedata_t), 1);
-									gamedata->next->gameid = startnum;
-									gamedata->next->drive = drvNumToLetter(buffer.driveno);
-									strncpy(gamedata->next->path, search_dirname, MAX_PATH_SIZE);
-									strncpy(gamedata->next->name, buffer.name, MAX_FILENAME_SIZE);
-									gamedata->next->has_dat = dirHasData(search_dirname);
+									gamedata->gameid = startnum;
+									gamedata->drive = drvNumToLetter(buffer.driveno);
+									gamedata->stamp = stamp;
 									
-									// If pre-loading names from launchdat
-									if (gamedata->next->has_dat == 1){
-										if (config->preload_names == 1){
-											if (FS_VERBOSE){
-												printf("%s.%d\t findDirs() Preloading realname\n", __FILE__, __LINE__);
-											}
-											status = getLaunchdata(gamedata->next, launchdat);
-											if (status == 0){
+									// Has this game directory been seen, unchanged, by a previous scan?
+									previous = NULL;
+									if ((pathindex != NULL) && (stamp != 0)){
+										previous = findGamedataPath(pathindex, search_dirname);
+										if ((previous != NULL) && (previous->stamp != stamp)){
+											previous = NULL;
+										}
+									}
+									
+									if (previous != NULL){
+										// Yes, so re-use what we found last time, including any preloaded realname
+										if (FS_VERBOSE){
+											printf("%s.%d\t findDirs() Unchanged since last scan\n", __FILE__, __LINE__);
+										}
+										setGamedataName(gametable, gamedata, previous->name);
+										gamedata->has_dat = previous->has_dat;
+										gamedata->dat_size = previous->dat_size;
+										reused++;
+									} else {
+										// No, new or changed game directory
+										setGamedataName(gametable, gamedata, buffer.name);
+										gamedata->has_dat = dirHasData(search_dirname, &dat_size);
+										gamedata->dat_size = dat_size;
+										
+										// If pre-loading names from launchdat
+										if (gamedata->has_dat == 1){
+											if (config->preload_names == 1){
 												if (FS_VERBOSE){
-													printf("%s.%d\t findDirs() Realname: %s\n", __FILE__, __LINE__, launchdat->realname);
+													printf("%s.%d\t findDirs() Preloading realname\n", __FILE__, __LINE__);
 												}
-												strncpy(gamedata->next->name, launchdat->realname, MAX_NAME_SIZE);
-											} else {
-												if (FS_VERBOSE){
-													printf("%s.%d\t findDirs() Metadata not found!\n", __FILE__, __LINE__);
+												status = getLaunchdataFields(gamedata, launchdat, LAUNCHDAT_NAME);
+												if (status == 0){
+													if (FS_VERBOSE){
+														printf("%s.%d\t findDirs() Realname: %s\n", __FILE__, __LINE__, launchdat->realname);
+													}
+													setGamedataName(gametable, gamedata, launchdat->realname);
+												} else {
+													if (FS_VERBOSE){
+														printf("%s.%d\t findDirs() Metadata not found!\n", __FILE__, __LINE__);
+													}
 												}
 											}
 										}
 									}
-									gamedata->next->next = NULL;
 									startnum++;
 								}
 							} else {
@@ -294,6 +362,10 @@ int findDirs(char *path, gamedata_t *gamedata, int startnum, config_t *config, l
 		printf("%s.%d\t findDirs() Not a directory\n", __FILE__, __LINE__);
 	}
 	
+	if (FS_VERBOSE){
+		printf("%s.%d\t findDirs() Re-used %d unchanged game directories\n", __FILE__, __LINE__, reused);
+	}
+	
 	/* reload current drive and directory */
 	status = _dos_chgdrv(old_drive);
 	if (status < old_drive){
@@ -313,6 +385,61 @@ int findDirs(char *path, gamedata_t *gamedata, int startnum, config_t *config, l
 	return found;
 }
 
+int scanGamedirs(config_t *config, gametable_t *gametable, gametable_t *previous, launchdat_t *launchdat, scan_progress progress, void *user){
+	/* Scan every game search path for game directories, adding them to the game table, then sort and index the table */
+	
+	// previous: if not NULL, any game directory whose date and time are unchanged since it was
+	// added to that table is copied from it, rather than opened and parsed again
+	// progress: if not NULL, called after each search path and before each later stage, with user
+	// Returns the number of games found, or -1 if the game index could not be allocated.
+	
+	int found, found_tmp;
+	int status;
+	gamedir_t *gamedir;
+	pathindex_t pathindex;
+	
+	found = 0;
+	pathindex.games = NULL;
+	pathindex.size = 0;
+	if (previous != NULL){
+		indexGamedataPaths(previous, &pathindex);
+	}
+	gamedir = config->dir;
+	while (gamedir->next != NULL){
+		gamedir = gamedir->next;
+		gamedir->stamp = dirStamp(gamedir->path);
+		found_tmp = findDirs(gamedir->path, gametable, found, config, launchdat, (previous != NULL) ? &pathindex : NULL);
+		found = found + found_tmp;
+		if (progress != NULL){
+			progress(user, SCAN_DIR, gamedir, found_tmp);
+		}
+	}
+	removePathindex(&pathindex);
+	if (found < 1){
+		return found;
+	}
+	
+	if (progress != NULL){
+		progress(user, SCAN_SORT, NULL, found);
+	}
+	sortGamedata(gametable);
+	status = indexGamedata(gametable);
+	if (status < 0){
+		printf("%s.%d\t scanGamedirs() Unable to allocate memory for game index\n", __FILE__, __LINE__);
+		return status;
+	}
+	
+	// Trigrams for fuzzy name search; saved in the catalog along with the games
+	if (progress != NULL){
+		progress(user, SCAN_INDEX, NULL, found);
+	}
+	status = search_BuildTrigrams(&gametable->trigrams, gametable);
+	if ((status != SEARCH_OK) && (config->verbose)){
+		printf("%s.%d\t scanGamedirs() Warning, unable to build trigram index [status:%d]\n", __FILE__, __LINE__, status);
+	}
+	return found;
+}
+
 int zeroRunBat(){
 	// Empty contents of the run.bat file
 	FILE *runbat;
@@ -349,7 +476,7 @@ int writeRunBat(state_t *state, launchdat_t *launchdat){
 		fprintf(runbat, "REM ID: %d\n", state->selected_game->gameid);
 		fprintf(runbat, "REM Name: %s\n", state->selected_game->name);
 		fprintf(runbat, "REM Drive: %c\n", state->selected_game->drive);
-		fprintf(runbat, "REM Path: %s\n", state->selected_game->path);
+		fprintf(runbat, "REM Path: %s%s\n", state->selected_game->prefix, state->selected_game->dir);
 		fprintf(runbat, "REM Start: %s\n", launchdat->start);
 		fprintf(runbat, "REM Alt Start: %s\n", launchdat->alt_start);
 		fputs("\n", runbat);
@@ -359,7 +486,7 @@ int writeRunBat(state_t *state, launchdat_t *launchdat){
 	fprintf(runbat, "%c: \n", state->selected_game->drive);
 
 	// CD to game directory
-	fprintf(runbat, "cd %s \n", state->selected_game->path);
+	fprintf(runbat, "cd %s%s \n", state->selected_game->prefix, state->selected_game->dir);
 	
 	// Call selected start file
 	if (state->selected_start == 0){
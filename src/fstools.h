@@ -30,13 +30,22 @@
 #define MAX_DRIVES		26		// Maximum number of drive letters
 #define DRIVE_LETTERS	{'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M', 'N', 'O', 'P', 'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z' }
 
+// Stages of scanGamedirs(), passed to its progress function
+#define SCAN_DIR		0		// A search path has been scanned
+#define SCAN_SORT		1		// Every search path is scanned; the games are about to be sorted
+#define SCAN_INDEX		2		// The games are sorted; the trigram index is about to be built
+
+typedef void (*scan_progress)(void *user, int stage, gamedir_t *gamedir, int found);
+
 // Fuction prototypes
 int 		dirFromPath(char *path, char *buffer);
-int 		dirHasData(char *path);
+int 		dirHasData(char *path, unsigned short *size);
+unsigned long	dirStamp(char *path);
 char 		drvLetterFromPath(char *path);
 int 		drvLetterToNum(char drive_letter);
 char		drvNumToLetter(int drive_number);
-int 		findDirs(char *path, gamedata_t *gamedata, int startnum, config_t *config, launchdat_t *launchdat);
+int 		findDirs(char *path, gametable_t *gametable, int startnum, config_t *config, launchdat_t *launchdat, pathindex_t *pathindex);
 int 		isDir(char *path);
+int 		scanGamedirs(config_t *config, gametable_t *gametable, gametable_t *previous, launchdat_t *launchdat, scan_progress progress, void *user);
 int 		writeRunBat(state_t *state, launchdat_t *launchdat);
 int 		zeroRunBat();
\ No newline at end of file
@@ -83,6 +83,106 @@ static char* strncpy0(char* dest, const char* src, size_t size)
     return dest;
 }
 
+#if INI_HANDLER_LINENO
+#define HANDLER(u, s, n, v) handler(u, s, n, v, lineno)
+#else
+#define HANDLER(u, s, n, v) handler(u, s, n, v)
+#endif
+
+/* Call the handler, noting the first line with an error, or that the
+   handler has asked for parsing to stop */
+#define CALL_HANDLER(s, n, v) \
+    do { \
+        status = HANDLER(user, s, n, v); \
+        if (status == INI_STOP) \
+            *stop = 1; \
+        else if (!status && !error) \
+            error = lineno; \
+    } while (0)
+
+/* Parse a single line, which is modified in place. section and prev_name
+   carry state from one line to the next. Returns the updated error, which
+   is the line number of the first error, or 0. Sets *stop if the handler
+   returned INI_STOP. */
+static int ini_parse_line(char* line, int lineno, char* section,
+                          char* prev_name, ini_handler handler, void* user,
+                          int error, int* stop)
+{
+    char* start;
+    char* end;
+    char* name;
+    char* value;
+    int status;
+
+    start = line;
+#if INI_ALLOW_BOM
+    if (lineno == 1 && (unsigned char)start[0] == 0xEF &&
+                       (unsigned char)start[1] == 0xBB &&
+                       (unsigned char)start[2] == 0xBF) {
+        start += 3;
+    }
+#endif
+    start = lskip(rstrip(start));
+
+    if (strchr(INI_START_COMMENT_PREFIXES, *start)) {
+        /* Start-of-line comment */
+    }
+#if INI_ALLOW_MULTILINE
+    else if (*prev_name && *start && start > line) {
+        /* Non-blank line with leading whitespace, treat as continuation
+           of previous name's value (as per Python configparser). */
+        CALL_HANDLER(section, prev_name, start);
+    }
+#endif
+    else if (*start == '[') {
+        /* A "[section]" line */
+        end = find_chars_or_comment(start + 1, "]");
+        if (*end == ']') {
+            *end = '\0';
+            strncpy0(section, start + 1, MAX_SECTION);
+            *prev_name = '\0';
+#if INI_CALL_HANDLER_ON_NEW_SECTION
+            CALL_HANDLER(section, NULL, NULL);
+#endif
+        }
+        else if (!error) {
+            /* No ']' found on section line */
+            error = lineno;
+        }
+    }
+    else if (*start) {
+        /* Not a comment, must be a name[=:]value pair */
+        end = find_chars_or_comment(start, "=:");
+        if (*end == '=' || *end == ':') {
+            *end = '\0';
+            name = rstrip(start);
+            value = end + 1;
+#if INI_ALLOW_INLINE_COMMENTS
+            end = find_chars_or_comment(value, NULL);
+            if (*end)
+                *end = '\0';
+#endif
+            value = lskip(value);
+            rstrip(value);
+
+            /* Valid name[=:]value pair found, call handler */
+            strncpy0(prev_name, name, MAX_NAME);
+            CALL_HANDLER(section, name, value);
+        }
+        else if (!error) {
+            /* No '=' or ':' found on name[=:]value line */
+#if INI_ALLOW_NO_VALUE
+            *end = '\0';
+            name = rstrip(start);
+            CALL_HANDLER(section, name, NULL);
+#else
+            error = lineno;
+#endif
+        }
+    }
+    return error;
+}
+
 /* See documentation in header file. */
 int ini_parse_stream(ini_reader reader, void* stream, ini_handler handler,
                      void* user)
@@ -102,12 +202,9 @@ int ini_parse_stream(ini_reader reader, void* stream, ini_handler handler,
     char section[MAX_SECTION] = "";
     char prev_name[MAX_NAME] = "";
 
-    char* start;
-    char* end;
-    char* name;
-    char* value;
     int lineno = 0;
     int error = 0;
+    int stop = 0;
 
 #if !INI_USE_STACK
     line = (char*)malloc(INI_INITIAL_ALLOC);
@@ -116,12 +213,6 @@ int ini_parse_stream(ini_reader reader, void* stream, ini_handler handler,
     }
 #endif
 
-#if INI_HANDLER_LINENO
-#define HANDLER(u, s, n, v) handler(u, s, n, v, lineno)
-#else
-#define HANDLER(u, s, n, v) handler(u, s, n, v)
-#endif
-
     /* Scan through stream line by line */
     while (reader(line, (int)max_line, stream) != NULL) {
 #if INI_ALLOW_REALLOC && !INI_USE_STACK
@@ -145,88 +236,69 @@ int ini_parse_stream(ini_reader reader, void* stream, ini_handler handler,
 #endif
 
         lineno++;
+        error = ini_parse_line(line, lineno, section, prev_name, handler,
+                               user, error, &stop);
+        if (stop)
+            break;
 
-        start = line;
-#if INI_ALLOW_BOM
-        if (lineno == 1 && (unsigned char)start[0] == 0xEF &&
-                           (unsigned char)start[1] == 0xBB &&
-                           (unsigned char)start[2] == 0xBF) {
-            start += 3;
-        }
+#if INI_STOP_ON_FIRST_ERROR
+        if (error)
+            break;
 #endif
-        start = lskip(rstrip(start));
+    }
 
-        if (strchr(INI_START_COMMENT_PREFIXES, *start)) {
-            /* Start-of-line comment */
-        }
-#if INI_ALLOW_MULTILINE
-        else if (*prev_name && *start && start > line) {
-            /* Non-blank line with leading whitespace, treat as continuation
-               of previous name's value (as per Python configparser). */
-            if (!HANDLER(user, section, prev_name, start) && !error)
-                error = lineno;
-        }
-#endif
-        else if (*start == '[') {
-            /* A "[section]" line */
-            end = find_chars_or_comment(start + 1, "]");
-            if (*end == ']') {
-                *end = '\0';
-                strncpy0(section, start + 1, sizeof(section));
-                *prev_name = '\0';
-#if INI_CALL_HANDLER_ON_NEW_SECTION
-                if (!HANDLER(user, section, NULL, NULL) && !error)
-                    error = lineno;
-#endif
-            }
-            else if (!error) {
-                /* No ']' found on section line */
-                error = lineno;
-            }
-        }
-        else if (*start) {
-            /* Not a comment, must be a name[=:]value pair */
-            end = find_chars_or_comment(start, "=:");
-            if (*end == '=' || *end == ':') {
-                *end = '\0';
-                name = rstrip(start);
-                value = end + 1;
-#if INI_ALLOW_INLINE_COMMENTS
-                end = find_chars_or_comment(value, NULL);
-                if (*end)
-                    *end = '\0';
+#if !INI_USE_STACK
+    free(line);
 #endif
-                value = lskip(value);
-                rstrip(value);
 
-                /* Valid name[=:]value pair found, call handler */
-                strncpy0(prev_name, name, sizeof(prev_name));
-                if (!HANDLER(user, section, name, value) && !error)
-                    error = lineno;
-            }
-            else if (!error) {
-                /* No '=' or ':' found on name[=:]value line */
-#if INI_ALLOW_NO_VALUE
-                *end = '\0';
-                name = rstrip(start);
-                if (!HANDLER(user, section, name, NULL) && !error)
-                    error = lineno;
-#else
-                error = lineno;
-#endif
-            }
+    return error;
+}
+
+/* See documentation in header file. */
+int ini_parse_buffer(char* buffer, size_t length, ini_handler handler,
+                     void* user)
+{
+    char section[MAX_SECTION] = "";
+    char prev_name[MAX_NAME] = "";
+
+    char* line;
+    char* end;
+    char* limit;
+    char saved;
+    int lineno = 0;
+    int error = 0;
+    int stop = 0;
+
+    line = buffer;
+    limit = buffer + length;
+    while (line < limit) {
+        /* Break lines exactly where fgets() into an INI_MAX_LINE buffer
+           would, so overlong lines are split the same way as by
+           ini_parse_stream(). */
+        end = line;
+        while (end < limit && end - line < INI_MAX_LINE - 1) {
+            if (*end++ == '\n')
+                break;
         }
 
+        /* Terminate the line in place, keeping the first character of the
+           next line to put back afterwards */
+        saved = *end;
+        *end = '\0';
+        lineno++;
+        error = ini_parse_line(line, lineno, section, prev_name, handler,
+                               user, error, &stop);
+        *end = saved;
+        if (stop)
+            break;
+
 #if INI_STOP_ON_FIRST_ERROR
         if (error)
             break;
 #endif
+        line = end;
     }
 
-#if !INI_USE_STACK
-    free(line);
-#endif
-
     return error;
 }
 
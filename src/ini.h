@@ -36,6 +36,10 @@ typedef int (*ini_handler)(void* user, const char* section,
                            const char* name, const char* value);
 #endif
 
+/* Handler return value to stop parsing early, without it counting as an
+   error; e.g. once every value the caller wants has been seen. */
+#define INI_STOP -1
+
 /* Typedef for prototype of fgets-style reader function. */
 typedef char* (*ini_reader)(char* str, int num, void* stream);
 
@@ -46,7 +50,8 @@ typedef char* (*ini_reader)(char* str, int num, void* stream);
 
    For each name=value pair parsed, call handler function with given user
    pointer as well as section, name, and value (data only valid for duration
-   of handler call). Handler should return nonzero on success, zero on error.
+   of handler call). Handler should return nonzero on success, zero on error,
+   or INI_STOP to end parsing there.
 
    Returns 0 on success, line number of first error on parse error (doesn't
    stop on first error), -1 on file open error, or -2 on memory allocation
@@ -69,6 +74,14 @@ instead of a file. Useful for parsing INI data from a network socket or
 already in memory. */
 int ini_parse_string(const char* string, ini_handler handler, void* user);
 
+/* Same as ini_parse_string(), but parses length bytes of buffer in place,
+   without copying each line. The buffer is modified, and there must be room
+   for one more byte at buffer[length]. Section, name and value passed to the
+   handler point into the buffer. Gives the same results as ini_parse_stream()
+   with fgets(), including how lines longer than INI_MAX_LINE are split. */
+int ini_parse_buffer(char* buffer, size_t length, ini_handler handler,
+                     void* user);
+
 /* Nonzero to allow multi-line value parsing, in the style of Python's
    configparser. If allowed, ini_parse() will call the handler with the same
    name for each subsequent line parsed. */
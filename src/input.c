@@ -21,6 +21,19 @@
 
 #include "input.h"
 
+// ASCII character for each key code of the main keyboard, 0x00 to 0x35; 0 is a key
+// that cannot be typed into a search. Letters are lower case.
+static const char input_keymap[0x36] = {
+	0, input_key_escape, '1', '2', '3', '4', '5', '6',
+	'7', '8', '9', '0', '-', 0, 0, input_key_backspace,
+	0, 'q', 'w', 'e', 'r', 't', 'y', 'u',
+	'i', 'o', 'p', 0, 0, input_key_enter, 'a', 's',
+	'd', 'f', 'g', 'h', 'j', 'k', 'l', 0,
+	0, 0, 'z', 'x', 'c', 'v', 'b', 'n',
+	'm', ',', '.', 0, 0, ' '
+};
+static char input_lastkey = 0;
+
 int input_get(){
 	// Read joystick or keyboard input and return directions or buttons pressed
 	
@@ -41,7 +54,7 @@ int input_get(){
 	if (k & 0x01) return input_scroll_down;
 	if (k & 0x02) return input_scroll_up;
 	
-	// Tab/switch/quit keys
+	// Tab/switch/quit/rescan keys
 	k = _iocs_bitsns(input_group_switch);
 	if (INPUT_VERBOSE){
 		if (k != 0){
@@ -50,6 +63,7 @@ int input_get(){
 	}
 	if (k & 0x01) return input_switch;
 	if (k & 0x02) return input_quit;
+	if (k & 0x10) return input_rescan;
 	
 	// Enter keys
 	k = _iocs_bitsns(input_group_select_enter);
@@ -88,6 +102,16 @@ int input_get(){
 	if (k & 0x08) return input_help;
 	if (k & 0x02) return input_filter;
 	
+	// (S)earch and s(O)rt keys
+	k = _iocs_bitsns(input_group_search);
+	if (INPUT_VERBOSE){
+		if (k != 0){
+			printf("%s.%d\t input_get() Search Key code: (0x%x)\n", __FILE__, __LINE__, k);
+		}
+	}
+	if (k & 0x80) return input_search;
+	if (k & 0x02) return input_sort;
+	
 	// Read joystick
 	j = _iocs_joyget(0);
 	if (INPUT_VERBOSE){
@@ -104,4 +128,59 @@ int input_get(){
 	
 	// No input
 	return input_none;
-}
\ No newline at end of file
+}
+static char input_scankey(){
+	// Return the character of the first typeable key held down, or 0 if there is none
+	
+	int group;
+	int bit;
+	int code;
+	unsigned char k;
+	
+	for(group = 0; group <= (0x35 >> 3); group++){
+		k = _iocs_bitsns(group);
+		if (k != 0){
+			for(bit = 0; bit < 8; bit++){
+				code = (group << 3) + bit;
+				if ((k & (1 << bit)) && (code < 0x36) && (input_keymap[code] != 0)){
+					return input_keymap[code];
+				}
+			}
+		}
+	}
+	
+	// Numeric keypad enter
+	k = _iocs_bitsns(input_group_select_enter);
+	if (k & 0x40) return input_key_enter;
+	return 0;
+}
+
+int input_getkey(){
+	// Return the character of a key as it is pressed, for typing text, or 0
+	
+	// Unlike input_get(), a key only counts once until it is released, so
+	// holding a key down does not repeat it.
+	
+	char c;
+	
+	c = input_scankey();
+	if (c == input_lastkey){
+		return 0;
+	}
+	input_lastkey = c;
+	if (INPUT_VERBOSE){
+		if (c != 0){
+			printf("%s.%d\t input_getkey() Key: (0x%x)\n", __FILE__, __LINE__, c);
+		}
+	}
+	return c;
+}
+
+void input_release(){
+	// Wait until every typeable key has been released
+	
+	// Stops the key that ends typing (e.g. Enter) from also being seen by input_get()
+	while (input_scankey() != 0){
+	}
+	input_lastkey = 0;
+}
@@ -24,6 +24,7 @@
 #define input_group_cancel				0x00
 #define input_group_switch				0x02
 #define input_group_misc					0x04
+#define input_group_search				0x03
 
 // Input codes as returned to main()
 #define input_none						0x00
@@ -46,6 +47,16 @@
 #define input_joy_right					0x11
 #define input_joy_select					0x12
 #define input_joy_cancel					0x13
+#define input_rescan						0x14
+#define input_search						0x15
+#define input_sort						0x16
+
+// Characters returned by input_getkey() for keys that are not printable
+#define input_key_backspace				0x08
+#define input_key_enter					0x0D
+#define input_key_escape					0x1B
 
 // Function prototypes
-int	input_get();
\ No newline at end of file
+int	input_get();
+int	input_getkey();
+void	input_release();
\ No newline at end of file
@@ -43,15 +43,22 @@
 #define __HAS_MAIN
 #endif
 
+#include "catalog.h"
+#include "cache.h"
+#include "prefetch.h"
+#include "meta.h"
 #include "fstools.h"
 #include "input.h"
 #include "rgb.h"
 #include "textgfx.h"
 #include "filter.h"
+#include "search.h"
+#include "sort.h"
 #include "ui.h"
 #include "timers.h"
 
 FILE *screenshot_file;
+launchcache_t launchcache;					// Parsed metadata files of recently selected (or prefetched) games
 
 int selectScreenshot(config_t *config, state_t *state, imagefile_t *imagefile, bmpdata_t *screenshot_bmp, bmpstate_t *screenshot_bmp_state){
 	// Select the next artwork and set up state variables ready to show it
@@ -66,7 +73,7 @@ int selectScreenshot(config_t *config, state_t *state, imagefile_t *imagefile, b
 	if (config->verbose){
 		printf("%s.%d\t selectScreenshot() Selected artwork filename [%s]\n", __FILE__, __LINE__, imagefile->filename[imagefile->selected]);
 	}
-	sprintf(msg, "%s\\%s", state->selected_game->path, imagefile->filename[imagefile->selected]);
+	sprintf(msg, "%s%s\\%s", state->selected_game->prefix, state->selected_game->dir, imagefile->filename[imagefile->selected]);
 	strncpy(state->selected_image, msg, 65);
 
 	// Close the file handle if opened previously
@@ -125,6 +132,200 @@ int selectScreenshot(config_t *config, state_t *state, imagefile_t *imagefile, b
 	return has_screenshot;	
 }
 
+static int prefetchPending(){
+	// Returns true if the user is pressing anything, so that prefetching can stop
+	
+	return (input_get() != input_none);
+}
+
+static int prefetchGame(void *user, int gameid, int step){
+	// Read ahead one step of a game that may be selected next; called by prefetch_Run()
+	
+	// PREFETCH_STEP_META parses the launch.dat into the metadata cache, and
+	// PREFETCH_STEP_ART opens the first artwork and reads its header, so that
+	// Human68k already has the directory entry and first sector buffered.
+	
+	static hwdata_t hardware;
+	static launchdat_t launchdat;
+	static imagefile_t images;
+	
+	gametable_t *gametable;
+	gamedata_t *gamedata;
+	launchdat_t *cached;
+	char path[MAX_PATH_SIZE + MAX_FILENAME_SIZE];
+	char header[PALETTE_OFFSET];
+	int f;
+	
+	gametable = (gametable_t *) user;
+	launchdat.hardware = &hardware;
+	gamedata = getGameid(gameid, gametable);
+	if ((gamedata == NULL) || (gamedata->has_dat != 1)){
+		return PREFETCH_SKIP;
+	}
+	
+	if (step == PREFETCH_STEP_META){
+		if (cache_Find(&launchcache, gameid) != NULL){
+			return PREFETCH_OK;
+		}
+		if (cache_Get(&launchcache, gamedata, &launchdat) != 0){
+			return PREFETCH_SKIP;
+		}
+		meta_Update(&gametable->meta, gameid, &launchdat);
+		return PREFETCH_OK;
+	}
+	
+	cached = cache_Find(&launchcache, gameid);
+	if ((cached == NULL) || (getImageList(cached, &images) < 1)){
+		return PREFETCH_SKIP;
+	}
+	getGamedataPath(gamedata, path);
+	strcat(path, "\\");
+	strncat(path, images.filename[images.first], MAX_FILENAME_SIZE);
+	f = _dos_open(path, 0);
+	if (f < 0){
+		return PREFETCH_SKIP;
+	}
+	_dos_read(f, header, PALETTE_OFFSET);
+	_dos_close(f);
+	return PREFETCH_OK;
+}
+
+static void prefetchSelection(prefetch_t *prefetch, state_t *state){
+	// Queue up the games around the cursor, e.g. after the selection list has been rebuilt
+	
+	prefetch_Plan(prefetch, state->selected_list, state->selected_max, ((state->selected_page - 1) * ui_browser_max_lines) + state->selected_line, ui_browser_max_lines);
+}
+
+// How far a scrape has got, as shown by scrapeProgress()
+typedef struct scrape {
+	config_t *config;
+	unsigned char *progress;				// Splash screen progress bar, or NULL for the status bar
+	unsigned char chunk_size;				// Size of progress bar increase per directory being scraped
+	int stage;								// SCAN_ stage being timed
+	long int start_time;					// When that stage started
+} scrape_t;
+
+static char *scrape_timers[] = { "Game Scraping", "Game Sorting", "Trigram Index" };	// Timer of each SCAN_ stage
+
+static void scrapeProgress(void *user, int stage, gamedir_t *gamedir, int found){
+	// Show how far scanGamedirs() has got, timing each of its stages; called by scanGamedirs()
+	
+	scrape_t *scrape;
+	char msg[64];							// Message buffer
+	long int end_time;						// Performance counter
+	
+	scrape = (scrape_t *) user;
+	if (stage == SCAN_DIR){
+		// ======================
+		//
+		// Show graphical progress update for this directory scraping
+		//
+		// ======================
+		sprintf(msg, "Found %d games in %s", found, gamedir->path);
+		if (scrape->config->verbose){
+			printf("%s.%d\t Found %d games in %s\n", __FILE__, __LINE__, found, gamedir->path);
+		}
+		if (scrape->progress != NULL){
+			ui_ProgressMessage(msg);
+			*scrape->progress += scrape->chunk_size;
+			ui_DrawSplashProgress(0, *scrape->progress);
+		} else {
+			ui_StatusMessage(msg);
+		}
+		gfx_Flip();
+		return;
+	}
+	
+	end_time = xclock();
+	timers_Print(scrape->start_time, end_time, scrape_timers[scrape->stage], scrape->config->timers);
+	scrape->stage = stage;
+	if (stage == SCAN_SORT){
+		if (scrape->config->verbose){
+			printf("%s.%d\t Scraped!\n", __FILE__, __LINE__);
+		}
+		
+		// =========================
+		//
+		// Sort the game entries by name
+		//
+		// =========================
+		sprintf(msg, "Sorting %d games...", found);
+		if (scrape->progress != NULL){
+			ui_ProgressMessage(msg);
+		} else {
+			ui_StatusMessage(msg);
+		}
+		gfx_Flip();
+	}
+	scrape->start_time = xclock();
+}
+
+int scrapeGames(config_t *config, gametable_t *gametable, gametable_t *previous, launchdat_t *launchdat, unsigned char *progress){
+	// Scrape every game search path for game directories, adding them to the game table,
+	// and then sort the table by name. Returns the number of games found.
+	// If previous is set then any game directory whose date and time are unchanged since it was
+	// added to that table is copied from it, rather than opened and parsed again.
+	// If progress is set then the splash screen progress bar is updated as we go, otherwise
+	// only the status bar of the main window is updated.
+	
+	char msg[64];							// Message buffer
+	int found;								// Number of games found
+	unsigned char scrape_dirs;				// Number of directories being scraped
+	gamedir_t *gamedir = NULL;				// Current game search path
+	scrape_t scrape;						// Progress shown by scrapeProgress()
+	
+	scrape_dirs = 0;
+	if (config->verbose){
+		printf("%s.%d\t Adding search paths...\n", __FILE__, __LINE__);
+	}
+	gamedir = config->dir;
+	while (gamedir->next != NULL){
+		gamedir = gamedir->next;
+		scrape_dirs++;
+	}
+	if (progress != NULL){
+		ui_ProgressMessage("Adding search paths...");
+		*progress += splash_progress_chunk_size;
+		ui_DrawSplashProgress(0, *progress);
+	}
+	
+	// Calculate progress size for each dir scraped
+	if (config->verbose){
+		printf("%s.%d\t Scraping %d directories for content...\n", __FILE__, __LINE__, scrape_dirs);
+	}
+	scrape.config = config;
+	scrape.progress = progress;
+	scrape.chunk_size = splash_progress_chunk_size / scrape_dirs;
+	scrape.stage = SCAN_DIR;
+	sprintf(msg, "Scraping %d directories for content...", scrape_dirs);
+	if (progress != NULL){
+		ui_ProgressMessage(msg);
+	} else {
+		ui_StatusMessage(msg);
+	}
+	gfx_Flip();
+	
+	scrape.start_time = xclock();
+	found = scanGamedirs(config, gametable, previous, launchdat, scrapeProgress, &scrape);
+	timers_Print(scrape.start_time, xclock(), scrape_timers[scrape.stage], config->timers);
+	if (found < 1){
+		if ((scrape.stage == SCAN_DIR) && (config->verbose)){
+			printf("%s.%d\t Scraped!\n", __FILE__, __LINE__);
+		}
+		return found;
+	}
+	if (progress != NULL){
+		*progress += splash_progress_chunk_size;
+		ui_DrawSplashProgress(0, *progress);
+		ui_ProgressMessage("Sorted!");
+	}
+	if (config->verbose){
+		printf("%s.%d\t Sorted!\n", __FILE__, __LINE__);
+	}
+	gfx_Flip();
+	return found;
+}
+
 int main() {
 	/* Lets get this show on the road!!! */
 	
@@ -139,12 +340,12 @@ int main() {
 	unsigned char active_pane;				// Indicator of which UI element is active and consuming input
 	unsigned char exit;						// Status flag indicating user wants to quit
 	unsigned char  user_input, joy_input, key_input;	// User input state - either a keyboard code or joystick direction/button
-	unsigned char scrape_dirs;				// NUmber of directories being scraped
-	unsigned char scrape_progress_chunk_size;	// Size of progress bar increase per directory being scraped
+	char c;									// Character typed into the type-ahead search
 	unsigned char progress;					// Progress bar percentage
 	int found, found_tmp;					// Number of gamedirs/games found
 	unsigned char  verbose;					// Controls output of additional logging/text
 	int status;								// Generic function return status variable
+	int changed = 0;						// Number of search paths changed since the catalog was saved
 	char msg[64];							// Message buffer
 	
 	long int start_time, end_time, end_time2;// Performance counters, set 1
@@ -158,10 +359,12 @@ int main() {
 	bmpdata_t *screenshot_bmp = NULL;		// Reads artwork header
 	bmpstate_t *screenshot_bmp_state = NULL;	// State buffer for reading artwork line-by-line
 	bmpdata_t *game_bmp = NULL;				// Loads a cover/screenshot for a game 
-	gamedata_t *gamedata = NULL;				// An initial gamedata record for the first game directory we read
-	gamedata_t *gamedata_head = NULL;		// Constant pointer to the start of the gamedata list
+	gametable_t gametable;					// Table of every game found
+	gametable_t gametable_rescan;			// New table of games when rescanning
+	gamedata_t *gamedata = NULL;				// Current entry of the game table
 	launchdat_t *launchdat = NULL;			// When a single game is selected, we attempt to load its metadata file from disk
 	launchdat_t *filterdat = NULL;			// Used when loading metadata files to filter games
+	prefetch_t prefetch;					// Games around the cursor to read ahead while waiting for input
 	imagefile_t *imagefile = NULL;			// When a single game is selected, we attempt to load a list of the screenshots from metadata
 	imagefile_t *imagefile_head = NULL;		// Constant pointer to the start of the game screenshot list
 	gamedir_t *gamedir = NULL;				// List of the game search directories, as defined in our INIFILE
@@ -173,7 +376,6 @@ int main() {
 	active_pane = BROWSER_PANE;				// Set initial focus to browser pane
 	user_input = joy_input = key_input = 0;	// Initial state of all input variables
 	exit = 0;								// Dont exit from main loop unless specified
-	scrape_dirs = 0;							// Default to 0 directories found
 	progress = 0;							// Default to 0 progress bar size
 	found = found_tmp = 0;					// Counter of the number of found directories/gamedata items
 	verbose = 1;								// Initial debug/verbose setting; overidden from INIFILE, if set
@@ -183,10 +385,10 @@ int main() {
 	printf("%s starting...\n", MY_NAME);
 	
 	/* ************************************** */
-	/* Create a new empty gamedata entry */
+	/* Create a new empty game table */
 	/* ************************************** */
-	gamedata = (gamedata_t *) malloc(sizeof(gamedata_t));
-	gamedata->next = NULL;
+	initGametable(&gametable);
+	initGametable(&gametable_rescan);
 	
 	/* ************************************** */
 	/* Parse the gamedirs that are set */
@@ -220,17 +422,7 @@ int main() {
 	/* ************************************** */
 	state = (state_t *) malloc(sizeof(state_t));
 	old_gameid = -1;
-	state->selected_max = 0;			// Total amount of items in current filtered selection
-	state->selected_page = 1;			// Default to first page of selected games 
-	state->selected_line = 0;			// Default to first line selected
-	state->total_pages = 0;				// Total number of pages of selected games (selected_max / ui_browser_max_lines)
-	state->selected_gameid = -1;		// Current selected game
-	state->has_images = 0;
-	state->has_launchdat = 0;
-	state->active_pane = BROWSER_PANE;
-	for(i =0; i <SELECTION_LIST_SIZE; i++){
-		state->selected_list[i] = -1;
-	}
+	filter_StateInit(state);
 	
 	/* ************************************** */
 	/* Parse our ini file */
@@ -252,7 +444,7 @@ int main() {
 		printf("Where ABC123 should be replaced by a comma seperate list of one or more paths to your games (e.g. A:\\Games)\n");
 		free(config);
 		free(gamedir);
-		free(gamedata);
+		removeGamedata(&gametable);
 		return 1;
 	} else {
 		printf("\n");
@@ -264,8 +456,17 @@ int main() {
 		printf("save=%d\n", config->save);
 		printf("keyboard_test=%d\n", config->keyboard_test);
 		printf("preload_names=%d\n", config->preload_names);
+		printf("sort_filters=%d\n", config->sort_filters);
 		printf("timers=%d\n", config->timers);
+		printf("rescan=%d\n", config->rescan);
+		printf("metadata_cache=%d\n", config->metadata_cache);
+		printf("prefetch=%d\n", config->prefetch);
 		printf("\n");
+		if (config->sort_filters == 1){
+			state->filter_sort = FILTER_SORT_COUNT;
+		} else {
+			state->filter_sort = FILTER_SORT_NAME;
+		}
 		if (config->verbose == 0){
 			printf("Verbose mode is disabled, you will not receive any further logging after this point\n");
 			printf("If required, enable verbose mode by adding: verbose=1 to %s\n", INIFILE);
@@ -281,6 +482,22 @@ int main() {
 		return 0;
 	}
 	
+	// ======================
+	// Metadata cache
+	// ======================
+	status = cache_Init(&launchcache, config->metadata_cache);
+	if (config->verbose){
+		printf("%s.%d\t Metadata cache of %d entries [status:%d]\n", __FILE__, __LINE__, launchcache.size, status);
+	}
+	
+	// Prefetching only fills the metadata cache, so it needs one
+	if ((launchcache.size > 0) && (config->prefetch > 0)){
+		i = TIMERS_TICKS_MS(config->prefetch);
+		prefetch_Init(&prefetch, (i > 0) ? i : 1, timers_Ticks, prefetchPending, prefetchGame, &gametable);
+	} else {
+		prefetch_Init(&prefetch, 0, timers_Ticks, prefetchPending, prefetchGame, &gametable);
+	}
+	
 	// ======================
 	// Initialise GUI 
 	// ======================
@@ -292,7 +509,7 @@ int main() {
 		printf("ERROR! Unable to initialise graphics mode!\n");
 		free(config);
 		free(gamedir);
-		free(gamedata);
+		removeGamedata(&gametable);
 		return status;	
 	}
 	ui_Init();
@@ -371,7 +588,7 @@ int main() {
 			printf("\n");
 			free(config);
 			free(gamedir);
-			free(gamedata);
+			removeGamedata(&gametable);
 			ui_Close();
 			gfx_Close();
 			return -1;
@@ -390,7 +607,7 @@ int main() {
 		
 		free(config);
 		free(gamedir);
-		free(gamedata);
+		removeGamedata(&gametable);
 		ui_Close();
 		gfx_Close();
 		return -1;
@@ -405,56 +622,71 @@ int main() {
 	
 	// ======================
 	//
-	// This section here loops through our game search paths and finds
-	// and subdirectories (that should contain games). 
+	// Load the list of games from the catalog written by a previous run, if
+	// it is still valid for the current search paths. This is a single sequential
+	// read, rather than opening every game directory on every search path.
 	//
 	// ======================
-	if (config->verbose){
-		printf("%s.%d\t Adding search paths...\n", __FILE__, __LINE__);
-	}
-	ui_ProgressMessage("Adding search paths...");
-	gamedir = config->dir;
-	while (gamedir->next != NULL){
-		gamedir = gamedir->next;
-		scrape_dirs++;
-	}
-	progress += splash_progress_chunk_size;
-	ui_DrawSplashProgress(0, progress);
-	
-	// Calculate progress size for each dir scraped
-	if (config->verbose){
-		printf("%s.%d\t Scraping %d directories for content...\n", __FILE__, __LINE__, scrape_dirs);
+	found = 0;
+	if (config->rescan == 0){
+		ui_ProgressMessage("Loading game catalog...");
+		gfx_Flip();
+		start_time = xclock();
+		found = catalog_Load(config, &gametable, &changed);
+		end_time = xclock();
+		timers_Print(start_time, end_time, "Catalog Loading", config->timers);
+		if ((found > 0) && (changed > 0)){
+			// Some search paths have changed; rescan them, but reuse every
+			// game directory that is unchanged from the catalog
+			if (config->verbose){
+				printf("%s.%d\t %d search paths changed since the catalog was saved\n", __FILE__, __LINE__, changed);
+			}
+			found = scrapeGames(config, &gametable_rescan, &gametable, launchdat, &progress);
+			removeGamedata(&gametable);
+			gametable = gametable_rescan;
+			initGametable(&gametable_rescan);
+			if (found > 0){
+				status = catalog_Save(config, &gametable);
+				if (config->verbose){
+					printf("%s.%d\t Saved game catalog to %s [status:%d]\n", __FILE__, __LINE__, CATALOGFILE, status);
+				}
+			} else {
+				// Throw away anything from a partial rescan, so the full scrape below starts empty
+				removeGamedata(&gametable);
+			}
+		} else if (found > 0){
+			if (config->verbose){
+				printf("%s.%d\t Loaded %d games from %s\n", __FILE__, __LINE__, found, CATALOGFILE);
+			}
+			sprintf(msg, "Loaded %d games from catalog", found);
+			ui_ProgressMessage(msg);
+			progress += (splash_progress_chunk_size * 3);
+			ui_DrawSplashProgress(0, progress);
+			gfx_Flip();
+		} else {
+			if (config->verbose){
+				printf("%s.%d\t Catalog not loaded [status:%d], scraping game directories\n", __FILE__, __LINE__, found);
+			}
+			// Throw away anything from a partially loaded catalog
+			removeGamedata(&gametable);
+			found = 0;
+		}
 	}
-	scrape_progress_chunk_size = splash_progress_chunk_size / scrape_dirs;
-	sprintf(msg, "Scraping %d directories for content...", scrape_dirs);
-	ui_ProgressMessage(msg);
-	gfx_Flip();
 	
-	gamedir = config->dir;
-	start_time = xclock();
-	while (gamedir->next != NULL){
-		gamedir = gamedir->next;
-		// ======================
-		//
-		// Show graphical progress update for this directory scraping
-		//
-		// ======================		
-		found_tmp = 0;
-		found_tmp = findDirs(gamedir->path, gamedata, found, config, launchdat);
-		found = found + found_tmp;
-		sprintf(msg, "Found %d games in %s", found_tmp, gamedir->path);
-		if (config->verbose){
-			printf("%s.%d\t Found %d games in %s\n", __FILE__, __LINE__, found_tmp, gamedir->path);
+	// ======================
+	//
+	// This section here loops through our game search paths and finds
+	// and subdirectories (that should contain games). 
+	//
+	// ======================
+	if (found < 1){
+		found = scrapeGames(config, &gametable, NULL, launchdat, &progress);
+		if (found > 0){
+			status = catalog_Save(config, &gametable);
+			if (config->verbose){
+				printf("%s.%d\t Saved game catalog to %s [status:%d]\n", __FILE__, __LINE__, CATALOGFILE, status);
+			}
 		}
-		ui_ProgressMessage(msg);
-		progress += scrape_progress_chunk_size;
-		ui_DrawSplashProgress(0, progress);
-		gfx_Flip();	
-	}	
-	end_time = xclock();
-	timers_Print(start_time, end_time, "Game Scraping", config->timers);
-	if (config->verbose){
-		printf("%s.%d\t Scraped!\n", __FILE__, __LINE__);
 	}
 	ui_ProgressMessage("Scraped!");
 	gfx_Flip();
@@ -467,7 +699,7 @@ int main() {
 	if (found < 1){
 		free(config);
 		free(gamedir);
-		free(gamedata);
+		removeGamedata(&gametable);
 		ui_ProgressMessage("ERROR! No game folders found!!!");
 		printf("%s.%d\t Error no game folders found while scraping your directories!!!\n", __FILE__, __LINE__);
 		printf("\n");
@@ -488,26 +720,6 @@ int main() {
 		}
 	}
 	
-	// =========================
-	//
-	// Sort the game entries by name
-	//
-	// =========================
-	sprintf(msg, "Sorting %d games...", found);
-	ui_ProgressMessage(msg);
-	gfx_Flip();
-	start_time = xclock();
-	sortGamedata(gamedata);
-	end_time = xclock();
-	timers_Print(start_time, end_time, "Game Sorting", config->timers);
-	progress += splash_progress_chunk_size;
-	ui_DrawSplashProgress(0, progress);
-	ui_ProgressMessage("Sorted!");
-	if (config->verbose){
-		printf("%s.%d\t Sorted!\n", __FILE__, __LINE__);
-	}
-	gfx_Flip();
-	
 	// ======================
 	// 
 	// Do an initial selection list of all titles
@@ -519,10 +731,8 @@ int main() {
 	ui_ProgressMessage("Building initial selection list...");
 	gfx_Flip();
 	
-	if (gamedata->next != NULL){
-		gamedata = gamedata->next;
-	}
 	// Load metadata and artwork list for the first game
+	gamedata = &gametable.games[0];
 	state->selected_game = gamedata;
 	state->selected_gameid = gamedata->gameid;
 	state->has_launchdat = gamedata->has_dat;
@@ -532,9 +742,10 @@ int main() {
 		if (config->verbose){
 			printf("%s.%d\t Loading metadata for initial selection id [%d]\n", __FILE__, __LINE__, state->selected_gameid);	
 		}
-		status = getLaunchdata(state->selected_game, launchdat);
+		status = cache_Get(&launchcache, state->selected_game, launchdat);
 		if (status != -1){
 			state->has_launchdat = 1;
+			meta_Update(&gametable.meta, state->selected_game->gameid, launchdat);
 			if (config->verbose){
 				printf("%s.%d\t Loading artwork for initial selection id [%d]\n", __FILE__, __LINE__, state->selected_gameid);
 			}
@@ -553,7 +764,8 @@ int main() {
 	gfx_Flip();
 	
 	// Apply no-filtering to list, show all games
-	status = filter_None(state, gamedata);
+	status = filter_None(state, &gametable);
+	prefetchSelection(&prefetch, state);
 	if (config->verbose){
 		printf("%s.%d\t Initial selection state\n", __FILE__, __LINE__);
 		printf("%s.%d\t Info - selected_max: %d\n", __FILE__, __LINE__, state->selected_max);
@@ -564,6 +776,14 @@ int main() {
 		printf("%s.%d\t Info - selected game: %s\n", __FILE__, __LINE__, state->selected_game->name);
 		printf("%s.%d\t Info - has_launchdat: %d\n", __FILE__, __LINE__, state->has_launchdat);
 	}
+	if (config->verbose || config->timers){
+		// Memory budget for the game library
+		printGametableMemory(&gametable);
+		printf("%s.%d\t Memory - selection list: %d entries, %ld bytes\n", __FILE__, __LINE__, state->selected_list_size, (long)(state->selected_list_size * sizeof(int)));
+		printf("%s.%d\t Memory - filter bitsets: %d x %d words, %ld bytes\n", __FILE__, __LINE__, FILTER_MAX + 1, state->filter_bits_words, (long)((FILTER_MAX + 1) * state->filter_bits_words * sizeof(unsigned long)));
+		printf("%s.%d\t Memory - filter strings: %d of %d entries, %ld bytes + %ld bytes of text\n", __FILE__, __LINE__, state->available_filter_strings, state->filter_strings_size, (long)(state->filter_strings_size * (sizeof(char *) + sizeof(int) + sizeof(unsigned char))), state->filter_pool.bytes_allocated);
+		printf("%s.%d\t Memory - UI state: %ld bytes\n", __FILE__, __LINE__, (long)sizeof(state_t));
+	}
 	
 	// ======================
 	//
@@ -587,13 +807,11 @@ int main() {
 			ui_ProgressMessage(msg);
 			_dos_getchar();
 		} else {
-			gamedata_head = gamedata;
-			while(gamedata->next != NULL){
-				_dos_fputs(gamedata->path, savefile);
+			for(i = 0; i < gametable.size; i++){
+				_dos_fputs(gametable.games[i].prefix, savefile);
+				_dos_fputs(gametable.games[i].dir, savefile);
 				_dos_fputs("\n", savefile);
-				gamedata = gamedata->next;
 			}
-			gamedata = gamedata_head;
 			_dos_close(savefile);
 		}
 	} else {
@@ -624,7 +842,7 @@ int main() {
 		printf("ERROR! Unable to load draw main UI window!\n");
 		free(config);
 		free(gamedir);
-		free(gamedata);
+		removeGamedata(&gametable);
 		return status;
 	}
 	status = ui_DrawStatusBar();
@@ -632,7 +850,7 @@ int main() {
 		printf("ERROR! Unable to draw status bar!\n");
 		free(config);
 		free(gamedir);
-		free(gamedata);
+		removeGamedata(&gametable);
 		return status;
 	}
 	status = ui_DrawInfoBox();
@@ -640,23 +858,23 @@ int main() {
 		printf("ERROR! Unable to draw info pane widgets!\n");
 		free(config);
 		free(gamedir);
-		free(gamedata);
+		removeGamedata(&gametable);
 		return status;
 	}
-	status = ui_UpdateBrowserPane(state, gamedata);
+	status = ui_UpdateBrowserPane(state, &gametable);
 	if (status != UI_OK){
 		printf("ERROR! Unable to update browser pane contents!\n");
 		free(config);
 		free(gamedir);
-		free(gamedata);
+		removeGamedata(&gametable);
 		return status;
 	}	
-	status = ui_UpdateInfoPane(state, gamedata, launchdat);
+	status = ui_UpdateInfoPane(state, &gametable, launchdat);
 	if (status != UI_OK){
 		printf("ERROR! Unable to update info pane contents!\n");
 		free(config);
 		free(gamedir);
-		free(gamedata);
+		removeGamedata(&gametable);
 		return status;
 	}
 	end_time = xclock();
@@ -666,14 +884,14 @@ int main() {
 	
 	// Update info with current selection
 	ui_ReselectCurrentGame(state);
-	status = ui_UpdateBrowserPane(state, state->selected_game);
+	status = ui_UpdateBrowserPane(state, &gametable);
 	status = ui_UpdateBrowserPaneStatus(state);
-	status = ui_UpdateInfoPane(state, state->selected_game, launchdat);
+	status = ui_UpdateInfoPane(state, &gametable, launchdat);
 	if (status != UI_OK){
 		printf("ERROR! Unable to update info pane contents!\n");
 		free(config);
 		free(gamedir);
-		free(gamedata);
+		removeGamedata(&gametable);
 		return status;
 	}
 	end_time2 = xclock();
@@ -719,10 +937,10 @@ int main() {
 						printf("%s.%d\t Redrawing main screen for Game ID: %d, %s\n", __FILE__, __LINE__, state->selected_gameid, state->selected_game->name);	
 					}
 					ui_DrawMainWindow();
-					ui_UpdateBrowserPane(state, gamedata);
+					ui_UpdateBrowserPane(state, &gametable);
 					ui_DrawInfoBox();
 					ui_ReselectCurrentGame(state);
-					ui_UpdateInfoPane(state, gamedata, launchdat);
+					ui_UpdateInfoPane(state, &gametable, launchdat);
 					ui_UpdateBrowserPaneStatus(state);
 					//ui_DisplayArtwork(screenshot_file, screenshot_bmp, screenshot_bmp_state, state, imagefile);
 					gfx_Flip();
@@ -733,6 +951,10 @@ int main() {
 						printf("%s.%d\t Writing run.bat\n", __FILE__, __LINE__);	
 					}
 					writeRunBat(state, launchdat);
+					status = sort_AddRecent(state->selected_game);
+					if (config->verbose){
+						printf("%s.%d\t Added to recently played games [status:%d]\n", __FILE__, __LINE__, status);
+					}
 					exit = 1;
 					break;
 				default:
@@ -763,11 +985,11 @@ int main() {
 						printf("%s.%d\t Redrawing main screen for Game ID: %d, %s\n", __FILE__, __LINE__, state->selected_gameid, state->selected_game->name);	
 					}
 					ui_DrawMainWindow();
-					ui_UpdateBrowserPane(state, gamedata);
+					ui_UpdateBrowserPane(state, &gametable);
 					gfx_Flip();
 					ui_DrawInfoBox();
 					ui_ReselectCurrentGame(state);
-					ui_UpdateInfoPane(state, gamedata, launchdat);
+					ui_UpdateInfoPane(state, &gametable, launchdat);
 					ui_UpdateBrowserPaneStatus(state);
 					gfx_Flip();
 					//ui_DisplayArtwork(screenshot_file, screenshot_bmp, screenshot_bmp_state, state, imagefile);
@@ -775,12 +997,12 @@ int main() {
 					break;
 				case(input_up):
 					// FLip between start files
-					ui_DrawLaunchPopup(state, gamedata, launchdat, 1);
+					ui_DrawLaunchPopup(state, &gametable, launchdat, 1);
 					gfx_Flip();
 					break;
 				case(input_down):
 					// FLip between start files
-					ui_DrawLaunchPopup(state, gamedata, launchdat, 1);
+					ui_DrawLaunchPopup(state, &gametable, launchdat, 1);
 					gfx_Flip();
 					break;
 				case(input_select):
@@ -789,7 +1011,7 @@ int main() {
 						printf("%s.%d\t Opening confirmation popup\n", __FILE__, __LINE__);	
 					}
 					active_pane = CONFIRM_PANE;
-					ui_DrawConfirmPopup(state, gamedata, launchdat);
+					ui_DrawConfirmPopup(state, &gametable, launchdat);
 					gfx_Flip();
 					break;
 				default:
@@ -819,11 +1041,11 @@ int main() {
 						printf("%s.%d\t Redrawing main screen for Game ID: %d, %s\n", __FILE__, __LINE__, state->selected_gameid, state->selected_game->name);	
 					}
 					ui_DrawMainWindow();
-					ui_UpdateBrowserPane(state, gamedata);
+					ui_UpdateBrowserPane(state, &gametable);
 					gfx_Flip();
 					ui_DrawInfoBox();
 					ui_ReselectCurrentGame(state);
-					ui_UpdateInfoPane(state, gamedata, launchdat);
+					ui_UpdateInfoPane(state, &gametable, launchdat);
 					ui_UpdateBrowserPaneStatus(state);
 					gfx_Flip();
 					//ui_DisplayArtwork(screenshot_file, screenshot_bmp, screenshot_bmp_state, state, imagefile);
@@ -868,7 +1090,7 @@ int main() {
 					
 					if (state->selected_filter == FILTER_NONE){
 						// Reselect all games
-						status = filter_None(state, gamedata);
+						status = filter_None(state, &gametable);
 						
 						if (config->verbose){
 							printf("%s.%d\t Closing filter popup(s)\n", __FILE__, __LINE__);	
@@ -879,11 +1101,12 @@ int main() {
 							printf("%s.%d\t Redrawing main screen for Game ID: %d, %s\n", __FILE__, __LINE__, state->selected_gameid, state->selected_game->name);	
 						}
 						ui_DrawMainWindow();
-						ui_UpdateBrowserPane(state, gamedata);
+						ui_UpdateBrowserPane(state, &gametable);
 						gfx_Flip();
 						ui_DrawInfoBox();
 						ui_ReselectCurrentGame(state);
-						ui_UpdateInfoPane(state, gamedata, launchdat);
+						prefetchSelection(&prefetch, state);
+						ui_UpdateInfoPane(state, &gametable, launchdat);
 						ui_UpdateBrowserPaneStatus(state);
 						gfx_Flip();
 						//ui_DisplayArtwork(screenshot_file, screenshot_bmp, screenshot_bmp_state, state, imagefile);
@@ -899,19 +1122,23 @@ int main() {
 						
 						// Generate the list of keywords
 						if (state->selected_filter == FILTER_GENRE){
-							filter_GetGenres(state, gamedata, filterdat);
+							filter_GetGenres(state, &gametable, filterdat);
 						}
 						
 						if (state->selected_filter == FILTER_SERIES){
-							filter_GetSeries(state, gamedata, filterdat);
+							filter_GetSeries(state, &gametable, filterdat);
 						}
 						
 						if (state->selected_filter == FILTER_COMPANY){
-							filter_GetCompany(state, gamedata, filterdat);
+							filter_GetCompany(state, &gametable, filterdat);
 						}
 						
 						if (state->selected_filter == FILTER_TECH){
-							filter_GetTechSpecs(state, gamedata, filterdat);
+							filter_GetTechSpecs(state, &gametable, filterdat);
+						}
+						
+						if (state->selected_filter == FILTER_YEAR){
+							filter_GetYears(state, &gametable, filterdat);
 						}
 						
 						// Bring up the filter keyword selection pane
@@ -930,11 +1157,11 @@ int main() {
 						printf("%s.%d\t Redrawing main screen for Game ID: %d, %s\n", __FILE__, __LINE__, state->selected_gameid, state->selected_game->name);	
 					}
 					ui_DrawMainWindow();
-					ui_UpdateBrowserPane(state, gamedata);
+					ui_UpdateBrowserPane(state, &gametable);
 					gfx_Flip();
 					ui_DrawInfoBox();
 					ui_ReselectCurrentGame(state);
-					ui_UpdateInfoPane(state, gamedata, launchdat);
+					ui_UpdateInfoPane(state, &gametable, launchdat);
 					ui_UpdateBrowserPaneStatus(state);
 					gfx_Flip();
 					//ui_DisplayArtwork(screenshot_file, screenshot_bmp, screenshot_bmp_state, state, imagefile);
@@ -1007,7 +1234,9 @@ int main() {
 						if (config->verbose){
 							printf("%s.%d\t Toggle filter selection on/off\n", __FILE__, __LINE__);	
 						}
-						state->filter_strings_selected[state->selected_filter_string] = !(state->filter_strings_selected[state->selected_filter_string]);
+						if ((state->selected_filter_string >= 0) && (state->selected_filter_string < state->available_filter_strings)){
+							state->filter_strings_selected[state->selected_filter_string] = !(state->filter_strings_selected[state->selected_filter_string]);
+						}
 						ui_DrawFilterPopup(state, 0, 0, 1);
 						gfx_Flip();
 					} else {
@@ -1035,22 +1264,27 @@ int main() {
 				case(input_select):
 					if (state->selected_filter == FILTER_GENRE){
 						// Now apply the chosen filter
-						status = filter_Genre(state, gamedata, filterdat);
+						status = filter_Genre(state, &gametable, filterdat);
 					}
 					
 					if (state->selected_filter == FILTER_SERIES){
 						// Now apply the chosen filter
-						status = filter_Series(state, gamedata, filterdat);
+						status = filter_Series(state, &gametable, filterdat);
 					}
 					
 					if (state->selected_filter == FILTER_COMPANY){
 						// Now apply the chosen filter
-						status = filter_Company(state, gamedata, filterdat);
+						status = filter_Company(state, &gametable, filterdat);
 					}
 					
 					if (state->selected_filter == FILTER_TECH){
 						// Now apply the chosen filter
-						status = filter_TechSpecs(state, gamedata, filterdat);
+						status = filter_TechSpecs(state, &gametable, filterdat);
+					}
+					
+					if (state->selected_filter == FILTER_YEAR){
+						// Now apply the chosen filter
+						status = filter_Year(state, &gametable, filterdat);
 					}
 					
 					if (config->verbose){
@@ -1062,11 +1296,12 @@ int main() {
 						printf("%s.%d\t Redrawing main screen for Game ID: %d, %s\n", __FILE__, __LINE__, state->selected_gameid, state->selected_game->name);	
 					}
 					ui_DrawMainWindow();
-					ui_UpdateBrowserPane(state, gamedata);
+					ui_UpdateBrowserPane(state, &gametable);
 					gfx_Flip();
 					ui_DrawInfoBox();
 					ui_ReselectCurrentGame(state);
-					ui_UpdateInfoPane(state, gamedata, launchdat);
+					prefetchSelection(&prefetch, state);
+					ui_UpdateInfoPane(state, &gametable, launchdat);
 					ui_UpdateBrowserPaneStatus(state);
 					gfx_Flip();
 					//ui_DisplayArtwork(screenshot_file, screenshot_bmp, screenshot_bmp_state, state, imagefile);
@@ -1083,11 +1318,11 @@ int main() {
 						printf("%s.%d\t Redrawing main screen for Game ID: %d, %s\n", __FILE__, __LINE__, state->selected_gameid, state->selected_game->name);	
 					}
 					ui_DrawMainWindow();
-					ui_UpdateBrowserPane(state, gamedata);
+					ui_UpdateBrowserPane(state, &gametable);
 					gfx_Flip();
 					ui_DrawInfoBox();
 					ui_ReselectCurrentGame(state);
-					ui_UpdateInfoPane(state, gamedata, launchdat);
+					ui_UpdateInfoPane(state, &gametable, launchdat);
 					ui_UpdateBrowserPaneStatus(state);
 					gfx_Flip();
 					//ui_DisplayArtwork(screenshot_file, screenshot_bmp, screenshot_bmp_state, state, imagefile);
@@ -1109,6 +1344,51 @@ int main() {
 					exit = 1;
 					zeroRunBat();
 					break;
+				case(input_rescan):
+					// Scan all game directories again from scratch
+					if (config->verbose){
+						printf("%s.%d\t Rescanning game directories...\n", __FILE__, __LINE__);
+					}
+					ui_StatusMessage("Rescanning game directories, please wait...");
+					gfx_Flip();
+
+					// Scrape into a new table, so that we still have the old one if nothing is found.
+					// Nothing is reused from the old table: FAT does not update the date of a game
+					// directory when a file inside it changes, so an edited or new launch.dat would be missed.
+					found_tmp = scrapeGames(config, &gametable_rescan, NULL, filterdat, NULL);
+					if (found_tmp > 0){
+						removeGamedata(&gametable);
+						gametable = gametable_rescan;
+						initGametable(&gametable_rescan);
+						found = found_tmp;
+						status = catalog_Save(config, &gametable);
+						if (config->verbose){
+							printf("%s.%d\t Saved game catalog to %s [status:%d]\n", __FILE__, __LINE__, CATALOGFILE, status);
+						}
+
+						// Back to an unfiltered list in name order, and force the selected game to be reloaded
+						filter_CacheClear(state);
+						cache_Clear(&launchcache);
+						prefetch_Cancel(&prefetch);
+						state->selected_filter = FILTER_NONE;
+						state->sort_order = SORT_NAME;
+						status = filter_None(state, &gametable);
+						prefetchSelection(&prefetch, state);
+						old_gameid = -1;
+						ui_DrawMainWindow();
+						ui_UpdateBrowserPane(state, &gametable);
+						ui_DrawInfoBox();
+						ui_ReselectCurrentGame(state);
+						ui_UpdateBrowserPaneStatus(state);
+						sprintf(msg, "Rescan complete, found %d games", found);
+						ui_StatusMessage(msg);
+					} else {
+						removeGamedata(&gametable_rescan);
+						ui_StatusMessage("Rescan found no games, keeping existing list.");
+					}
+					gfx_Flip();
+					last = xclock();
+					break;
 				case(input_help):
 					// Show help screen
 					if (config->verbose){
@@ -1127,6 +1407,46 @@ int main() {
 					ui_DrawFilterPrePopup(state, 0);
 					gfx_Flip();
 					break;
+				case(input_search):
+					// Start a type-ahead search of the game names
+					if (config->verbose){
+						printf("%s.%d\t Starting type-ahead search...\n", __FILE__, __LINE__);	
+					}
+					active_pane = SEARCH_PANE;
+					state->search[0] = '\0';
+					state->search_len = 0;
+					filter_SearchReset(state, &gametable);
+					state->search_fuzzy = 0;
+					// Swallow the [S] that started the search
+					input_getkey();
+					ui_StatusMessage("Search: type a name, [Enter] done, [Esc] cancel");
+					gfx_Flip();
+					break;
+				case(input_sort):
+					// List the games in the next order: name, year, publisher, developer, genre, recently played
+					if (state->sort_order >= SORT_MAX){
+						i = SORT_NAME;
+					} else {
+						i = state->sort_order + 1;
+					}
+					if ((i != SORT_NAME) && (gametable.sort.orders == NULL)){
+						ui_StatusMessage("Sorting games, please wait...");
+						gfx_Flip();
+					}
+					status = filter_SetOrder(state, &gametable, filterdat, i);
+					if (config->verbose){
+						printf("%s.%d\t Sorted games by %s [status:%d]\n", __FILE__, __LINE__, sort_Name(state->sort_order), status);
+					}
+					input_release();
+					ui_UpdateBrowserPane(state, &gametable);
+					ui_ReselectCurrentGame(state);
+					prefetchSelection(&prefetch, state);
+					ui_UpdateBrowserPaneStatus(state);
+					sprintf(msg, "Sorted by %s", sort_Name(state->sort_order));
+					ui_StatusMessage(msg);
+					gfx_Flip();
+					last = xclock();
+					break;
 				case(input_select):
 					// Start a game or launch a config tool
 					if (state->selected_game->has_dat){
@@ -1144,7 +1464,7 @@ int main() {
 							}
 							active_pane = LAUNCH_PANE;
 							state->selected_start = START_MAIN;
-							ui_DrawLaunchPopup(state, gamedata, launchdat, 0);
+							ui_DrawLaunchPopup(state, &gametable, launchdat, 0);
 							gfx_Flip();
 							
 						} else if ((launchdat->start != NULL) && (strcmp(launchdat->start, "") != 0)){
@@ -1154,7 +1474,7 @@ int main() {
 							}
 							active_pane = CONFIRM_PANE;
 							state->selected_start = START_MAIN;
-							ui_DrawConfirmPopup(state, gamedata, launchdat);
+							ui_DrawConfirmPopup(state, &gametable, launchdat);
 							gfx_Flip();
 							
 						} else if ((launchdat->alt_start != NULL) && (strcmp(launchdat->alt_start, "") != 0)){
@@ -1164,7 +1484,7 @@ int main() {
 							}
 							active_pane = CONFIRM_PANE;
 							state->selected_start = START_ALT;
-							ui_DrawConfirmPopup(state, gamedata, launchdat);
+							ui_DrawConfirmPopup(state, &gametable, launchdat);
 							gfx_Flip();
 							
 						} else {
@@ -1197,7 +1517,7 @@ int main() {
 					// Detect if selected game has changed
 					ui_ReselectCurrentGame(state);
 					if (state->page_changed == 1){
-						ui_UpdateBrowserPane(state, gamedata);
+						ui_UpdateBrowserPane(state, &gametable);
 						state->page_changed = 0;
 					}
 					ui_UpdateBrowserPaneStatus(state);
@@ -1207,7 +1527,7 @@ int main() {
 					break;
 				case(input_down):
 					// Down current list by one row
-					if ((state->selected_line == ui_browser_max_lines - 1) || (state->selected_line == (state->selected_max - 1))){
+					if ((state->selected_line == ui_browser_max_lines - 1) || ((((state->selected_page - 1) * ui_browser_max_lines) + state->selected_line) >= (state->selected_max - 1))){
 						if (state->selected_page == state->total_pages){
 							// Go to first page
 							state->selected_page = 1;
@@ -1226,7 +1546,7 @@ int main() {
 					// Detect if selected game has changed
 					ui_ReselectCurrentGame(state);
 					if (state->page_changed == 1){
-						ui_UpdateBrowserPane(state, gamedata);
+						ui_UpdateBrowserPane(state, &gametable);
 						state->page_changed = 0;
 					}
 					ui_UpdateBrowserPaneStatus(state);
@@ -1248,7 +1568,7 @@ int main() {
 					state->selected_line = 0;
 					start_time = xclock();
 					ui_ReselectCurrentGame(state);
-					ui_UpdateBrowserPane(state, gamedata);
+					ui_UpdateBrowserPane(state, &gametable);
 					gfx_Flip();
 					// Update last to now so that we can trigger artwork in N ms.
 					last = xclock();
@@ -1268,7 +1588,7 @@ int main() {
 					state->selected_line = 0;
 					start_time = xclock();
 					ui_ReselectCurrentGame(state);
-					ui_UpdateBrowserPane(state, gamedata);
+					ui_UpdateBrowserPane(state, &gametable);
 					gfx_Flip();
 					// Update last to now so that we can trigger artwork in N ms.
 					last = xclock();
@@ -1349,11 +1669,10 @@ int main() {
 					// ======================
 					// Update selection to current game
 					// ======================
-					gamedata_head = gamedata;
 					if (config->verbose){
-						printf("%s.%d\t Finding gamedata from list for [%d]\n", __FILE__, __LINE__, state->selected_gameid);
+						printf("%s.%d\t Finding gamedata from table for [%d]\n", __FILE__, __LINE__, state->selected_gameid);
 					}
-					state->selected_game = getGameid(state->selected_gameid, gamedata);
+					state->selected_game = getGameid(state->selected_gameid, &gametable);
 					if (state->selected_game == NULL){
 						// Could not load gamedata object for this id - why?
 						// Reset to old gameid
@@ -1367,7 +1686,7 @@ int main() {
 							if (config->verbose){
 								printf("%s.%d\t Allocating memory and loading metadata for [%s]\n", __FILE__, __LINE__, state->selected_game->name);
 							}
-							status = getLaunchdata(state->selected_game, launchdat);
+							status = cache_Get(&launchcache, state->selected_game, launchdat);
 							if (status != 0){
 								if (config->verbose){
 									printf("%s.%d\t Error, could not load metadata\n", __FILE__, __LINE__);	
@@ -1376,6 +1695,8 @@ int main() {
 								gfx_Flip();
 							} else {
 								state->has_launchdat = 1;
+								// Saves the filters reading this launch.dat again
+								meta_Update(&gametable.meta, state->selected_game->gameid, launchdat);
 							}
 						}
 						
@@ -1397,13 +1718,15 @@ int main() {
 						// =======================
 						// Updating info and browser pane
 						// =======================
-						gamedata = gamedata_head;
 						if (config->verbose){
 							printf("%s.%d\t Updating info pane for new game\n", __FILE__, __LINE__);
 						}
-						ui_UpdateInfoPane(state, gamedata, launchdat);
+						ui_UpdateInfoPane(state, &gametable, launchdat);
 						old_gameid = state->selected_gameid;
 						
+						// Read ahead the games the cursor can move to next, while waiting for input
+						prefetchSelection(&prefetch, state);
+						
 						// =======================
 						// Select first screenshot/artwork to show
 						// =======================
@@ -1420,6 +1743,71 @@ int main() {
 			}
 		}
 		
+		// ==================================================
+		//
+		// Type-ahead search: each key typed narrows the
+		// game browser to the names starting with the
+		// text typed so far.
+		//
+		// ==================================================
+		if (active_pane == SEARCH_PANE){
+			c = input_getkey();
+			if ((c == input_key_enter) || (c == input_key_escape)){
+				if (c == input_key_escape){
+					// Put back the list from before the search
+					filter_Reapply(state, &gametable);
+				}
+				if (config->verbose){
+					printf("%s.%d\t Ending type-ahead search [%s]\n", __FILE__, __LINE__, state->search);	
+				}
+				input_release();
+				active_pane = BROWSER_PANE;
+				ui_UpdateBrowserPane(state, &gametable);
+				ui_ReselectCurrentGame(state);
+				prefetchSelection(&prefetch, state);
+				ui_UpdateBrowserPaneStatus(state);
+				ui_StatusMessage("Waiting for user input...");
+				gfx_Flip();
+				last = xclock();
+			} else if (c != 0){
+				if (c == input_key_backspace){
+					if (state->search_len > 0){
+						// A shorter search can match more, so start again from the whole index
+						state->search_len--;
+						state->search[state->search_len] = '\0';
+						filter_SearchReset(state, &gametable);
+						state->search_fuzzy = 0;
+						if (state->search_len == 0){
+							filter_Reapply(state, &gametable);
+						} else {
+							filter_Search(state, &gametable);
+						}
+					}
+				} else if (state->search_len < (MAXIMUM_SEARCH_SIZE - 1)){
+					state->search[state->search_len] = c;
+					state->search[state->search_len + 1] = '\0';
+					state->search_len++;
+					if (filter_Search(state, &gametable) < 1){
+						// Nothing starts with that, so ignore the key
+						state->search_len--;
+						state->search[state->search_len] = '\0';
+					}
+				}
+				if (state->search_fuzzy){
+					sprintf(msg, "Search: %s_  (%d close matches)", state->search, state->selected_max);
+				} else {
+					sprintf(msg, "Search: %s_  (%d games)", state->search, state->selected_max);
+				}
+				ui_UpdateBrowserPane(state, &gametable);
+				ui_ReselectCurrentGame(state);
+				prefetchSelection(&prefetch, state);
+				ui_UpdateBrowserPaneStatus(state);
+				ui_StatusMessage(msg);
+				gfx_Flip();
+				last = xclock();
+			}
+		}
+		
 		// ===========================================================================
 		//
 		// If the current game has artwork then progressively load it in, one line at
@@ -1463,11 +1851,28 @@ int main() {
 					break;
 			}
 		}
+		
+		// ===========================================================================
+		//
+		// Otherwise there is nothing to do until the user presses something, so use
+		// the time to read ahead the games around the cursor.
+		//
+		// ===========================================================================
+		
+		if ((active_pane == BROWSER_PANE) && (user_input == input_none) && (has_screenshot == 0) && (old_gameid == state->selected_gameid)){
+			prefetch_Run(&prefetch);
+		}
 	}
 	
+	if (config->verbose || config->timers){
+		printf("%s.%d\t Filter cache - %d hits, %d misses\n", __FILE__, __LINE__, state->filter_cache_hits, state->filter_cache_misses);
+		printf("%s.%d\t Metadata cache - %d hits, %d misses\n", __FILE__, __LINE__, launchcache.hits, launchcache.misses);
+		printf("%s.%d\t Prefetch - %d steps\n", __FILE__, __LINE__, prefetch.steps);
+	}
+	cache_Free(&launchcache);
 	free(config);
 	free(gamedir);
-	free(gamedata);
+	removeGamedata(&gametable);
 	txt_Clear();
 	txt_Close();
 	gfx_Close();
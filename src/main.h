@@ -17,38 +17,72 @@
 
 #define MY_NAME "x68launcher"
 
-#define SELECTION_LIST_SIZE			999 // Maximum number of entries in the game browser
-
 #define FILTER_NONE		0
 #define FILTER_GENRE	1
 #define FILTER_SERIES	2
 #define FILTER_COMPANY	3
 #define FILTER_TECH		4
-#define FILTER_MAX		4
+#define FILTER_YEAR		5
+#define FILTER_MAX		5
 #define START_MAIN		0
 #define START_ALT		1
 
-#define MAXIMUM_FILTER_STRINGS 			200
+#define FILTER_STRINGS_INITIAL_SIZE		64		// Filter strings allocated at first; grown as needed
 #define MAXIMUM_SELECTED_STRINGS 		30
 #define MAXIMUM_FILTER_STRINGS_PER_PAGE  32
 #define MAXIMUM_FILTER_STRINGS_PER_COL 	16
+#define MAXIMUM_SEARCH_SIZE				32		// Longest type-ahead search string, including end-of-string
+#define FILTER_CACHE_SIZE				4		// Number of recent filter results kept, so going back to one is just a copy
+
+// The result of one combination of filters, as it was when last applied
+typedef struct filtercache {
+	unsigned long *bits;				// Copy of state->filter_bits; FILTER_MAX + 1 bitsets of words each
+	int *list;							// Copy of the selection list
+	int list_size;						// Number of entries allocated in list
+	int count;							// Number of games selected; -1 if this entry is unused
+	int words;							// Number of words in each bitset
+	long keys[FILTER_MAX + 1];			// What each active filter type was filtering on
+	unsigned char active[FILTER_MAX + 1];	// Which filter types were active
+	unsigned char sort_order;			// Order of the selection list
+	unsigned long changes;				// Value of meta->changes at the time
+	unsigned long used;					// When this entry was last used, for replacing the oldest
+} __attribute__((__packed__)) __attribute__((aligned (2))) filtercache_t;
 
 typedef struct state {
-	unsigned char  selected_list[SELECTION_LIST_SIZE];		// A list of game ID's which are currently selected
-	unsigned char  selected_max;		// Number of items in the current selected list
-	unsigned char  selected_page;		// Page 'N' of the selected list
+	strpool_t filter_pool;				// Storage for the filter strings, emptied whenever the list is rebuilt (first, so it is always aligned)
+	filtercache_t filter_cache[FILTER_CACHE_SIZE];	// Recently applied filters and their results
+	unsigned long filter_cache_clock;	// Incremented on every use of the filter cache
+	int filter_cache_hits;				// Number of filters applied from the cache
+	int filter_cache_misses;			// Number of filters that had to be worked out
+	int *selected_list;					// A list of game ID's which are currently selected
+	int selected_list_size;				// Number of entries allocated for selected_list; grown to fit the game table
+	int selected_max;					// Number of items in the current selected list
+	int selected_page;					// Page 'N' of the selected list
 	unsigned char  selected_line;		// The line in the page indicating the selected game
-	unsigned char  total_pages;			// Total number of pages in the selected_list
+	int total_pages;					// Total number of pages in the selected_list
 	unsigned char  active_pane;
 	unsigned char selected_start;		// Which start file to launch, 0==start, 1==alt_start
 	unsigned char page_changed;			// Whether we have browsed to a new page or not
 	
 	unsigned char selected_filter;			// Which filter to use, 0==none, 1==genre, 2==series
-	unsigned char selected_filter_string;	// Which filter string is selected for non=multichoice filters
+	int selected_filter_string;			// Which filter string is selected for non=multichoice filters
 	
 	unsigned int available_filter_strings; // How many filter strings are currently available
-	unsigned char available_filter_pages;	// How many pages of filter strings are available
-	unsigned char current_filter_page;	// Which page of filter strings is currently selected
+	unsigned int available_filter_pages;	// How many pages of filter strings are available
+	unsigned int current_filter_page;	// Which page of filter strings is currently selected
+	
+	// Bitsets of the games matched by the last filter of each type, FILTER_NONE is the combined result
+	unsigned long *filter_bits;			// FILTER_MAX + 1 bitsets of filter_bits_words each
+	int filter_bits_words;				// Number of words in each bitset
+	long filter_keys[FILTER_MAX + 1];	// What each active filter type is filtering on; string id, mask or years
+	unsigned char filter_active[FILTER_MAX + 1];	// 1 if the bitset of that filter type is in use
+	
+	// Type-ahead search
+	char search[MAXIMUM_SEARCH_SIZE];	// Lower case text typed so far
+	int search_len;						// Number of characters in search
+	int search_low;						// First entry in the search index matching search
+	int search_high;					// One past the last entry in the search index matching search
+	unsigned char search_fuzzy;			// 1 if nothing starts with search, so the selection is fuzzy matches
 	
 	// Info about selected item
 	int selected_gameid;				// Currently selected gameid
@@ -57,9 +91,13 @@ typedef struct state {
 	unsigned char has_images;			// Current game has artwork
 	char selected_image[65];			// path + filename of current artwork
 	
-	// Filter list
-	char filter_strings[MAXIMUM_FILTER_STRINGS][MAX_STRING_SIZE];
-	unsigned char filter_strings_selected[MAXIMUM_FILTER_STRINGS]; // 1 or 0 to indicate if the string at this position is selected
+	// Filter list, grown to fit however many genres, series or companies there are
+	char **filter_strings;				// Each filter string, available_filter_strings of them, stored in filter_pool above
+	int *filter_counts;					// Number of games matching the filter string at this position
+	unsigned char *filter_strings_selected; // 1 or 0 to indicate if the string at this position is selected
+	int filter_strings_size;			// Number of entries allocated in each of the three arrays above
+	unsigned char filter_sort;			// Order of the filter strings, FILTER_SORT_NAME or FILTER_SORT_COUNT
+	unsigned char sort_order;			// Order of the games in the browser; SORT_NAME, SORT_YEAR etc.
 	
 	
 } __attribute__((__packed__)) __attribute__((aligned (2))) state_t;
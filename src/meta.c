@@ -0,0 +1,597 @@
+/* meta.c, In-memory index of game metadata for x68Launcher.
+ Copyright (C) 2020  John Snowdon
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#ifndef __HAS_DATA
+#include "data.h"
+#define __HAS_DATA
+#endif
+#include "meta.h"
+
+// Every hardware flag, by bit number. Adding a new [misc] key to launch.dat only
+// needs a META_HW_ bit and a line here; it is then parsed, indexed and offered
+// in the tech specs filter.
+static metahw_t meta_hw[META_HW_BITS] = {
+	{ "misc",		"fpu",			"Misc: FPU" },			// META_HW_FPU
+	{ "misc",		"cyberstick",	"Input: Cyberstick" },	// META_HW_CYBERSTICK
+	{ "misc",		"2hdsim",		"Floppy: 2HDSim" },		// META_HW_2HDSIM
+	{ "misc",		"2hdboot",		"Floppy: 2HDBoot" },	// META_HW_2HDBOOT
+	{ "default",	"midi_mpu",		"Audio: MIDI" },		// META_HW_MIDI
+	{ "default",	"midi_serial",	"Audio: MIDI Serial" },	// META_HW_MIDI_SERIAL
+};
+
+void meta_Init(metaindex_t *meta){
+	/* Set up an empty metadata index - nothing is allocated until meta_Reset() */
+	
+	meta->size = 0;
+	meta->state = NULL;
+	meta->genre = NULL;
+	meta->series = NULL;
+	meta->developer = NULL;
+	meta->publisher = NULL;
+	meta->year = NULL;
+	meta->hardware = NULL;
+	meta->strings = NULL;
+	meta->strings_size = 0;
+	meta->strings_capacity = 0;
+	meta->hash = NULL;
+	meta->hash_size = 0;
+	strpool_Init(&meta->pool);
+	meta->years = NULL;
+	meta->years_size = 0;
+	meta->changes = 0;
+}
+
+int meta_Reset(metaindex_t *meta, int games){
+	/* Size the index for a number of games, marking the metadata of every game as unread */
+	
+	// All of the per-game arrays are carved out of a single allocation. Any strings
+	// already interned are kept, so their ids stay the same.
+	
+	char *block;
+	
+	if (meta->genre != NULL){
+		free(meta->genre);
+	}
+	meta_FreeYears(meta);
+	meta->changes++;
+	meta->size = 0;
+	meta->state = NULL;
+	meta->genre = NULL;
+	meta->series = NULL;
+	meta->developer = NULL;
+	meta->publisher = NULL;
+	meta->year = NULL;
+	meta->hardware = NULL;
+	if (games < 1){
+		return META_OK;
+	}
+	
+	// 4 string ids and a year of 2 bytes each, then state and hardware of 1 byte each
+	block = (char *) calloc(games, 12);
+	if (block == NULL){
+		if (META_VERBOSE){
+			printf("%s.%d\t meta_Reset() Unable to allocate index for %d games\n", __FILE__, __LINE__, games);
+		}
+		return META_ERR_MEM;
+	}
+	meta->genre = (unsigned short *) block;
+	meta->series = (unsigned short *) (block + (games * 2));
+	meta->developer = (unsigned short *) (block + (games * 4));
+	meta->publisher = (unsigned short *) (block + (games * 6));
+	meta->year = (short *) (block + (games * 8));
+	meta->state = (unsigned char *) (block + (games * 10));
+	meta->hardware = (unsigned char *) (block + (games * 11));
+	meta->size = games;
+	
+	if (META_VERBOSE){
+		printf("%s.%d\t meta_Reset() Index sized for %d games [%d bytes]\n", __FILE__, __LINE__, games, games * 12);
+	}
+	return META_OK;
+}
+
+void meta_Free(metaindex_t *meta){
+	/* Free the index and all interned strings */
+	
+	if (meta->genre != NULL){
+		free(meta->genre);
+	}
+	if (meta->strings != NULL){
+		free(meta->strings);
+	}
+	if (meta->hash != NULL){
+		free(meta->hash);
+	}
+	meta_FreeYears(meta);
+	strpool_Free(&meta->pool);
+	meta_Init(meta);
+}
+
+static unsigned long hashString(char *s){
+	// FNV-1a hash of a string, over the same MAX_STRING_SIZE - 1 characters that are interned
+	
+	unsigned long hash;
+	int i;
+	
+	hash = 2166136261UL;
+	for(i = 0; (i < (MAX_STRING_SIZE - 1)) && (s[i] != '\0'); i++){
+		hash ^= (unsigned char) s[i];
+		hash *= 16777619UL;
+	}
+	return hash;
+}
+
+static int findSlot(metaindex_t *meta, char *s){
+	// Return the hash slot holding a string, or the empty slot where it would go
+	
+	// The table is never more than half full, so there is always an empty slot
+	// to stop the probe.
+	
+	unsigned long slot;
+	unsigned long mask;
+	int id;
+	
+	mask = meta->hash_size - 1;
+	slot = hashString(s) & mask;
+	for(;;){
+		id = meta->hash[slot];
+		if ((id == META_NONE) || (strncmp(meta->strings[id], s, MAX_STRING_SIZE - 1) == 0)){
+			return (int) slot;
+		}
+		slot = (slot + 1) & mask;
+	}
+}
+
+static int growHash(metaindex_t *meta){
+	// Double the number of hash slots and re-insert every interned string
+	
+	int i;
+	int size;
+	unsigned short *hash;
+	
+	if (meta->hash_size == 0){
+		size = META_HASH_INITIAL_SIZE;
+	} else {
+		size = meta->hash_size * 2;
+	}
+	hash = (unsigned short *) calloc(size, sizeof(unsigned short));
+	if (hash == NULL){
+		return META_ERR_MEM;
+	}
+	if (meta->hash != NULL){
+		free(meta->hash);
+	}
+	meta->hash = hash;
+	meta->hash_size = size;
+	for(i = 1; i < meta->strings_size; i++){
+		meta->hash[findSlot(meta, meta->strings[i])] = i;
+	}
+	if (META_VERBOSE){
+		printf("%s.%d\t growHash() %d slots for %d strings\n", __FILE__, __LINE__, meta->hash_size, meta->strings_size);
+	}
+	return META_OK;
+}
+
+int meta_Find(metaindex_t *meta, char *s){
+	/* Return the string id of an interned string, or META_NONE if it has never been interned */
+	
+	if ((s == NULL) || (s[0] == '\0') || (meta->hash_size == 0)){
+		return META_NONE;
+	}
+	return meta->hash[findSlot(meta, s)];
+}
+
+int meta_Intern(metaindex_t *meta, char *s){
+	/* Return the string id of a string, adding it to the interned strings if it is new */
+	
+	// Strings are limited to MAX_STRING_SIZE - 1 characters, as they are in launchdat_t.
+	// Lookups are a hash and (usually) one string compare, however many strings there are.
+	// Returns META_ERR_MEM if the string could not be stored.
+	
+	int id;
+	int len;
+	int slot;
+	int capacity;
+	char **strings;
+	
+	if ((s == NULL) || (s[0] == '\0')){
+		return META_NONE;
+	}
+	
+	// Keep the hash table no more than half full
+	if (((meta->strings_size + 1) * 2) > meta->hash_size){
+		if (growHash(meta) != META_OK){
+			return META_ERR_MEM;
+		}
+	}
+	slot = findSlot(meta, s);
+	if (meta->hash[slot] != META_NONE){
+		return meta->hash[slot];
+	}
+	
+	// String ids are stored as unsigned short
+	if (meta->strings_size >= 0xFFFF){
+		return META_ERR_MEM;
+	}
+	if (meta->strings_size >= meta->strings_capacity){
+		if (meta->strings_capacity == 0){
+			capacity = META_STRINGS_INITIAL_SIZE;
+		} else {
+			capacity = meta->strings_capacity * 2;
+		}
+		strings = (char **) realloc(meta->strings, capacity * sizeof(char *));
+		if (strings == NULL){
+			return META_ERR_MEM;
+		}
+		meta->strings = strings;
+		meta->strings_capacity = capacity;
+		if (meta->strings_size == 0){
+			meta->strings[META_NONE] = "";
+			meta->strings_size = 1;
+		}
+	}
+	
+	for(len = 0; (len < (MAX_STRING_SIZE - 1)) && (s[len] != '\0'); len++){
+	}
+	id = meta->strings_size;
+	meta->strings[id] = strpool_AddLength(&meta->pool, s, len);
+	if (meta->strings[id] == NULL){
+		return META_ERR_MEM;
+	}
+	meta->hash[slot] = id;
+	meta->strings_size++;
+	return id;
+}
+
+char * meta_String(metaindex_t *meta, int id){
+	/* Return the interned string for a string id */
+	
+	if ((id <= META_NONE) || (id >= meta->strings_size)){
+		return "";
+	}
+	return meta->strings[id];
+}
+
+int meta_Update(metaindex_t *meta, int gameid, launchdat_t *launchdat){
+	/* Record the metadata of a game from its (already parsed) launch.dat */
+	
+	int genre;
+	int series;
+	int developer;
+	int publisher;
+	unsigned char hardware;
+	
+	if ((gameid < 0) || (gameid >= meta->size)){
+		return META_ERR_LOAD;
+	}
+	
+	genre = meta_Intern(meta, launchdat->genre);
+	series = meta_Intern(meta, launchdat->series);
+	developer = meta_Intern(meta, launchdat->developer);
+	publisher = meta_Intern(meta, launchdat->publisher);
+	if ((genre < 0) || (series < 0) || (developer < 0) || (publisher < 0)){
+		if (META_VERBOSE){
+			printf("%s.%d\t meta_Update() Unable to intern strings for Game ID %d\n", __FILE__, __LINE__, gameid);
+		}
+		return META_ERR_MEM;
+	}
+	
+	// Already a mask of META_HW_ bits, set as launch.dat was parsed
+	hardware = launchdat->hardware->flags;
+	
+	if ((meta->years != NULL) && (meta->year[gameid] != launchdat->year)){
+		// The year index no longer matches; it is built again when next needed
+		meta_FreeYears(meta);
+	}
+	if ((meta->state[gameid] == META_STATE_LOADED) && ((meta->genre[gameid] != genre) || (meta->series[gameid] != series) || (meta->developer[gameid] != developer) || (meta->publisher[gameid] != publisher) || (meta->year[gameid] != launchdat->year) || (meta->hardware[gameid] != hardware))){
+		// Anything filtered on the old metadata is out of date
+		meta->changes++;
+	}
+	meta->genre[gameid] = genre;
+	meta->series[gameid] = series;
+	meta->developer[gameid] = developer;
+	meta->publisher[gameid] = publisher;
+	meta->year[gameid] = launchdat->year;
+	meta->hardware[gameid] = hardware;
+	meta->state[gameid] = META_STATE_LOADED;
+	return META_OK;
+}
+
+int meta_Load(metaindex_t *meta, gamedata_t *gamedata, launchdat_t *launchdat){
+	/* Make sure the metadata of a game is in the index, reading its launch.dat if it is not */
+	
+	// launchdat: scratch space used to parse launch.dat; it is only filled in if the
+	//            game has not been indexed before, so callers must use the index, not this.
+	
+	int status;
+	
+	if ((gamedata->gameid < 0) || (gamedata->gameid >= meta->size)){
+		return META_ERR_LOAD;
+	}
+	
+	switch(meta->state[gamedata->gameid]){
+		case(META_STATE_LOADED):
+			return META_OK;
+		case(META_STATE_MISSING):
+			return META_ERR_LOAD;
+		default:
+			break;
+	}
+	
+	// The name, start files and images are not indexed, so are not even parsed
+	status = getLaunchdataFields(gamedata, launchdat, LAUNCHDAT_META);
+	if (status != 0){
+		meta->state[gamedata->gameid] = META_STATE_MISSING;
+		return META_ERR_LOAD;
+	}
+	return meta_Update(meta, gamedata->gameid, launchdat);
+}
+
+int meta_LoadAll(metaindex_t *meta, gametable_t *gametable, launchdat_t *launchdat){
+	/* Make sure the metadata of every game with a launch.dat is in the index */
+	
+	// Returns the number of games with metadata. Only the first call after a
+	// (re)scan needs to read anything from disk.
+	
+	int i;
+	int found;
+	
+	found = 0;
+	for(i = 0; i < gametable->size; i++){
+		if (gametable->games[i].has_dat){
+			if (meta_Load(meta, &gametable->games[i], launchdat) == META_OK){
+				found++;
+			}
+		}
+	}
+	if (META_VERBOSE){
+		printf("%s.%d\t meta_LoadAll() %d of %d games have metadata, %d strings interned\n", __FILE__, __LINE__, found, gametable->size, meta->strings_size);
+	}
+	return found;
+}
+
+int meta_BitsetWords(metaindex_t *meta){
+	/* Return the number of words in a bitset with a bit for every game in the index */
+	
+	return (meta->size + META_BITSET_BITS - 1) / META_BITSET_BITS;
+}
+
+void meta_BitsetMatch(metaindex_t *meta, unsigned short *column, int id, unsigned long *bits){
+	/* Set the bit of every game whose string id in a column (genre, series etc.) is id */
+	
+	// Bits are only ever set, so calling this for several columns or ids builds
+	// up an OR of all of them.
+	
+	int i;
+	
+	for(i = 0; i < meta->size; i++){
+		if ((column[i] == id) && (meta->state[i] == META_STATE_LOADED)){
+			bits[i / META_BITSET_BITS] |= 1UL << (i % META_BITSET_BITS);
+		}
+	}
+}
+
+void meta_BitsetHardware(metaindex_t *meta, unsigned char mask, unsigned long *bits){
+	/* Set the bit of every game that has all of the hardware flags in mask */
+	
+	int i;
+	
+	for(i = 0; i < meta->size; i++){
+		if (((meta->hardware[i] & mask) == mask) && (meta->state[i] == META_STATE_LOADED)){
+			bits[i / META_BITSET_BITS] |= 1UL << (i % META_BITSET_BITS);
+		}
+	}
+}
+
+unsigned char meta_HardwareKey(const char *section, const char *key){
+	/* Return the META_HW_ flag set by a launch.dat key, or 0 if it is not a hardware key */
+	
+	int i;
+	
+	for(i = 0; i < META_HW_BITS; i++){
+		if ((strcmp(meta_hw[i].key, key) == 0) && (strcmp(meta_hw[i].section, section) == 0)){
+			return 1 << i;
+		}
+	}
+	return 0;
+}
+
+char * meta_HardwareName(int bit){
+	/* Return the name of hardware flag (1 << bit) in the tech specs filter */
+	
+	if ((bit < 0) || (bit >= META_HW_BITS)){
+		return NULL;
+	}
+	return meta_hw[bit].name;
+}
+
+unsigned char meta_HardwareFlag(char *name){
+	/* Return the META_HW_ flag with a given name in the tech specs filter, or 0 */
+	
+	int i;
+	
+	for(i = 0; i < META_HW_BITS; i++){
+		if (strcmp(meta_hw[i].name, name) == 0){
+			return 1 << i;
+		}
+	}
+	return 0;
+}
+
+void meta_CountHardware(metaindex_t *meta, int *counts){
+	/* Count the loaded games with each hardware flag; counts has META_HW_BITS entries */
+	
+	int g;
+	int i;
+	unsigned char hardware;
+	
+	for(i = 0; i < META_HW_BITS; i++){
+		counts[i] = 0;
+	}
+	for(g = 0; g < meta->size; g++){
+		if (meta->state[g] == META_STATE_LOADED){
+			hardware = meta->hardware[g];
+			for(i = 0; hardware != 0; i++){
+				if (hardware & 1){
+					counts[i]++;
+				}
+				hardware >>= 1;
+			}
+		}
+	}
+}
+
+void meta_BitsetAnd(unsigned long *bits, unsigned long *other, int words){
+	/* Clear every bit in bits that is not also set in other */
+	
+	int i;
+	
+	for(i = 0; i < words; i++){
+		bits[i] &= other[i];
+	}
+}
+
+int meta_BitsetList(unsigned long *bits, int words, int *list){
+	/* Write the gameid of every set bit, in ascending order, to list; returns how many were written */
+	
+	// Game ids follow the sorted order of the game table, so the list comes
+	// out sorted by name. Empty words are skipped whole.
+	
+	int i;
+	int b;
+	int n;
+	unsigned long word;
+	
+	n = 0;
+	for(i = 0; i < words; i++){
+		word = bits[i];
+		b = 0;
+		while (word != 0){
+			if (word & 1){
+				list[n] = (i * META_BITSET_BITS) + b;
+				n++;
+			}
+			word >>= 1;
+			b++;
+		}
+	}
+	return n;
+}
+
+static int compareYears(const void *op1, const void *op2){
+	// Order two year index entries by year, then by gameid
+	
+	const yearentry_t *a = (const yearentry_t *) op1;
+	const yearentry_t *b = (const yearentry_t *) op2;
+	
+	if (a->year != b->year){
+		return a->year - b->year;
+	}
+	return a->gameid - b->gameid;
+}
+
+void meta_FreeYears(metaindex_t *meta){
+	/* Free the year index; it will be built again the next time it is needed */
+	
+	if (meta->years != NULL){
+		free(meta->years);
+	}
+	meta->years = NULL;
+	meta->years_size = 0;
+}
+
+int meta_BuildYears(metaindex_t *meta){
+	/* Build the index of every game with a year, sorted by year and then gameid */
+	
+	// The metadata of every game should already have been read with meta_LoadAll().
+	// Once built, all the games of any range of years are one contiguous run of
+	// entries, found with two binary searches by meta_FindYear(), and the run
+	// lengths are the number of games released each year.
+	
+	int i;
+	int n;
+	
+	meta_FreeYears(meta);
+	n = 0;
+	for(i = 0; i < meta->size; i++){
+		if ((meta->state[i] == META_STATE_LOADED) && (meta->year[i] > 0)){
+			n++;
+		}
+	}
+	if (n == 0){
+		return META_OK;
+	}
+	meta->years = (yearentry_t *) malloc(n * sizeof(yearentry_t));
+	if (meta->years == NULL){
+		return META_ERR_MEM;
+	}
+	n = 0;
+	for(i = 0; i < meta->size; i++){
+		if ((meta->state[i] == META_STATE_LOADED) && (meta->year[i] > 0)){
+			meta->years[n].year = meta->year[i];
+			meta->years[n].gameid = i;
+			n++;
+		}
+	}
+	qsort(meta->years, n, sizeof(yearentry_t), compareYears);
+	meta->years_size = n;
+	
+	if (META_VERBOSE){
+		printf("%s.%d\t meta_BuildYears() %d games with a year, %d to %d\n", __FILE__, __LINE__, n, meta->years[0].year, meta->years[n - 1].year);
+	}
+	return META_OK;
+}
+
+int meta_FindYear(metaindex_t *meta, int year){
+	/* Return the position in the year index of the first game from year onwards; years_size if there are none */
+	
+	int low;
+	int high;
+	int mid;
+	
+	low = 0;
+	high = meta->years_size;
+	while (low < high){
+		mid = (low + high) / 2;
+		if (meta->years[mid].year < year){
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+	return low;
+}
+
+int meta_BitsetYears(metaindex_t *meta, int from, int to, unsigned long *bits){
+	/* Set the bit of every game released between two years, inclusive; returns how many were set */
+	
+	int i;
+	int start;
+	int end;
+	int id;
+	
+	start = meta_FindYear(meta, from);
+	end = meta_FindYear(meta, to + 1);
+	for(i = start; i < end; i++){
+		id = meta->years[i].gameid;
+		bits[id / META_BITSET_BITS] |= 1UL << (id % META_BITSET_BITS);
+	}
+	return end - start;
+}
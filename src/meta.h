@@ -0,0 +1,80 @@
+/* meta.h, In-memory index of game metadata for x68Launcher.
+ Copyright (C) 2020  John Snowdon
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __HAS_DATA
+#include "data.h"
+#define __HAS_DATA
+#endif
+
+#define META_VERBOSE			0		// Enable/disable metadata index verbose/debug output
+#define META_STRINGS_INITIAL_SIZE	64	// Number of interned strings allocated when the first is added
+#define META_NONE				0		// String id of the empty string; the field is not set
+#define META_HASH_INITIAL_SIZE	128		// Hash slots allocated when the first string is added; must be a power of 2
+
+// Return codes
+#define META_OK					0
+#define META_ERR_MEM			-1		// Unable to allocate memory
+#define META_ERR_LOAD			-2		// Game has no metadata, or it could not be read
+
+// Values of metaindex_t.state
+#define META_STATE_UNREAD		0		// launch.dat not read yet
+#define META_STATE_LOADED		1		// launch.dat read and indexed
+#define META_STATE_MISSING		2		// No launch.dat, or it could not be read
+
+// Bits of metaindex_t.hardware and hwdata_t.flags; each one has an entry in the
+// table of hardware keys in meta.c, in bit order
+#define META_HW_FPU				0x01
+#define META_HW_CYBERSTICK		0x02
+#define META_HW_2HDSIM			0x04
+#define META_HW_2HDBOOT			0x08
+#define META_HW_MIDI			0x10
+#define META_HW_MIDI_SERIAL		0x20
+#define META_HW_BITS			6		// Number of hardware flags; at most 8
+
+// A hardware flag, the launch.dat key that sets it and its name in the tech specs filter
+typedef struct metahw {
+	char *section;				// launch.dat section, e.g. "misc"
+	char *key;					// launch.dat key; the flag is set if its value is 1
+	char *name;					// Name shown in the tech specs filter
+} metahw_t;
+
+// Game bitsets: one bit per gameid, held in words of META_BITSET_BITS bits
+#define META_BITSET_BITS		32
+
+// Function prototypes
+void	meta_Init(metaindex_t *meta);
+int		meta_Reset(metaindex_t *meta, int games);
+void	meta_Free(metaindex_t *meta);
+int		meta_Intern(metaindex_t *meta, char *s);
+int		meta_Find(metaindex_t *meta, char *s);
+char *	meta_String(metaindex_t *meta, int id);
+int		meta_Update(metaindex_t *meta, int gameid, launchdat_t *launchdat);
+int		meta_Load(metaindex_t *meta, gamedata_t *gamedata, launchdat_t *launchdat);
+int		meta_LoadAll(metaindex_t *meta, gametable_t *gametable, launchdat_t *launchdat);
+int		meta_BitsetWords(metaindex_t *meta);
+void	meta_BitsetMatch(metaindex_t *meta, unsigned short *column, int id, unsigned long *bits);
+void	meta_BitsetHardware(metaindex_t *meta, unsigned char mask, unsigned long *bits);
+unsigned char meta_HardwareKey(const char *section, const char *key);
+char *	meta_HardwareName(int bit);
+unsigned char meta_HardwareFlag(char *name);
+void	meta_CountHardware(metaindex_t *meta, int *counts);
+void	meta_BitsetAnd(unsigned long *bits, unsigned long *other, int words);
+int		meta_BitsetList(unsigned long *bits, int words, int *list);
+void	meta_FreeYears(metaindex_t *meta);
+int		meta_BuildYears(metaindex_t *meta);
+int		meta_FindYear(metaindex_t *meta, int year);
+int		meta_BitsetYears(metaindex_t *meta, int from, int to, unsigned long *bits);
@@ -0,0 +1,154 @@
+/* prefetch.c, Idle-time read ahead of the games around the cursor for x68Launcher.
+ Copyright (C) 2020  John Snowdon
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+
+#include "prefetch.h"
+
+void prefetch_Init(prefetch_t *prefetch, long int budget, prefetch_clock clock, prefetch_pending pending, prefetch_work work, void *user){
+	/* Set up an empty prefetch queue */
+	
+	prefetch->size = 0;
+	prefetch->next = 0;
+	prefetch->step = PREFETCH_STEP_META;
+	prefetch->budget = budget;
+	prefetch->clock = clock;
+	prefetch->pending = pending;
+	prefetch->work = work;
+	prefetch->user = user;
+	prefetch->steps = 0;
+}
+
+static void queueGame(prefetch_t *prefetch, int *list, int pos, int current){
+	/* Add the game at pos in the selection list to the queue, unless it is already there */
+	
+	int i;
+	
+	if (prefetch->size >= PREFETCH_MAX){
+		return;
+	}
+	if (list[pos] == current){
+		return;
+	}
+	for(i = 0; i < prefetch->size; i++){
+		if (prefetch->gameids[i] == list[pos]){
+			return;
+		}
+	}
+	prefetch->gameids[prefetch->size] = list[pos];
+	prefetch->size++;
+}
+
+void prefetch_Plan(prefetch_t *prefetch, int *list, int size, int pos, int page_lines){
+	/* Queue up the games that the cursor can reach next from pos in the selection list */
+	
+	// The order follows the browser keys in main(): down and up a line (which move to
+	// another page at either end of this one), page down and page up, and then further
+	// lines either side of the cursor. Anything queued before is dropped.
+	
+	int line;
+	int page;
+	int last_page;
+	int i;
+	
+	prefetch->size = 0;
+	prefetch->next = 0;
+	prefetch->step = PREFETCH_STEP_META;
+	if ((list == NULL) || (size < 2) || (pos < 0) || (pos >= size) || (page_lines < 1)){
+		return;
+	}
+	line = pos % page_lines;
+	page = pos - line;
+	last_page = ((size - 1) / page_lines) * page_lines;
+	
+	// Down; the last line of a page, or of the list, goes to the top of the next page
+	if ((line == page_lines - 1) || (pos == size - 1)){
+		queueGame(prefetch, list, (page == last_page) ? 0 : page + page_lines, list[pos]);
+	} else {
+		queueGame(prefetch, list, pos + 1, list[pos]);
+	}
+	
+	// Up; the top line of a page goes to the top of the previous page
+	if (line == 0){
+		queueGame(prefetch, list, (page == 0) ? last_page : page - page_lines, list[pos]);
+	} else {
+		queueGame(prefetch, list, pos - 1, list[pos]);
+	}
+	
+	// Page down and page up
+	queueGame(prefetch, list, (page == last_page) ? 0 : page + page_lines, list[pos]);
+	queueGame(prefetch, list, (page == 0) ? last_page : page - page_lines, list[pos]);
+	
+	// Then work outwards from the cursor
+	for(i = 2; (prefetch->size < PREFETCH_MAX) && ((pos + i < size) || (pos - i >= 0)); i++){
+		if (pos + i < size){
+			queueGame(prefetch, list, pos + i, list[pos]);
+		}
+		if (pos - i >= 0){
+			queueGame(prefetch, list, pos - i, list[pos]);
+		}
+	}
+	if (PREFETCH_VERBOSE){
+		printf("%s.%d\t prefetch_Plan() Queued %d games around position %d\n", __FILE__, __LINE__, prefetch->size, pos);
+	}
+}
+
+void prefetch_Cancel(prefetch_t *prefetch){
+	/* Drop anything still queued, e.g. when a rescan gives out new game ids */
+	
+	prefetch->size = 0;
+	prefetch->next = 0;
+	prefetch->step = PREFETCH_STEP_META;
+}
+
+int prefetch_Run(prefetch_t *prefetch){
+	/* Carry out queued steps until the queue is empty, the budget is spent or the user presses something */
+	
+	// Returns the number of steps carried out. Each step runs to completion, so a
+	// slow one can overrun the budget; the budget is checked before each one.
+	
+	long int start;
+	int steps;
+	int status;
+	
+	steps = 0;
+	if (prefetch->budget < 1){
+		return 0;
+	}
+	start = prefetch->clock();
+	while (prefetch->next < prefetch->size){
+		if ((prefetch->clock() - start) >= prefetch->budget){
+			break;
+		}
+		if (prefetch->pending()){
+			break;
+		}
+		status = prefetch->work(prefetch->user, prefetch->gameids[prefetch->next], prefetch->step);
+		steps++;
+		if ((status != PREFETCH_OK) || (prefetch->step >= PREFETCH_STEP_MAX)){
+			prefetch->next++;
+			prefetch->step = PREFETCH_STEP_META;
+		} else {
+			prefetch->step++;
+		}
+	}
+	prefetch->steps += steps;
+	if (PREFETCH_VERBOSE && (steps > 0)){
+		printf("%s.%d\t prefetch_Run() %d steps, %d of %d games done\n", __FILE__, __LINE__, steps, prefetch->next, prefetch->size);
+	}
+	return steps;
+}
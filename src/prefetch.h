@@ -0,0 +1,55 @@
+/* prefetch.h, Idle-time read ahead of the games around the cursor for x68Launcher.
+ Copyright (C) 2020  John Snowdon
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// The scheduler only decides which games to read ahead, and when to stop. The clock,
+// the check for waiting input and the reading itself are all passed in, so this file
+// has no dependencies on Human68k and can be run with a fake clock and input.
+
+#define PREFETCH_VERBOSE	0		// Enable/disable prefetch verbose/debug output
+#define PREFETCH_MAX		8		// Most games queued around the cursor at a time
+
+// Steps of reading ahead each game, in order
+#define PREFETCH_STEP_META	0		// Parse the launch.dat
+#define PREFETCH_STEP_ART	1		// Open the first artwork and read its header
+#define PREFETCH_STEP_MAX	1
+
+// Return codes of a prefetch_work function
+#define PREFETCH_OK			0		// Step done; go on to the next step of the same game
+#define PREFETCH_SKIP		1		// Nothing more to do for this game
+
+typedef long int (*prefetch_clock)(void);
+typedef int (*prefetch_pending)(void);
+typedef int (*prefetch_work)(void *user, int gameid, int step);
+
+typedef struct prefetch {
+	int gameids[PREFETCH_MAX];	// Games to read ahead, most likely to be selected next first
+	int size;					// Number of games queued
+	int next;					// Position in gameids of the game being read ahead
+	int step;					// Next PREFETCH_STEP_ of that game
+	long int budget;			// Clock ticks that prefetch_Run() may spend; 0 to disable
+	prefetch_clock clock;		// Current time, in ticks
+	prefetch_pending pending;	// Returns non-zero if the user has pressed something
+	prefetch_work work;			// Carries out one step for one game
+	void *user;					// Passed on to work
+	int steps;					// Steps carried out since prefetch_Init()
+} __attribute__((__packed__)) __attribute__((aligned (2))) prefetch_t;
+
+// Function prototypes
+void	prefetch_Init(prefetch_t *prefetch, long int budget, prefetch_clock clock, prefetch_pending pending, prefetch_work work, void *user);
+void	prefetch_Plan(prefetch_t *prefetch, int *list, int size, int pos, int page_lines);
+void	prefetch_Cancel(prefetch_t *prefetch);
+int		prefetch_Run(prefetch_t *prefetch);
@@ -0,0 +1,463 @@
+/* search.c, Type-ahead game name search for x68Launcher.
+ Copyright (C) 2020  John Snowdon
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <ctype.h>
+
+#ifndef __HAS_DATA
+#include "data.h"
+#define __HAS_DATA
+#endif
+#include "search.h"
+
+static int compareFolded(const void *op1, const void *op2){
+	// Order two gamedata pointers by name, ignoring case, then by gameid
+	
+	gamedata_t *a;
+	gamedata_t *b;
+	unsigned char *x;
+	unsigned char *y;
+	
+	a = *(gamedata_t **) op1;
+	b = *(gamedata_t **) op2;
+	x = (unsigned char *) a->name;
+	y = (unsigned char *) b->name;
+	while ((*x != '\0') && (tolower(*x) == tolower(*y))){
+		x++;
+		y++;
+	}
+	if (tolower(*x) != tolower(*y)){
+		return tolower(*x) - tolower(*y);
+	}
+	return a->gameid - b->gameid;
+}
+
+static int comparePrefix(char *name, char *prefix){
+	// Compare the start of a name with a (lower case) prefix, ignoring case
+	
+	// Returns 0 if the name starts with the prefix, otherwise less or more
+	// than 0 as the name sorts before or after every name that does.
+	
+	int i;
+	int c;
+	
+	for(i = 0; prefix[i] != '\0'; i++){
+		c = tolower((unsigned char) name[i]);
+		if (c != (unsigned char) prefix[i]){
+			return c - (unsigned char) prefix[i];
+		}
+	}
+	return 0;
+}
+
+void search_Init(searchindex_t *search){
+	/* Set up an empty search index */
+	
+	search->order = NULL;
+	search->size = 0;
+}
+
+void search_Free(searchindex_t *search){
+	/* Free the search index; it will be built again the next time it is needed */
+	
+	if (search->order != NULL){
+		free(search->order);
+	}
+	search_Init(search);
+}
+
+int search_Build(searchindex_t *search, gametable_t *gametable){
+	/* Sort every game in the table by name, ignoring case */
+	
+	// The game table itself is already sorted by name, but with upper case
+	// before lower case, which is no good for type-ahead.
+	
+	int i;
+	gamedata_t **games;
+	
+	search_Free(search);
+	if (gametable->size < 1){
+		return SEARCH_OK;
+	}
+	games = (gamedata_t **) malloc(gametable->size * sizeof(gamedata_t *));
+	search->order = (int *) malloc(gametable->size * sizeof(int));
+	if ((games == NULL) || (search->order == NULL)){
+		if (games != NULL){
+			free(games);
+		}
+		search_Free(search);
+		return SEARCH_ERR_MEM;
+	}
+	for(i = 0; i < gametable->size; i++){
+		games[i] = &gametable->games[i];
+	}
+	qsort(games, gametable->size, sizeof(gamedata_t *), compareFolded);
+	for(i = 0; i < gametable->size; i++){
+		search->order[i] = games[i]->gameid;
+	}
+	search->size = gametable->size;
+	free(games);
+	
+	if (SEARCH_VERBOSE){
+		printf("%s.%d\t search_Build() Indexed %d names\n", __FILE__, __LINE__, search->size);
+	}
+	return SEARCH_OK;
+}
+
+int search_Narrow(searchindex_t *search, gametable_t *gametable, char *prefix, int *low, int *high){
+	/* Narrow a range of the search index to the games whose names start with prefix */
+	
+	// prefix: lower case search string.
+	// low, high: on entry a range of search->order that holds every match (0 and
+	//            search->size to search everything, or the range matched by a shorter
+	//            prefix); on exit the range of matches. Returns the number of matches.
+	// Both ends are found with a binary search, so each keystroke costs O(log n).
+	
+	int lo;
+	int hi;
+	int mid;
+	int first;
+	
+	// First name that is not before the prefix
+	lo = *low;
+	hi = *high;
+	while (lo < hi){
+		mid = lo + ((hi - lo) / 2);
+		if (comparePrefix(getGameid(search->order[mid], gametable)->name, prefix) < 0){
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	first = lo;
+	
+	// First name that is after the prefix
+	hi = *high;
+	while (lo < hi){
+		mid = lo + ((hi - lo) / 2);
+		if (comparePrefix(getGameid(search->order[mid], gametable)->name, prefix) <= 0){
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	
+	*low = first;
+	*high = lo;
+	if (SEARCH_VERBOSE){
+		printf("%s.%d\t search_Narrow() [%s] matches %d names\n", __FILE__, __LINE__, prefix, *high - *low);
+	}
+	return *high - *low;
+}
+
+static int trigramChar(unsigned char c){
+	// Return the trigram character code of a character, or -1 if it is ignored
+	
+	// Only letters and digits count, so "Cho Ren Sha" and "ChoRenSha68k"
+	// share the trigrams of "chorensha".
+	
+	if ((c >= '0') && (c <= '9')){
+		return c - '0';
+	}
+	c = tolower(c);
+	if ((c >= 'a') && (c <= 'z')){
+		return 10 + (c - 'a');
+	}
+	return -1;
+}
+
+static int getTrigrams(char *s, unsigned short *trigrams, int max){
+	// Fill trigrams with the trigram keys of a string, returning how many there are
+	
+	int i;
+	int n;
+	int c;
+	int seen;
+	int a;
+	int b;
+	
+	n = 0;
+	seen = 0;
+	a = 0;
+	b = 0;
+	for(i = 0; (s[i] != '\0') && (n < max); i++){
+		c = trigramChar((unsigned char) s[i]);
+		if (c >= 0){
+			if (seen >= 2){
+				trigrams[n] = (a * SEARCH_TRIGRAM_CHARS * SEARCH_TRIGRAM_CHARS) + (b * SEARCH_TRIGRAM_CHARS) + c;
+				n++;
+			}
+			a = b;
+			b = c;
+			seen++;
+		}
+	}
+	return n;
+}
+
+static int compareLong(const void *op1, const void *op2){
+	// Order two unsigned longs
+	
+	unsigned long a;
+	unsigned long b;
+	
+	a = *(const unsigned long *) op1;
+	b = *(const unsigned long *) op2;
+	if (a < b){
+		return -1;
+	}
+	if (a > b){
+		return 1;
+	}
+	return 0;
+}
+
+void search_InitTrigrams(trigramindex_t *trigrams){
+	/* Set up an empty trigram index */
+	
+	trigrams->keys_size = 0;
+	trigrams->keys = NULL;
+	trigrams->offsets = NULL;
+	trigrams->postings_size = 0;
+	trigrams->postings = NULL;
+}
+
+void search_FreeTrigrams(trigramindex_t *trigrams){
+	/* Free the trigram index */
+	
+	if (trigrams->keys != NULL){
+		free(trigrams->keys);
+	}
+	if (trigrams->offsets != NULL){
+		free(trigrams->offsets);
+	}
+	if (trigrams->postings != NULL){
+		free(trigrams->postings);
+	}
+	search_InitTrigrams(trigrams);
+}
+
+int search_BuildTrigrams(trigramindex_t *trigrams, gametable_t *gametable){
+	/* Build the trigram index from the name and directory name of every game */
+	
+	// With preload_names the name is the realname from launch.dat, so both
+	// the realname and the directory name can be found. Every (trigram, gameid)
+	// pair is packed into one unsigned long and sorted, which leaves the
+	// postings of each trigram together and in gameid order.
+	
+	int i;
+	int j;
+	int n;
+	long pairs_size;
+	long p;
+	unsigned long *pairs;
+	unsigned long key;
+	unsigned short keys[MAX_NAME_SIZE + MAX_PATH_SIZE];
+	gamedata_t *gamedata;
+	
+	search_FreeTrigrams(trigrams);
+	if (gametable->size < 1){
+		return SEARCH_OK;
+	}
+	if (gametable->ids_size > 0xFFFF){
+		return SEARCH_ERR_SIZE;
+	}
+	
+	// Room for every trigram of every name and directory
+	pairs_size = 0;
+	for(i = 0; i < gametable->size; i++){
+		gamedata = &gametable->games[i];
+		pairs_size += strlen(gamedata->name);
+		if (gamedata->dir != gamedata->name){
+			pairs_size += strlen(gamedata->dir);
+		}
+	}
+	pairs = (unsigned long *) malloc((pairs_size + 1) * sizeof(unsigned long));
+	if (pairs == NULL){
+		return SEARCH_ERR_MEM;
+	}
+	
+	p = 0;
+	for(i = 0; i < gametable->size; i++){
+		gamedata = &gametable->games[i];
+		n = getTrigrams(gamedata->name, keys, MAX_NAME_SIZE);
+		if (gamedata->dir != gamedata->name){
+			n += getTrigrams(gamedata->dir, keys + n, MAX_PATH_SIZE);
+		}
+		for(j = 0; j < n; j++){
+			pairs[p] = ((unsigned long) keys[j] << 16) | (unsigned long) gamedata->gameid;
+			p++;
+		}
+	}
+	qsort(pairs, p, sizeof(unsigned long), compareLong);
+	
+	// Drop repeats of the same trigram in the same game, and count the distinct trigrams
+	n = 0;
+	j = 0;
+	for(i = 0; i < p; i++){
+		if ((j == 0) || (pairs[i] != pairs[j - 1])){
+			if ((j == 0) || ((pairs[i] >> 16) != (pairs[j - 1] >> 16))){
+				n++;
+			}
+			pairs[j] = pairs[i];
+			j++;
+		}
+	}
+	p = j;
+	
+	trigrams->keys = (unsigned short *) malloc((n + 1) * sizeof(unsigned short));
+	trigrams->offsets = (long *) malloc((n + 1) * sizeof(long));
+	trigrams->postings = (unsigned short *) malloc((p + 1) * sizeof(unsigned short));
+	if ((trigrams->keys == NULL) || (trigrams->offsets == NULL) || (trigrams->postings == NULL)){
+		free(pairs);
+		search_FreeTrigrams(trigrams);
+		return SEARCH_ERR_MEM;
+	}
+	j = 0;
+	for(i = 0; i < p; i++){
+		key = pairs[i] >> 16;
+		if ((j == 0) || (key != trigrams->keys[j - 1])){
+			trigrams->keys[j] = key;
+			trigrams->offsets[j] = i;
+			j++;
+		}
+		trigrams->postings[i] = pairs[i] & 0xFFFF;
+	}
+	trigrams->offsets[n] = p;
+	trigrams->keys_size = n;
+	trigrams->postings_size = p;
+	free(pairs);
+	
+	if (SEARCH_VERBOSE){
+		printf("%s.%d\t search_BuildTrigrams() %d trigrams, %ld postings, %ld bytes\n", __FILE__, __LINE__, n, p, (long)((n * (sizeof(unsigned short) + sizeof(long))) + (p * sizeof(unsigned short))));
+	}
+	return SEARCH_OK;
+}
+
+static int findTrigram(trigramindex_t *trigrams, unsigned short key){
+	// Binary search for a trigram, returning its position in keys or -1
+	
+	int lo;
+	int hi;
+	int mid;
+	
+	lo = 0;
+	hi = trigrams->keys_size;
+	while (lo < hi){
+		mid = lo + ((hi - lo) / 2);
+		if (trigrams->keys[mid] < key){
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	if ((lo < trigrams->keys_size) && (trigrams->keys[lo] == key)){
+		return lo;
+	}
+	return -1;
+}
+
+int search_Fuzzy(trigramindex_t *trigrams, gametable_t *gametable, char *query, int *results, int max){
+	/* Find up to max games whose names share the most trigrams with query, best first */
+	
+	// A game must share at least half of the trigrams of the query. The rarest
+	// trigrams are read first, and no more than SEARCH_FUZZY_BUDGET postings are
+	// read in all, so a search takes a bounded time however many games there are.
+	// Ties go to the shorter name. Returns the number of gameids in results.
+	
+	int i;
+	int j;
+	int k;
+	int n;
+	int t;
+	int found;
+	int gameid;
+	int positions[MAX_NAME_SIZE];
+	unsigned short keys[MAX_NAME_SIZE];
+	unsigned char *score;
+	long budget;
+	long o;
+	
+	n = getTrigrams(query, keys, MAX_NAME_SIZE);
+	if ((n == 0) || (trigrams->keys_size == 0) || (max < 1)){
+		return 0;
+	}
+	
+	// Distinct trigrams of the query that exist in the index, rarest first
+	t = 0;
+	for(i = 0; i < n; i++){
+		k = findTrigram(trigrams, keys[i]);
+		for(j = 0; j < t; j++){
+			if (positions[j] == k){
+				k = -1;
+			}
+		}
+		if (k >= 0){
+			j = t;
+			while ((j > 0) && ((trigrams->offsets[positions[j - 1] + 1] - trigrams->offsets[positions[j - 1]]) > (trigrams->offsets[k + 1] - trigrams->offsets[k]))){
+				positions[j] = positions[j - 1];
+				j--;
+			}
+			positions[j] = k;
+			t++;
+		}
+	}
+	
+	score = (unsigned char *) calloc(gametable->ids_size + 1, sizeof(unsigned char));
+	if (score == NULL){
+		return 0;
+	}
+	budget = SEARCH_FUZZY_BUDGET;
+	for(i = 0; (i < t) && (budget > 0); i++){
+		for(o = trigrams->offsets[positions[i]]; (o < trigrams->offsets[positions[i] + 1]) && (budget > 0); o++){
+			gameid = trigrams->postings[o];
+			if ((gameid < gametable->ids_size) && (score[gameid] < 255)){
+				score[gameid]++;
+			}
+			budget--;
+		}
+	}
+	
+	// Keep the best max games, in order
+	found = 0;
+	for(gameid = 0; gameid < gametable->ids_size; gameid++){
+		if ((score[gameid] > 0) && ((score[gameid] * 2) >= n) && (getGameid(gameid, gametable) != NULL)){
+			j = found;
+			if (j == max){
+				j--;
+				if ((score[results[j]] > score[gameid]) || ((score[results[j]] == score[gameid]) && (strlen(getGameid(results[j], gametable)->name) <= strlen(getGameid(gameid, gametable)->name)))){
+					continue;
+				}
+			} else {
+				found++;
+			}
+			while ((j > 0) && ((score[results[j - 1]] < score[gameid]) || ((score[results[j - 1]] == score[gameid]) && (strlen(getGameid(results[j - 1], gametable)->name) > strlen(getGameid(gameid, gametable)->name))))){
+				results[j] = results[j - 1];
+				j--;
+			}
+			results[j] = gameid;
+		}
+	}
+	free(score);
+	
+	if (SEARCH_VERBOSE){
+		printf("%s.%d\t search_Fuzzy() [%s] %d trigrams, %ld postings read, %d results\n", __FILE__, __LINE__, query, t, SEARCH_FUZZY_BUDGET - budget, found);
+	}
+	return found;
+}
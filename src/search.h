@@ -0,0 +1,40 @@
+/* search.h, Type-ahead game name search for x68Launcher.
+ Copyright (C) 2020  John Snowdon
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __HAS_DATA
+#include "data.h"
+#define __HAS_DATA
+#endif
+
+#define SEARCH_VERBOSE		0		// Enable/disable search verbose/debug output
+#define SEARCH_TRIGRAM_CHARS	36		// Characters a trigram is made of: 0-9 and a-z
+#define SEARCH_FUZZY_BUDGET	20000	// Most postings one fuzzy search will read, bounding how long it takes
+
+// Return codes
+#define SEARCH_OK			0
+#define SEARCH_ERR_MEM		-1		// Unable to allocate memory
+#define SEARCH_ERR_SIZE		-2		// Too many games for a trigram index
+
+// Function prototypes
+void	search_Init(searchindex_t *search);
+int		search_Build(searchindex_t *search, gametable_t *gametable);
+void	search_Free(searchindex_t *search);
+int		search_Narrow(searchindex_t *search, gametable_t *gametable, char *prefix, int *low, int *high);
+void	search_InitTrigrams(trigramindex_t *trigrams);
+void	search_FreeTrigrams(trigramindex_t *trigrams);
+int		search_BuildTrigrams(trigramindex_t *trigrams, gametable_t *gametable);
+int		search_Fuzzy(trigramindex_t *trigrams, gametable_t *gametable, char *query, int *results, int max);
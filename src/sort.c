@@ -0,0 +1,347 @@
+/* sort.c, Alternative browser orders of the game list for x68Launcher.
+ Copyright (C) 2020  John Snowdon
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <dos.h>
+
+#ifndef __HAS_DATA
+#include "data.h"
+#define __HAS_DATA
+#endif
+#include "meta.h"
+#include "sort.h"
+#include "collate.h"
+
+// qsort() has no way to pass the keys to the compare functions, so they are
+// pointed at these while sorting.
+static unsigned short *sort_keys = NULL;
+static unsigned char *sort_strings = NULL;
+
+static int compareKeys(const void *op1, const void *op2){
+	// Order two gameids by their sort key, then by gameid - which is name order
+	
+	// Falling back to the gameid makes the sort stable with respect to name,
+	// so games with the same year, company etc. are still listed alphabetically.
+	
+	unsigned short a;
+	unsigned short b;
+	
+	a = *(const unsigned short *) op1;
+	b = *(const unsigned short *) op2;
+	if (sort_keys[a] != sort_keys[b]){
+		return (sort_keys[a] < sort_keys[b]) ? -1 : 1;
+	}
+	return (a < b) ? -1 : (a > b);
+}
+
+static int compareStrings(const void *op1, const void *op2){
+	// Order two interned string ids by the collate_Key() of their text
+	
+	return memcmp(sort_strings + (*(const unsigned short *) op1 * COLLATE_KEY_SIZE), sort_strings + (*(const unsigned short *) op2 * COLLATE_KEY_SIZE), COLLATE_KEY_SIZE);
+}
+
+static void loadRecent(gametable_t *gametable, unsigned short *keys){
+	// Set the key of each game listed in RECENTFILE to its place in the file, most recent first
+	
+	FILE *f;
+	int i;
+	int len;
+	char path[MAX_PATH_SIZE + 2];
+	pathindex_t pathindex;
+	gamedata_t *gamedata;
+	
+	f = fopen(RECENTFILE, "r");
+	if (f == NULL){
+		// Nothing has been played yet
+		return;
+	}
+	if (indexGamedataPaths(gametable, &pathindex) < 1){
+		fclose(f);
+		return;
+	}
+	i = 0;
+	while ((i < SORT_RECENT_MAX) && (fgets(path, sizeof(path), f) != NULL)){
+		len = strlen(path);
+		while ((len > 0) && ((path[len - 1] == '\n') || (path[len - 1] == '\r'))){
+			len--;
+			path[len] = '\0';
+		}
+		gamedata = findGamedataPath(&pathindex, path);
+		if ((gamedata != NULL) && (gamedata->gameid >= 0) && (gamedata->gameid < gametable->sort.size) && (keys[gamedata->gameid] == SORT_LAST)){
+			keys[gamedata->gameid] = i;
+		}
+		i++;
+	}
+	removePathindex(&pathindex);
+	fclose(f);
+}
+
+void sort_Init(sortindex_t *sort){
+	/* Set up an empty sort index */
+	
+	sort->orders = NULL;
+	sort->size = 0;
+}
+
+void sort_Free(sortindex_t *sort){
+	/* Free the sort index; it will be built again the next time it is needed */
+	
+	if (sort->orders != NULL){
+		free(sort->orders);
+	}
+	sort_Init(sort);
+}
+
+int sort_Build(sortindex_t *sort, gametable_t *gametable){
+	/* Build every alternative order of the games, from the metadata index and RECENTFILE */
+	
+	// The metadata of every game should already have been read with meta_LoadAll().
+	// Each order is a permutation of 2 byte gameids, so once built, changing
+	// order is just a matter of listing games from a different permutation.
+	// Strings are ranked once up front, so sorting by company or genre compares
+	// integers rather than strings.
+	
+	int i;
+	int n;
+	int order;
+	unsigned short *perm;
+	unsigned short *keys;
+	unsigned short *ranks;
+	unsigned short *column;
+	metaindex_t *meta;
+	
+	meta = &gametable->meta;
+	n = meta->size;
+	sort_Free(sort);
+	if (n < 1){
+		return SORT_OK;
+	}
+	if ((n >= SORT_LAST) || (meta->strings_size >= SORT_LAST)){
+		return SORT_ERR_SIZE;
+	}
+	
+	sort->orders = (unsigned short *) malloc(SORT_MAX * n * sizeof(unsigned short));
+	keys = (unsigned short *) malloc(n * sizeof(unsigned short));
+	ranks = (unsigned short *) malloc((meta->strings_size + 1) * sizeof(unsigned short));
+	if ((sort->orders == NULL) || (keys == NULL) || (ranks == NULL)){
+		sort_Free(sort);
+		if (keys != NULL){
+			free(keys);
+		}
+		if (ranks != NULL){
+			free(ranks);
+		}
+		return SORT_ERR_MEM;
+	}
+	sort->size = n;
+	
+	// Rank of each interned string in the same order as names; the empty string sorts last.
+	// The keys array is borrowed to sort the string ids.
+	if (meta->strings_size > n){
+		perm = (unsigned short *) malloc(meta->strings_size * sizeof(unsigned short));
+	} else {
+		perm = keys;
+	}
+	if (perm == NULL){
+		free(keys);
+		free(ranks);
+		sort_Free(sort);
+		return SORT_ERR_MEM;
+	}
+	if (meta->strings_size > 1){
+		sort_strings = (unsigned char *) malloc(meta->strings_size * COLLATE_KEY_SIZE);
+		if (sort_strings == NULL){
+			if (perm != keys){
+				free(perm);
+			}
+			free(keys);
+			free(ranks);
+			sort_Free(sort);
+			return SORT_ERR_MEM;
+		}
+		for(i = 1; i < meta->strings_size; i++){
+			perm[i - 1] = i;
+			collate_Key(meta->strings[i], sort_strings + (i * COLLATE_KEY_SIZE));
+		}
+		qsort(perm, meta->strings_size - 1, sizeof(unsigned short), compareStrings);
+		free(sort_strings);
+		sort_strings = NULL;
+		for(i = 1; i < meta->strings_size; i++){
+			ranks[perm[i - 1]] = i - 1;
+		}
+	}
+	ranks[META_NONE] = SORT_LAST;
+	if (perm != keys){
+		free(perm);
+	}
+	
+	for(order = SORT_YEAR; order <= SORT_MAX; order++){
+		for(i = 0; i < n; i++){
+			keys[i] = SORT_LAST;
+		}
+		column = NULL;
+		if (order == SORT_YEAR){
+			for(i = 0; i < n; i++){
+				if ((meta->state[i] == META_STATE_LOADED) && (meta->year[i] > 0)){
+					keys[i] = meta->year[i];
+				}
+			}
+		}
+		if (order == SORT_PUBLISHER){
+			column = meta->publisher;
+		}
+		if (order == SORT_DEVELOPER){
+			column = meta->developer;
+		}
+		if (order == SORT_GENRE){
+			column = meta->genre;
+		}
+		if (column != NULL){
+			for(i = 0; i < n; i++){
+				if (meta->state[i] == META_STATE_LOADED){
+					keys[i] = ranks[column[i]];
+				}
+			}
+		}
+		if (order == SORT_RECENT){
+			loadRecent(gametable, keys);
+		}
+		
+		perm = sort->orders + ((order - 1) * n);
+		for(i = 0; i < n; i++){
+			perm[i] = i;
+		}
+		sort_keys = keys;
+		qsort(perm, n, sizeof(unsigned short), compareKeys);
+		sort_keys = NULL;
+	}
+	free(ranks);
+	free(keys);
+	
+	if (SORT_VERBOSE){
+		printf("%s.%d\t sort_Build() Built %d orders of %d games\n", __FILE__, __LINE__, SORT_MAX, n);
+	}
+	return SORT_OK;
+}
+
+int sort_List(sortindex_t *sort, int order, unsigned long *bits, int words, int *list){
+	/* Write the gameid of every game set in bits to list, in the given order; returns how many were written */
+	
+	// Name order, or an order that has not been built, lists games by gameid, which
+	// is name order anyway. bits may be NULL to list every game of a built order.
+	
+	int i;
+	int n;
+	int id;
+	unsigned short *perm;
+	
+	if ((order == SORT_NAME) || (order > SORT_MAX) || (sort->orders == NULL)){
+		if (bits == NULL){
+			return 0;
+		}
+		return meta_BitsetList(bits, words, list);
+	}
+	
+	perm = sort->orders + ((order - 1) * sort->size);
+	n = 0;
+	for(i = 0; i < sort->size; i++){
+		id = perm[i];
+		if ((bits == NULL) || (bits[id / META_BITSET_BITS] & (1UL << (id % META_BITSET_BITS)))){
+			list[n] = id;
+			n++;
+		}
+	}
+	return n;
+}
+
+char * sort_Name(int order){
+	/* Return the name of an order, for the status bar */
+	
+	switch(order){
+		case(SORT_YEAR):
+			return "Year";
+		case(SORT_PUBLISHER):
+			return "Publisher";
+		case(SORT_DEVELOPER):
+			return "Developer";
+		case(SORT_GENRE):
+			return "Genre";
+		case(SORT_RECENT):
+			return "Recently played";
+		default:
+			return "Name";
+	}
+}
+
+int sort_AddRecent(gamedata_t *gamedata){
+	/* Move a game to the top of RECENTFILE, as it is about to be played */
+	
+	// The file is a plain list of game paths, most recently played first,
+	// so it survives a rescan even though gameids may change.
+	
+	FILE *f;
+	int i;
+	int n;
+	int len;
+	int fd;
+	char path[MAX_PATH_SIZE];
+	char (*recent)[MAX_PATH_SIZE + 2];
+	
+	recent = malloc(SORT_RECENT_MAX * (MAX_PATH_SIZE + 2));
+	if (recent == NULL){
+		return SORT_ERR_MEM;
+	}
+	getGamedataPath(gamedata, path);
+	
+	// Read the existing list, dropping this game from wherever it was
+	n = 0;
+	f = fopen(RECENTFILE, "r");
+	if (f != NULL){
+		while ((n < SORT_RECENT_MAX - 1) && (fgets(recent[n], MAX_PATH_SIZE + 2, f) != NULL)){
+			len = strlen(recent[n]);
+			while ((len > 0) && ((recent[n][len - 1] == '\n') || (recent[n][len - 1] == '\r'))){
+				len--;
+				recent[n][len] = '\0';
+			}
+			if ((len > 0) && (strcmp(recent[n], path) != 0)){
+				n++;
+			}
+		}
+		fclose(f);
+	}
+	
+	_dos_delete(RECENTFILE);
+	fd = _dos_create(RECENTFILE, 0x8000);
+	if (fd < 0){
+		if (SORT_VERBOSE){
+			printf("%s.%d\t sort_AddRecent() Unable to create %s [status:%d]\n", __FILE__, __LINE__, RECENTFILE, fd);
+		}
+		free(recent);
+		return SORT_ERR_FILE;
+	}
+	_dos_fputs(path, fd);
+	_dos_fputs("\n", fd);
+	for(i = 0; i < n; i++){
+		_dos_fputs(recent[i], fd);
+		_dos_fputs("\n", fd);
+	}
+	_dos_close(fd);
+	free(recent);
+	return SORT_OK;
+}
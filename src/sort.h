@@ -0,0 +1,48 @@
+/* sort.h, Alternative browser orders of the game list for x68Launcher.
+ Copyright (C) 2020  John Snowdon
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __HAS_DATA
+#include "data.h"
+#define __HAS_DATA
+#endif
+
+#define SORT_VERBOSE		0		// Enable/disable sort verbose/debug output
+#define SORT_RECENT_MAX		50		// Most recently played games remembered in RECENTFILE
+#define SORT_LAST			0xFFFF	// Sort key of a game with no year, company, genre etc.
+
+// Orders the browser can show, cycled through in turn
+#define SORT_NAME			0		// Game ids are already in name order, so this needs no permutation
+#define SORT_YEAR			1
+#define SORT_PUBLISHER		2
+#define SORT_DEVELOPER		3
+#define SORT_GENRE			4
+#define SORT_RECENT			5
+#define SORT_MAX			5
+
+// Return codes
+#define SORT_OK				0
+#define SORT_ERR_MEM		-1		// Unable to allocate memory
+#define SORT_ERR_SIZE		-2		// Too many games for a 2 byte permutation
+#define SORT_ERR_FILE		-3		// Unable to write RECENTFILE
+
+// Function prototypes
+void	sort_Init(sortindex_t *sort);
+void	sort_Free(sortindex_t *sort);
+int		sort_Build(sortindex_t *sort, gametable_t *gametable);
+int		sort_List(sortindex_t *sort, int order, unsigned long *bits, int words, int *list);
+char	*sort_Name(int order);
+int		sort_AddRecent(gamedata_t *gamedata);
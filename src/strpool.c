@@ -0,0 +1,119 @@
+/* strpool.c, Compact string storage for x68Launcher.
+ Copyright (C) 2020  John Snowdon
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "strpool.h"
+
+void strpool_Init(strpool_t *pool){
+	/* Set up an empty string pool - nothing is allocated until the first string is added */
+	
+	pool->block = NULL;
+	pool->prefix_count = 0;
+	pool->strings = 0;
+	pool->shared = 0;
+	pool->bytes_used = 0;
+	pool->bytes_allocated = 0;
+}
+
+char * strpool_AddLength(strpool_t *pool, const char *s, int len){
+	/* Copy the first len characters of s into the pool, returning the stored string */
+	
+	// The returned pointer stays valid until strpool_Free() is called, as
+	// blocks are never moved or resized. Returns NULL if out of memory.
+	
+	char *p;
+	int size;
+	strpool_block_t *block;
+	
+	if ((pool->block == NULL) || ((pool->block->size - pool->block->used) < (len + 1))){
+		size = STRPOOL_BLOCK_SIZE;
+		if ((len + 1) > size){
+			size = len + 1;
+		}
+		block = (strpool_block_t *) malloc(sizeof(strpool_block_t) + size);
+		if (block == NULL){
+			if (STRPOOL_VERBOSE){
+				printf("%s.%d\t strpool_AddLength() Unable to allocate new block of %d bytes\n", __FILE__, __LINE__, size);
+			}
+			return NULL;
+		}
+		block->next = pool->block;
+		block->size = size;
+		block->used = 0;
+		pool->block = block;
+		pool->bytes_allocated += sizeof(strpool_block_t) + size;
+	}
+	
+	p = pool->block->data + pool->block->used;
+	memcpy(p, s, len);
+	p[len] = '\0';
+	pool->block->used += len + 1;
+	pool->bytes_used += len + 1;
+	pool->strings++;
+	return p;
+}
+
+char * strpool_Add(strpool_t *pool, const char *s){
+	/* Copy a string into the pool, returning the stored string */
+	
+	return strpool_AddLength(pool, s, strlen(s));
+}
+
+char * strpool_AddPrefix(strpool_t *pool, const char *s, int len){
+	/* Store the first len characters of s, re-using an identical earlier prefix if there is one */
+	
+	// Intended for the handful of path prefixes (e.g. A:\Games\) shared by
+	// every game in a search path, so a short linear search is all that is needed.
+	
+	int i;
+	char *p;
+	
+	for(i = pool->prefix_count - 1; i >= 0; i--){
+		if ((strncmp(pool->prefixes[i], s, len) == 0) && (pool->prefixes[i][len] == '\0')){
+			pool->shared++;
+			return pool->prefixes[i];
+		}
+	}
+	
+	p = strpool_AddLength(pool, s, len);
+	if ((p != NULL) && (pool->prefix_count < STRPOOL_MAX_PREFIXES)){
+		pool->prefixes[pool->prefix_count] = p;
+		pool->prefix_count++;
+	}
+	return p;
+}
+
+void strpool_Free(strpool_t *pool){
+	/* Free every block of the pool in one go, leaving it empty */
+	
+	strpool_block_t *block;
+	strpool_block_t *next;
+	
+	if (STRPOOL_VERBOSE){
+		printf("%s.%d\t strpool_Free() Freeing %d strings [%ld bytes]\n", __FILE__, __LINE__, pool->strings, pool->bytes_allocated);
+	}
+	block = pool->block;
+	while (block != NULL){
+		next = block->next;
+		free(block);
+		block = next;
+	}
+	strpool_Init(pool);
+}
@@ -0,0 +1,46 @@
+/* strpool.h, Compact string storage for x68Launcher.
+ Copyright (C) 2020  John Snowdon
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#define STRPOOL_BLOCK_SIZE		4096		// Size of each block of string storage
+#define STRPOOL_MAX_PREFIXES	32			// Number of distinct path prefixes that are shared
+#define STRPOOL_VERBOSE			0			// Enable/disable string pool verbose/debug output
+
+// A block of string storage; strings are packed end to end and never move
+typedef struct strpool_block {
+	struct strpool_block *next;			// Previously filled block
+	int size;							// Bytes available in data
+	int used;							// Bytes of data in use
+	char data[];						// The strings themselves
+} __attribute__((__packed__)) __attribute__((aligned (2))) strpool_block_t;
+
+// A pool of strings that are only ever freed all at once
+typedef struct strpool {
+	strpool_block_t *block;				// Block currently being filled, linked to all earlier blocks
+	char *prefixes[STRPOOL_MAX_PREFIXES];	// Strings added with strpool_AddPrefix(), for re-use
+	int prefix_count;					// Number of entries in prefixes
+	int strings;						// Number of strings stored
+	int shared;							// Number of strings that re-used an existing prefix
+	long bytes_used;					// Bytes of string data stored, including end-of-string
+	long bytes_allocated;				// Bytes allocated for blocks, including block headers
+} __attribute__((__packed__)) __attribute__((aligned (2))) strpool_t;
+
+// Function prototypes
+void	strpool_Init(strpool_t *pool);
+char *	strpool_Add(strpool_t *pool, const char *s);
+char *	strpool_AddLength(strpool_t *pool, const char *s, int len);
+char *	strpool_AddPrefix(strpool_t *pool, const char *s, int len);
+void	strpool_Free(strpool_t *pool);
@@ -25,6 +25,11 @@ long int xclock(){
 	return _dos_time_pr();
 }
 
+long int timers_Ticks(){
+	// Finer grained than xclock(), for timing things within one pass of the main loop
+	return clock();
+}
+
 void timers_Print(long int start, long int end, char* name, int enabled){
 	
 	if (enabled){
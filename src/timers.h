@@ -1,6 +1,8 @@
 
 #define ARTWORK_FIRE		1		// Artwork display fires after this amount of timeout after the last user input
+#define TIMERS_TICKS_MS(ms)	(((long int)(ms) * CLOCKS_PER_SEC) / 1000)	// Milliseconds as timers_Ticks()
 
 long int xclock();
+long int timers_Ticks();
 void timers_Print(long int start, long int end, char* name, int enabled);
 int timers_FireArt(long int last);
@@ -124,7 +124,7 @@ int ui_DisplayArtwork(FILE *screenshot_file, bmpdata_t *screenshot_bmp, bmpstate
 		if (state->has_images){
 		
 		// Construct full path of image
-		sprintf(msg, "%s\\%s", state->selected_game->path, imagefile->filename[imagefile->selected]);
+		sprintf(msg, "%s%s\\%s", state->selected_game->prefix, state->selected_game->dir, imagefile->filename[imagefile->selected]);
 		strcpy(state->selected_image, msg);
 		if (UI_VERBOSE){
 			printf("%s.%d\t ui_DisplayArtwork() Selected artwork [%d] filename [%s]\n", __FILE__, __LINE__, imagefile->selected, imagefile->filename[imagefile->selected]);
@@ -168,20 +168,20 @@ int ui_DisplayArtwork(FILE *screenshot_file, bmpdata_t *screenshot_bmp, bmpstate
 }
 
 int ui_DrawFilterPrePopup(state_t *state, int toggle){
-	// Draw a popup that allows the user to toggle filter mode between genre, series and off
+	// Draw a popup that allows the user to toggle filter mode between genre, series, company, tech specs, year and off
 	unsigned char i;
 	
 	// Draw drop-shadow
 	//gvramBoxFillTranslucent(ui_launch_popup_xpos + 10, ui_launch_popup_ypos + 10, ui_launch_popup_xpos + 10 + ui_launch_popup_width, ui_launch_popup_ypos + 10 + ui_launch_popup_height + 30, PALETTE_UI_DGREY);
 	
 	// Draw main box
-	gvramBoxFill(ui_launch_popup_xpos, ui_launch_popup_ypos, ui_launch_popup_xpos + ui_launch_popup_width, ui_launch_popup_ypos + ui_launch_popup_height + 90, PALETTE_UI_BLACK);
+	gvramBoxFill(ui_launch_popup_xpos, ui_launch_popup_ypos, ui_launch_popup_xpos + ui_launch_popup_width, ui_launch_popup_ypos + ui_launch_popup_height + 120, PALETTE_UI_BLACK);
 	
 	// Draw main box outline
-	gvramBox(ui_launch_popup_xpos, ui_launch_popup_ypos, ui_launch_popup_xpos + ui_launch_popup_width, ui_launch_popup_ypos + ui_launch_popup_height + 90, PALETTE_UI_LGREY);
+	gvramBox(ui_launch_popup_xpos, ui_launch_popup_ypos, ui_launch_popup_xpos + ui_launch_popup_width, ui_launch_popup_ypos + ui_launch_popup_height + 120, PALETTE_UI_LGREY);
 	
 	// Clear background text
-	for (i = 0; i < 12; i++){
+	for (i = 0; i < 14; i++){
 		tvramClear8x16(6, ui_launch_popup_ypos + (i * 16), 60);
 	}
 	
@@ -197,6 +197,8 @@ int ui_DrawFilterPrePopup(state_t *state, int toggle){
 	tvramPuts(9, ui_launch_popup_ypos + 129, ui_progress_font, "By Company");
 	// Tech specs filter text
 	tvramPuts(9, ui_launch_popup_ypos + 159, ui_progress_font, "By Technical Specs");
+	// Year filter text
+	tvramPuts(9, ui_launch_popup_ypos + 189, ui_progress_font, "By Year / Decade");
 	
 	// Toggle which entry is selected
 	if (toggle == 1){
@@ -214,51 +216,19 @@ int ui_DrawFilterPrePopup(state_t *state, int toggle){
 		state->selected_filter = FILTER_NONE;
 	}
 	
-	if (state->selected_filter == FILTER_NONE){
-		// none
-		gvramBitmap(ui_launch_popup_xpos + 10, ui_launch_popup_ypos + 35, ui_checkbox_bmp);
-		gvramBitmap(ui_launch_popup_xpos + 10, ui_launch_popup_ypos + 65, ui_checkbox_empty_bmp);
-		gvramBitmap(ui_launch_popup_xpos + 10, ui_launch_popup_ypos + 95, ui_checkbox_empty_bmp);
-		gvramBitmap(ui_launch_popup_xpos + 10, ui_launch_popup_ypos + 125, ui_checkbox_empty_bmp);
-		gvramBitmap(ui_launch_popup_xpos + 10, ui_launch_popup_ypos + 155, ui_checkbox_empty_bmp);
-	}
-	if (state->selected_filter == FILTER_GENRE){
-		// genre
-		gvramBitmap(ui_launch_popup_xpos + 10, ui_launch_popup_ypos + 35, ui_checkbox_empty_bmp);
-		gvramBitmap(ui_launch_popup_xpos + 10, ui_launch_popup_ypos + 65, ui_checkbox_bmp);
-		gvramBitmap(ui_launch_popup_xpos + 10, ui_launch_popup_ypos + 95, ui_checkbox_empty_bmp);
-		gvramBitmap(ui_launch_popup_xpos + 10, ui_launch_popup_ypos + 125, ui_checkbox_empty_bmp);
-		gvramBitmap(ui_launch_popup_xpos + 10, ui_launch_popup_ypos + 155, ui_checkbox_empty_bmp);
-	}
-	if (state->selected_filter == FILTER_SERIES){
-		// series
-		gvramBitmap(ui_launch_popup_xpos + 10, ui_launch_popup_ypos + 35, ui_checkbox_empty_bmp);
-		gvramBitmap(ui_launch_popup_xpos + 10, ui_launch_popup_ypos + 65, ui_checkbox_empty_bmp);
-		gvramBitmap(ui_launch_popup_xpos + 10, ui_launch_popup_ypos + 95, ui_checkbox_bmp);
-		gvramBitmap(ui_launch_popup_xpos + 10, ui_launch_popup_ypos + 125, ui_checkbox_empty_bmp);
-		gvramBitmap(ui_launch_popup_xpos + 10, ui_launch_popup_ypos + 155, ui_checkbox_empty_bmp);
-	}
-	if (state->selected_filter == FILTER_COMPANY){
-		// developer/company/publisher
-		gvramBitmap(ui_launch_popup_xpos + 10, ui_launch_popup_ypos + 35, ui_checkbox_empty_bmp);
-		gvramBitmap(ui_launch_popup_xpos + 10, ui_launch_popup_ypos + 65, ui_checkbox_empty_bmp);
-		gvramBitmap(ui_launch_popup_xpos + 10, ui_launch_popup_ypos + 95, ui_checkbox_empty_bmp);
-		gvramBitmap(ui_launch_popup_xpos + 10, ui_launch_popup_ypos + 125, ui_checkbox_bmp);
-		gvramBitmap(ui_launch_popup_xpos + 10, ui_launch_popup_ypos + 155, ui_checkbox_empty_bmp);
-	}
-	if (state->selected_filter == FILTER_TECH){
-		// developer/company/publisher
-		gvramBitmap(ui_launch_popup_xpos + 10, ui_launch_popup_ypos + 35, ui_checkbox_empty_bmp);
-		gvramBitmap(ui_launch_popup_xpos + 10, ui_launch_popup_ypos + 65, ui_checkbox_empty_bmp);
-		gvramBitmap(ui_launch_popup_xpos + 10, ui_launch_popup_ypos + 95, ui_checkbox_empty_bmp);
-		gvramBitmap(ui_launch_popup_xpos + 10, ui_launch_popup_ypos + 125, ui_checkbox_empty_bmp);
-		gvramBitmap(ui_launch_popup_xpos + 10, ui_launch_popup_ypos + 155, ui_checkbox_bmp);
+	// One checkbox per filter type, ticked for the one selected
+	for (i = FILTER_NONE; i <= FILTER_MAX; i++){
+		if (state->selected_filter == i){
+			gvramBitmap(ui_launch_popup_xpos + 10, ui_launch_popup_ypos + 35 + (i * 30), ui_checkbox_bmp);
+		} else {
+			gvramBitmap(ui_launch_popup_xpos + 10, ui_launch_popup_ypos + 35 + (i * 30), ui_checkbox_empty_bmp);
+		}
 	}
 	
 	return UI_OK;
 }
 
-int	ui_DrawConfirmPopup(state_t *state, gamedata_t *gamedata, launchdat_t *launchdat){
+int	ui_DrawConfirmPopup(state_t *state, gametable_t *gametable, launchdat_t *launchdat){
 	// Draw a confirmation box to start the game
 	
 	// Draw drop-shadow
@@ -337,6 +307,10 @@ int ui_DrawFilterPopup(state_t *state, int select, int redraw, int toggle){
 				sprintf(msg, "Select Company - Page %d/%d - Enter to confirm", state->current_filter_page + 1, state->available_filter_pages);
 				tvramPuts(5, 45, ui_progress_font, msg);
 			}
+			if (state->selected_filter == FILTER_YEAR){
+				sprintf(msg, "Select Year - Page %d/%d - Enter to confirm", state->current_filter_page + 1, state->available_filter_pages);
+				tvramPuts(5, 45, ui_progress_font, msg);
+			}
 		}
 		
 		// Move the selection through the on-screen choices
@@ -373,13 +347,13 @@ int ui_DrawFilterPopup(state_t *state, int select, int redraw, int toggle){
 		
 		// Loop through and print the list of choices on this page, highlighting the currently
 		// selected choice.
-		for(i=offset; i<MAXIMUM_FILTER_STRINGS; i++){
+		for(i=offset; (i < state->available_filter_strings) && (i < offset + MAXIMUM_FILTER_STRINGS_PER_PAGE); i++){
 			
 			// We may (probably are) be starting part way
 			// into the list of filter strings if we are on page > 1.
 			page_i = i - offset;
 			
-			if ((state->filter_strings[i] != NULL) && (strcmp(state->filter_strings[i], "") != 0)){
+			if (state->filter_strings[i] != NULL){
 			
 				// Column 1
 				if (page_i < MAXIMUM_FILTER_STRINGS_PER_COL){
@@ -392,12 +366,8 @@ int ui_DrawFilterPopup(state_t *state, int select, int redraw, int toggle){
 					}
 					// Only print the text if we are painting an entirely new window
 					if (redraw == 0){
-						if (strlen(state->filter_strings[i]) > 22){
-							sprintf(buf, "%.20s..", state->filter_strings[i]);
-							tvramPuts(4, 74 + (page_i * 25), ui_progress_font, buf);
-						} else {
-							tvramPuts(4, 74 + (page_i * 25), ui_progress_font, state->filter_strings[i]);
-						}
+						ui_FilterLabel(buf, state->filter_strings[i], state->filter_counts[i]);
+						tvramPuts(4, 74 + (page_i * 25), ui_progress_font, buf);
 					}
 				}
 				
@@ -412,12 +382,8 @@ int ui_DrawFilterPopup(state_t *state, int select, int redraw, int toggle){
 					}
 					// Only print the text if we are painting an entirely new window
 					if (redraw == 0){
-						if (strlen(state->filter_strings[i]) > 22){
-							sprintf(buf, "%.20s..", state->filter_strings[i]);
-							tvramPuts(17, 74 + (page_i * MAXIMUM_FILTER_STRINGS_PER_COL), ui_progress_font, buf);
-						} else {
-							tvramPuts(17, 74 + ((page_i - MAXIMUM_FILTER_STRINGS_PER_COL) * 25), ui_progress_font, state->filter_strings[i]);
-						}
+						ui_FilterLabel(buf, state->filter_strings[i], state->filter_counts[i]);
+						tvramPuts(17, 74 + ((page_i - MAXIMUM_FILTER_STRINGS_PER_COL) * 25), ui_progress_font, buf);
 					}
 				}
 			}
@@ -438,6 +404,7 @@ int ui_DrawMultiChoiceFilterPopup(state_t *state, int select, int redraw, int to
 	int page_i;
 	int status;
 	char msg[128]; // Title
+	char buf[32];
 	
 	if (redraw == 0){
 		
@@ -490,13 +457,13 @@ int ui_DrawMultiChoiceFilterPopup(state_t *state, int select, int redraw, int to
 	
 	// Loop through and print the list of choices on this page, highlighting the currently
 	// selected choice.
-	for(i=offset; i<MAXIMUM_FILTER_STRINGS; i++){
+	for(i=offset; (i < state->available_filter_strings) && (i < offset + MAXIMUM_FILTER_STRINGS_PER_PAGE); i++){
 		
 		// We may (probably are) be starting part way
 		// into the list of filter strings if we are on page > 1.
 		page_i = i - offset;
 		
-		if ((state->filter_strings[i] != NULL) && (strcmp(state->filter_strings[i], "") != 0)){
+		if (state->filter_strings[i] != NULL){
 		
 			// Column 1
 			if (page_i < MAXIMUM_FILTER_STRINGS_PER_COL){
@@ -514,7 +481,8 @@ int ui_DrawMultiChoiceFilterPopup(state_t *state, int select, int redraw, int to
 				}
 				// Only print the text if we are painting an entirely new window
 				if (redraw == 0){
-					tvramPuts(4, 70 + (page_i * 25), ui_progress_font, state->filter_strings[i]);
+					ui_FilterLabel(buf, state->filter_strings[i], state->filter_counts[i]);
+					tvramPuts(4, 70 + (page_i * 25), ui_progress_font, buf);
 				}
 			}
 			
@@ -534,7 +502,8 @@ int ui_DrawMultiChoiceFilterPopup(state_t *state, int select, int redraw, int to
 				}
 				// Only print the text if we are painting an entirely new window
 				if (redraw == 0){
-					tvramPuts(20, 70 + ((page_i - 11) * 25), ui_progress_font, state->filter_strings[i]);
+					ui_FilterLabel(buf, state->filter_strings[i], state->filter_counts[i]);
+					tvramPuts(20, 70 + ((page_i - 11) * 25), ui_progress_font, buf);
 				}
 			}
 		}
@@ -557,27 +526,31 @@ int ui_DrawHelpPopup(){
 	tvramPuts(40, 45, ui_progress_font, "Key controls:");
 	tvramPuts(40, 65, ui_progress_font, "- [F]      Bring up the game search/filter window");
 	tvramPuts(40, 85, ui_progress_font, "- [H]      Show this help text window");
-	tvramPuts(40, 105, ui_progress_font, "- [Q]      Quit the application");
-	tvramPuts(40, 125, ui_progress_font, "- [Space]  Select a filter in a multi-select filter window");
-	tvramPuts(40, 145, ui_progress_font, "- [Enter]  Confirm a filter choice or launch selected gameq");
-	tvramPuts(40, 165, ui_progress_font, "- [Esc]    Close the current window or Cancel a selection");
+	tvramPuts(40, 105, ui_progress_font, "- [O]      Sort games by name, year, company, genre or recently played");
+	tvramPuts(40, 125, ui_progress_font, "- [Q]      Quit the application");
+	tvramPuts(40, 145, ui_progress_font, "- [R]      Rescan game directories for new or changed games");
+	tvramPuts(40, 165, ui_progress_font, "- [S]      Search for a game by typing the start of its name");
+	tvramPuts(40, 185, ui_progress_font, "- [Space]  Select a filter in a multi-select filter window");
+	tvramPuts(40, 205, ui_progress_font, "- [Enter]  Confirm a filter choice or launch selected gameq");
+	tvramPuts(40, 225, ui_progress_font, "- [Esc]    Close the current window or Cancel a selection");
 	
 	// Filter help
-	tvramPuts(40, 200, ui_progress_font, "Search/Filter:");
-	tvramPuts(40, 220, ui_progress_font, "You can search your list of games by [Genre], [Series], [Company] or");
-	tvramPuts(40, 240, ui_progress_font, "by selecting one or more [Tech Specs] such as specific sound or audio");
-	tvramPuts(40, 260, ui_progress_font, "device. Your games must have metadata [launch.dat] for this to work.");
+	tvramPuts(40, 260, ui_progress_font, "Search/Filter:");
+	tvramPuts(40, 280, ui_progress_font, "You can search your list of games by [Genre], [Series], [Company] or");
+	tvramPuts(40, 300, ui_progress_font, "by selecting one or more [Tech Specs] such as specific sound or audio");
+	tvramPuts(40, 320, ui_progress_font, "device. Your games must have metadata [launch.dat] for this to work.");
+	tvramPuts(40, 340, ui_progress_font, "Filters of different types are combined; [No filter] clears them all.");
 	
 	// Launching help
-	tvramPuts(40, 295, ui_progress_font, "Game Browser:");
-	tvramPuts(40, 315, ui_progress_font, "[Up] & [Down] scrolls through the list of games on a page. [PageUp]");
-	tvramPuts(40, 335, ui_progress_font, "& [PageDown] jumps an entire page at a time. [Enter] launches the");
-	tvramPuts(40, 355, ui_progress_font, "currently selected game. [Left] & [Right] scrolls through artwork.");
+	tvramPuts(40, 375, ui_progress_font, "Game Browser:");
+	tvramPuts(40, 395, ui_progress_font, "[Up] & [Down] scrolls through the list of games on a page. [PageUp]");
+	tvramPuts(40, 415, ui_progress_font, "& [PageDown] jumps an entire page at a time. [Enter] launches the");
+	tvramPuts(40, 435, ui_progress_font, "currently selected game. [Left] & [Right] scrolls through artwork.");
 	
 	return UI_OK;
 }
 
-int	ui_DrawLaunchPopup(state_t *state, gamedata_t *gamedata, launchdat_t *launchdat, int toggle){
+int	ui_DrawLaunchPopup(state_t *state, gametable_t *gametable, launchdat_t *launchdat, int toggle){
 	// Draw the popup window that lets us select from the main or alternate start file
 	// in order to launch a game
 	
@@ -818,6 +791,24 @@ int ui_DrawTextPanel(int x, int y, int width){
 	return UI_OK;
 }
 
+int ui_FilterLabel(char *buf, char *name, int count){
+	// Format a filter choice and the number of games it matches, e.g. "Shooter (12)",
+	// shortening the name so that the whole label fits in UI_FILTER_LABEL_SIZE characters.
+	// buf must hold at least UI_FILTER_LABEL_SIZE + 1 characters.
+	
+	char suffix[16];
+	int room;
+	
+	sprintf(suffix, " (%d)", count);
+	room = UI_FILTER_LABEL_SIZE - strlen(suffix);
+	if ((int)strlen(name) > room){
+		sprintf(buf, "%.*s..%s", room - 2, name, suffix);
+	} else {
+		sprintf(buf, "%s%s", name, suffix);
+	}
+	return UI_OK;
+}
+
 int ui_LoadAssets(){
 	/*
 	   Loads all user interface bitmap assets into global bmpdata_t structures
@@ -1229,40 +1220,21 @@ int ui_ReselectCurrentGame(state_t *state){
 	// Simply updates the selected_gameid with whatever line / page is currently selected
 	// Should be called every time up/down/pageup/pagedown is detected whilst in browser pane
 	
-	int			startpos;		// Index of first displayable element of state->selected_items
-	int			endpos;		// Index to last displayable element of state->selected_items
-	int 			i;			// Loop counter
-	int			selected;		// Counter to match the selected_line number
-	int			gameid;		// ID of the current game we are iterating through in the selected_list
+	int			pos;			// Index of the selected line in state->selected_list
 	
-	// Don't allow startpos to go negative
-	startpos = (state->selected_page - 1) * ui_browser_max_lines;
-	if (startpos < 0){
-		startpos = 0;	
-	}
-	
-	// If we're on the last page, then make sure we only loop over the number of entries
-	// that are on this page... not just all 22
-	if ((startpos + ui_browser_max_lines) > state->selected_max){
-		endpos = state->selected_max;
-	} else {
-		endpos = startpos + ui_browser_max_lines;
+	// Don't allow pos to go negative
+	pos = ((state->selected_page - 1) * ui_browser_max_lines) + state->selected_line;
+	if (pos < 0){
+		pos = 0;	
 	}
 	
 	if (UI_VERBOSE){
-		printf("%s.%d\t ui_ReselectCurrentGame() Game: %d, endpos: %d, selected line: %d\n", __FILE__, __LINE__, startpos, endpos, state->selected_line);
+		printf("%s.%d\t ui_ReselectCurrentGame() Position: %d of %d, selected line: %d\n", __FILE__, __LINE__, pos, state->selected_max, state->selected_line);
 	}
 	
-	selected = 0;
-	for(i = startpos; i < endpos ; i++){
-		gameid = state->selected_list[i];
-		
-		// This is the current selected game
-		if (selected == state->selected_line){
-			state->selected_gameid = gameid;
-			return UI_OK;
-		}	
-		selected++;
+	// On the last page there may be fewer entries than lines
+	if (pos < state->selected_max){
+		state->selected_gameid = state->selected_list[pos];
 	}
 	
 	return UI_OK;
@@ -1310,7 +1282,7 @@ int ui_SwitchPane(state_t *state){
 	return UI_OK;
 }
 
-int ui_UpdateBrowserPane(state_t *state, gamedata_t *gamedata){
+int ui_UpdateBrowserPane(state_t *state, gametable_t *gametable){
 	// UPdate the contents of the game browser pane
 
 	// selected_list : contains the gameids that are in the currently filtered selection (e.g. ALL, shooter genre only, only by Konami, etc)
@@ -1318,7 +1290,6 @@ int ui_UpdateBrowserPane(state_t *state, gamedata_t *gamedata){
 	// selected_page : is the page (browser list can show 0 - x items per page) into the selected_list
 	// selected_line : is the line of the selected_page that is highlighted
 	
-	gamedata_t	*gamedata_head;	// Pointer to the start of the gamedata list, so we can restore it
 	gamedata_t	*selected_game;	// Gamedata object for the currently selected line
 	int			y;				// Vertical position offset for each row
 	int 			i;				// Loop counter
@@ -1352,15 +1323,13 @@ int ui_UpdateBrowserPane(state_t *state, gamedata_t *gamedata){
 	}
 	
 	// Display the entries for this page
-	gamedata_head = gamedata;
 	y = ui_browser_font_y_pos;
 	if (UI_VERBOSE){
 		printf("%s.%d\t ui_UpdateBrowserPane() Building browser menu [%d-%d]\n", __FILE__, __LINE__, startpos, endpos);
 	}
 	for(i = startpos; i < endpos ; i++){
-		gamedata = gamedata_head;
 		gameid = state->selected_list[i];
-		selected_game = getGameid(gameid, gamedata);
+		selected_game = getGameid(gameid, gametable);
 		if (UI_VERBOSE){
 			printf("%s.%d\t ui_UpdateBrowserPane() - Line %d: Game ID %d, %s\n", __FILE__, __LINE__, i, gameid, selected_game->name);
 		}
@@ -1372,7 +1341,6 @@ int ui_UpdateBrowserPane(state_t *state, gamedata_t *gamedata){
 		tvramPuts(ui_browser_font_x_pos + 1, y, ui_progress_font, msg);
 		y += ui_progress_font->height + 2;
 	}
-	gamedata = gamedata_head;
 	
 	return UI_OK;
 }
@@ -1402,7 +1370,7 @@ int ui_UpdateBrowserPaneStatus(state_t *state){
 	return UI_OK;
 }
 
-int ui_UpdateInfoPane(state_t *state, gamedata_t *gamedata, launchdat_t *launchdat){
+int ui_UpdateInfoPane(state_t *state, gametable_t *gametable, launchdat_t *launchdat){
 	// Draw the contents of the info panel with current selected game, current filter mode, etc
 	
 	// TO DO
@@ -1418,13 +1386,9 @@ int ui_UpdateInfoPane(state_t *state, gamedata_t *gamedata, launchdat_t *launchd
 	char		info_genre[16];
 	char		s1, s2;
 	
-	gamedata_t	*gamedata_head;	// Pointer to the start of the gamedata list, so we can restore it
 	gamedata_t	*selected_game;	// Gamedata object for the currently selected line
 	//launchdat_t	*launchdat;		// Metadata object representing the launch.dat file for this game
 	
-	// Store gamedata head
-	gamedata_head = gamedata;
-	
 	// Find the game data entry for this ID
 	//selected_game = getGameid(state->selected_gameid, gamedata);
 	
@@ -1451,7 +1415,7 @@ int ui_UpdateInfoPane(state_t *state, gamedata_t *gamedata, launchdat_t *launchd
 				// ======================
 				// Unable to load launch.dat	 from disk
 				// ======================
-				sprintf(status_msg, "ERROR: Unable to load metadata file: %s\%s", selected_game->path, GAMEDAT);
+				sprintf(status_msg, "ERROR: Unable to load metadata file: %s%s\%s", state->selected_game->prefix, state->selected_game->dir, GAMEDAT);
 				gvramBitmap(ui_checkbox_has_metadata_xpos, ui_checkbox_has_metadata_ypos, ui_checkbox_bmp);
 				gvramBitmap(ui_checkbox_has_metadata_startbat_xpos, ui_checkbox_has_metadata_startbat_ypos, ui_checkbox_empty_bmp);
 				gvramBitmap(ui_checkbox_has_images_xpos, ui_checkbox_has_images_ypos, ui_checkbox_empty_bmp);
@@ -1459,7 +1423,7 @@ int ui_UpdateInfoPane(state_t *state, gamedata_t *gamedata, launchdat_t *launchd
 				sprintf(info_year, "N/A");
 				sprintf(info_company, " N/A");
 				sprintf(info_genre, "N/A");
-				sprintf(info_path, " %s", state->selected_game->path);
+				sprintf(info_path, " %s%s", state->selected_game->prefix, state->selected_game->dir);
 			} else {
 				// ======================
 				// Loaded launch.dat from disk
@@ -1552,7 +1516,7 @@ int ui_UpdateInfoPane(state_t *state, gamedata_t *gamedata, launchdat_t *launchd
 				// Number of images/screenshots
 				
 				// Path
-				sprintf(info_path, " %s", state->selected_game->path);
+				sprintf(info_path, " %s%s", state->selected_game->prefix, state->selected_game->dir);
 				
 				if (UI_VERBOSE){
 					printf("%s.%d\t ui_UpdateInfoPane()  - game id #1: (%d)\n", __FILE__, __LINE__, state->selected_game->gameid);
@@ -1579,7 +1543,7 @@ int ui_UpdateInfoPane(state_t *state, gamedata_t *gamedata, launchdat_t *launchd
 			sprintf(info_year, "N/A");
 			sprintf(info_company, " N/A");
 			sprintf(info_genre, "N/A");
-			sprintf(info_path, " %s", state->selected_game->path);
+			sprintf(info_path, " %s%s", state->selected_game->prefix, state->selected_game->dir);
 			if (UI_VERBOSE){
 				printf("%s.%d\t ui_UpdateInfoPane()  - game id #1: (%d)\n", __FILE__, __LINE__, state->selected_game->gameid);
 				printf("%s.%d\t ui_UpdateInfoPane()  - game id #2: (%d)\n", __FILE__, __LINE__, state->selected_gameid);
@@ -1614,7 +1578,6 @@ int ui_UpdateInfoPane(state_t *state, gamedata_t *gamedata, launchdat_t *launchd
 	tvramPuts(ui_info_company_text_xpos, ui_info_company_text_ypos, ui_progress_font, info_company);
 	tvramPuts(ui_info_genre_text_xpos, ui_info_genre_text_ypos, ui_progress_font, info_genre);
 	tvramPuts(ui_info_path_text_xpos, ui_info_path_text_ypos, ui_progress_font, info_path);
-	gamedata = gamedata_head;
 	return UI_OK;
 	
 }
\ No newline at end of file
@@ -183,8 +183,11 @@
 #define FILTER_PRE_PANE			0x06
 #define FILTER_PANE				0x07
 #define HELP_PANE				0x08
+#define SEARCH_PANE				0x09
 #define PANE_MAX					0x08
 
+#define UI_FILTER_LABEL_SIZE		22		// Widest filter choice, in characters, including the game count
+
 // Colours
 uint16_t PALETTE_UI_BLACK;
 uint16_t PALETTE_UI_WHITE;
@@ -210,18 +213,19 @@ void		ui_Init();
 void		ui_Close();
 
 // These draw the basic UI elements
-int		ui_DrawConfirmPopup(state_t *state, gamedata_t *gamedata, launchdat_t *launchdat);
+int		ui_DrawConfirmPopup(state_t *state, gametable_t *gametable, launchdat_t *launchdat);
 int 		ui_DrawFilterPrePopup(state_t *state, int toggle);
 int 		ui_DrawFilterPopup(state_t *state, int select, int redraw, int toggle);
 int		ui_DrawHelpPopup();
 int		ui_DrawInfoBox();
-int		ui_DrawLaunchPopup(state_t *state, gamedata_t *gamedata, launchdat_t *launchdat, int toggle);
+int		ui_DrawLaunchPopup(state_t *state, gametable_t *gametable, launchdat_t *launchdat, int toggle);
 int		ui_DrawMainWindow();
 int		ui_DrawMultiChoiceFilterPopup(state_t *state, int select, int redraw, int toggle);
 int		ui_DrawSplash();
 int		ui_DrawSplashProgress();
 int		ui_DrawStatusBar();
 int		ui_DrawTextPanel(int x, int y, int width);
+int		ui_FilterLabel(char *buf, char *name, int count);
 
 // Asset loaders
 int		ui_LoadAssets();
@@ -238,6 +242,6 @@ int		ui_SwitchPane(state_t *state);
 int		ui_ReselectCurrentGame(state_t *state);
 
 // These refresh contents within the various UI elements
-int		ui_UpdateBrowserPane(state_t *state, gamedata_t *gamedata);
+int		ui_UpdateBrowserPane(state_t *state, gametable_t *gametable);
 int		ui_UpdateBrowserPaneStatus(state_t *state);
-int		ui_UpdateInfoPane(state_t *state, gamedata_t *gamedata, launchdat_t *launchdat);
+int		ui_UpdateInfoPane(state_t *state, gametable_t *gametable, launchdat_t *launchdat);
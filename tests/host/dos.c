@@ -0,0 +1,423 @@
+/* dos.c, Human68k DOS calls on a Linux host, for the x68Launcher host tests.
+ Copyright (C) 2020  John Snowdon
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "dos.h"
+
+#define DOSSHIM_DRIVES		26
+#define DOSSHIM_SEARCHES	8		// _dos_exfiles() searches that can be open at once
+#define DOSSHIM_PATH_SIZE	1024
+
+// Directory entries of an _dos_exfiles() search, returned in turn by _dos_exnfiles()
+typedef struct dosshim_search {
+	struct dos_exfilbuf *buffer;	// Buffer the search belongs to; NULL if the slot is free
+	char dir[DOSSHIM_PATH_SIZE];	// Host directory being listed
+	char **names;					// Matching names, in order
+	int size;
+	int next;
+	int attr;
+	long used;						// When the search was last started or continued
+} dosshim_search_t;
+
+dosshim_calls_t dosshim_calls;
+
+static char dosshim_root[DOSSHIM_PATH_SIZE];
+static int dosshim_drive;
+static char dosshim_dirs[DOSSHIM_DRIVES][DOSSHIM_PATH_SIZE];	// Current directory of each drive, "" or "GAMES\FOO"
+static dosshim_search_t dosshim_searches[DOSSHIM_SEARCHES];
+static long dosshim_used = 0;
+
+int dosshim_Init(const char *root){
+	/* Map drive letters to directories under root, with A: as the current drive */
+	
+	// Also changes the working directory of the process to A:\, so that files the
+	// launcher opens with fopen() and a relative path end up in the same place.
+	
+	char path[DOSSHIM_PATH_SIZE];
+	int i;
+	
+	strncpy(dosshim_root, root, DOSSHIM_PATH_SIZE - 1);
+	dosshim_drive = 0;
+	for(i = 0; i < DOSSHIM_DRIVES; i++){
+		dosshim_dirs[i][0] = '\0';
+	}
+	if (snprintf(path, sizeof(path), "%s/A", dosshim_root) >= (int) sizeof(path)){
+		return -1;
+	}
+	mkdir(dosshim_root, 0755);
+	mkdir(path, 0755);
+	dosshim_Reset();
+	return chdir(path);
+}
+
+void dosshim_Reset(){
+	/* Zero the call counters */
+	
+	memset(&dosshim_calls, 0, sizeof(dosshim_calls_t));
+}
+
+long dosshim_Total(){
+	/* Total number of DOS calls since the counters were last reset */
+	
+	return dosshim_calls.open + dosshim_calls.read + dosshim_calls.write + dosshim_calls.close + dosshim_calls.files + dosshim_calls.dir + dosshim_calls.other;
+}
+
+int dosshim_Path(const char *path, char *buffer){
+	/* Turn a Human68k path, e.g. "A:\Games\Foo" or "Foo\launch.dat", into a host path */
+	
+	// Returns the drive number of the path.
+	
+	int drive;
+	int size;
+	int i;
+	char *p;
+	
+	drive = dosshim_drive;
+	if ((path[0] != '\0') && (path[1] == ':')){
+		drive = toupper((unsigned char) path[0]) - 'A';
+		path += 2;
+	}
+	if ((path[0] == '\\') || (path[0] == '/')){
+		size = snprintf(buffer, DOSSHIM_PATH_SIZE, "%s/%c%s", dosshim_root, 'A' + drive, path);
+	} else if (dosshim_dirs[drive][0] != '\0'){
+		size = snprintf(buffer, DOSSHIM_PATH_SIZE, "%s/%c/%s/%s", dosshim_root, 'A' + drive, dosshim_dirs[drive], path);
+	} else {
+		size = snprintf(buffer, DOSSHIM_PATH_SIZE, "%s/%c/%s", dosshim_root, 'A' + drive, path);
+	}
+	if (size >= DOSSHIM_PATH_SIZE){
+		// Too long for the host; nothing can be found at an empty path
+		buffer[0] = '\0';
+		return drive;
+	}
+	for(p = buffer; *p != '\0'; p++){
+		if (*p == '\\'){
+			*p = '/';
+		}
+	}
+	// Drop any trailing slash, so that stat() sees the directory itself
+	i = strlen(buffer);
+	while ((i > 1) && (buffer[i - 1] == '/')){
+		buffer[i - 1] = '\0';
+		i--;
+	}
+	return drive;
+}
+
+int _dos_open(const char *path, int mode){
+	char host[DOSSHIM_PATH_SIZE];
+	struct stat st;
+	int f;
+	
+	dosshim_calls.open++;
+	dosshim_Path(path, host);
+	if (stat(host, &st) != 0){
+		return _DOSE_NOENT;
+	}
+	if (S_ISDIR(st.st_mode)){
+		return _DOSE_ISDIR;
+	}
+	f = open(host, (mode == 0) ? O_RDONLY : ((mode == 1) ? O_WRONLY : O_RDWR));
+	return (f < 0) ? _DOSE_NOENT : f;
+}
+
+int _dos_create(const char *path, int attr){
+	char host[DOSSHIM_PATH_SIZE];
+	int f;
+	
+	dosshim_calls.open++;
+	dosshim_Path(path, host);
+	f = open(host, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	return (f < 0) ? _DOSE_NODIR : f;
+}
+
+int _dos_close(int f){
+	dosshim_calls.close++;
+	if (f < 0){
+		return -1;
+	}
+	return close(f);
+}
+
+int _dos_read(int f, char *buffer, int size){
+	dosshim_calls.read++;
+	return read(f, buffer, size);
+}
+
+int _dos_write(int f, const char *buffer, int size){
+	dosshim_calls.write++;
+	return write(f, buffer, size);
+}
+
+int _dos_fputs(const char *s, int f){
+	dosshim_calls.write++;
+	return write(f, s, strlen(s));
+}
+
+int _dos_seek(int f, int offset, int mode){
+	dosshim_calls.other++;
+	return lseek(f, offset, mode);
+}
+
+int _dos_delete(const char *path){
+	char host[DOSSHIM_PATH_SIZE];
+	
+	dosshim_calls.other++;
+	dosshim_Path(path, host);
+	return (unlink(host) == 0) ? 0 : _DOSE_NOENT;
+}
+
+int _dos_chdir(const char *path){
+	char host[DOSSHIM_PATH_SIZE];
+	char dir[DOSSHIM_PATH_SIZE];
+	struct stat st;
+	int drive;
+	
+	dosshim_calls.dir++;
+	if (path[0] == '\0'){
+		return 0;
+	}
+	drive = dosshim_Path(path, host);
+	if ((stat(host, &st) != 0) || !S_ISDIR(st.st_mode)){
+		return _DOSE_NODIR;
+	}
+	// Keep the part of the host path below the drive directory, e.g. "Games/Foo"
+	if (snprintf(dir, sizeof(dir), "%s/%c", dosshim_root, 'A' + drive) >= (int) sizeof(dir)){
+		return _DOSE_NODIR;
+	}
+	if (strlen(host) > strlen(dir)){
+		strcpy(dosshim_dirs[drive], host + strlen(dir) + 1);
+	} else {
+		dosshim_dirs[drive][0] = '\0';
+	}
+	return 0;
+}
+
+int _dos_chgdrv(int drive){
+	dosshim_calls.dir++;
+	if ((drive >= 0) && (drive < DOSSHIM_DRIVES)){
+		dosshim_drive = drive;
+	}
+	return DOSSHIM_DRIVES;
+}
+
+int _dos_curdir(int drive, char *buffer){
+	// drive: 0 is the current drive, 1 is A: and so on
+	
+	char *p;
+	
+	dosshim_calls.dir++;
+	drive = (drive == 0) ? dosshim_drive : drive - 1;
+	strcpy(buffer, dosshim_dirs[drive]);
+	for(p = buffer; *p != '\0'; p++){
+		if (*p == '/'){
+			*p = '\\';
+		}
+	}
+	return 0;
+}
+
+int _dos_curdrv(void){
+	dosshim_calls.dir++;
+	return dosshim_drive;
+}
+
+static int compareNames(const void *op1, const void *op2){
+	return strcmp(*(char * const *) op1, *(char * const *) op2);
+}
+
+static int matchName(const char *pattern, const char *name){
+	/* Human68k names are not case sensitive; only the "*" and "*.*" wildcards are supported */
+	
+	if ((strcmp(pattern, "*") == 0) || (strcmp(pattern, "*.*") == 0)){
+		return 1;
+	}
+	return strcasecmp(pattern, name) == 0;
+}
+
+static int nextEntry(dosshim_search_t *search, struct dos_exfilbuf *buffer){
+	/* Fill in buffer with the next entry of a search that matches its attributes */
+	
+	char host[DOSSHIM_PATH_SIZE];
+	struct stat st;
+	struct tm *tm;
+	int is_dir;
+	int size;
+	
+	while (search->next < search->size){
+		size = snprintf(host, sizeof(host), "%s/%s", search->dir, search->names[search->next]);
+		search->next++;
+		if ((size >= (int) sizeof(host)) || (stat(host, &st) != 0)){
+			continue;
+		}
+		// Directories are only found when asked for; everything else is a normal file
+		is_dir = S_ISDIR(st.st_mode);
+		if ((is_dir && ((search->attr & 0x10) == 0)) || (!is_dir && ((search->attr & 0x27) == 0))){
+			continue;
+		}
+		strncpy(buffer->name, search->names[search->next - 1], sizeof(buffer->name) - 1);
+		buffer->name[sizeof(buffer->name) - 1] = '\0';
+		buffer->atr = is_dir ? 0x10 : 0x20;
+		buffer->filelen = st.st_size;
+		tm = localtime(&st.st_mtime);
+		buffer->date = ((tm->tm_year - 80) << 9) | ((tm->tm_mon + 1) << 5) | tm->tm_mday;
+		buffer->time = (tm->tm_hour << 11) | (tm->tm_min << 5) | (tm->tm_sec / 2);
+		return 0;
+	}
+	return _DOSE_NOENT;
+}
+
+int _dos_exfiles(struct dos_exfilbuf *buffer, const char *path, int attr){
+	char host[DOSSHIM_PATH_SIZE];
+	char pattern[DOSSHIM_PATH_SIZE];
+	char *p;
+	const char *name;
+	dosshim_search_t *search;
+	DIR *d;
+	struct dirent *entry;
+	int drive;
+	int i;
+	
+	dosshim_calls.files++;
+	
+	// Split the path into the directory to list and the name to match
+	name = strrchr(path, '\\');
+	if (name == NULL){
+		name = strrchr(path, ':');
+	}
+	if (name == NULL){
+		strcpy(pattern, "");
+		name = path;
+	} else {
+		strncpy(pattern, path, name - path + 1);
+		pattern[name - path + 1] = '\0';
+		name++;
+	}
+	drive = dosshim_Path(pattern, host);
+	
+	// Re-use the slot of an earlier search with the same buffer, or a free one
+	search = NULL;
+	for(i = 0; i < DOSSHIM_SEARCHES; i++){
+		if (dosshim_searches[i].buffer == buffer){
+			search = &dosshim_searches[i];
+			break;
+		}
+	}
+	for(i = 0; (i < DOSSHIM_SEARCHES) && (search == NULL); i++){
+		if (dosshim_searches[i].buffer == NULL){
+			search = &dosshim_searches[i];
+		}
+	}
+	
+	// Human68k keeps nothing of a search outside its buffer, so a search that is
+	// given up on, such as one only made to test a path, is never ended. Take over
+	// the one left longest, rather than one that is still being listed.
+	if (search == NULL){
+		search = &dosshim_searches[0];
+		for(i = 1; i < DOSSHIM_SEARCHES; i++){
+			if (dosshim_searches[i].used < search->used){
+				search = &dosshim_searches[i];
+			}
+		}
+	}
+	for(i = 0; i < search->size; i++){
+		free(search->names[i]);
+	}
+	free(search->names);
+	search->names = NULL;
+	search->size = 0;
+	search->next = 0;
+	search->attr = attr;
+	search->buffer = buffer;
+	dosshim_used++;
+	search->used = dosshim_used;
+	strcpy(search->dir, host);
+	
+	d = opendir(host);
+	if (d == NULL){
+		search->buffer = NULL;
+		return _DOSE_NODIR;
+	}
+	while ((entry = readdir(d)) != NULL){
+		if (!matchName(name, entry->d_name)){
+			continue;
+		}
+		search->names = (char **) realloc(search->names, (search->size + 1) * sizeof(char *));
+		search->names[search->size] = strdup(entry->d_name);
+		search->size++;
+	}
+	closedir(d);
+	
+	// Same order every time; "." and ".." sort first, as they are listed first on Human68k
+	qsort(search->names, search->size, sizeof(char *), compareNames);
+	
+	memset(buffer, 0, sizeof(struct dos_exfilbuf));
+	buffer->driveno = drive;
+	buffer->drive[0] = 'A' + drive;
+	buffer->drive[1] = ':';
+	
+	// Path of the directory being listed, relative to the drive; "\Games\"
+	p = host + strlen(dosshim_root) + 2;
+	snprintf(buffer->path, sizeof(buffer->path), "%s/", p);
+	for(p = buffer->path; *p != '\0'; p++){
+		if (*p == '/'){
+			*p = '\\';
+		}
+	}
+	if (buffer->path[0] != '\\'){
+		memmove(buffer->path + 1, buffer->path, sizeof(buffer->path) - 1);
+		buffer->path[0] = '\\';
+	}
+	return nextEntry(search, buffer);
+}
+
+int _dos_exnfiles(struct dos_exfilbuf *buffer){
+	int i;
+	
+	dosshim_calls.files++;
+	for(i = 0; i < DOSSHIM_SEARCHES; i++){
+		if (dosshim_searches[i].buffer == buffer){
+			dosshim_used++;
+			dosshim_searches[i].used = dosshim_used;
+			return nextEntry(&dosshim_searches[i], buffer);
+		}
+	}
+	return _DOSE_NOENT;
+}
+
+int _dos_files(struct dos_filbuf *buffer, const char *path, int attr){
+	struct dos_exfilbuf ex;
+	int status;
+	
+	status = _dos_exfiles(&ex, path, attr);
+	memcpy(buffer, &ex, sizeof(struct dos_filbuf));
+	return status;
+}
+
+int _dos_nfiles(struct dos_filbuf *buffer){
+	dosshim_calls.files++;
+	return _DOSE_NOENT;
+}
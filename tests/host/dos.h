@@ -0,0 +1,99 @@
+/* dos.h, Human68k DOS calls on a Linux host, for the x68Launcher host tests.
+ Copyright (C) 2020  John Snowdon
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Stands in for the toolchain's <dos.h> when the launcher sources are built for the
+// host. Drive letters map to directories under a root set by dosshim_Init(), so
+// "A:\Games\Foo" is <root>/A/Games/Foo. Every call is counted in dosshim_calls.
+
+#ifndef __HAS_DOSSHIM
+#define __HAS_DOSSHIM
+
+#define _DOSE_NOENT		-2			// File not found
+#define _DOSE_NODIR		-3			// Directory not found
+#define _DOSE_ISDIR		-21			// Attempt to open a directory
+
+struct dos_filbuf {
+	unsigned char searchatr;
+	unsigned char driveno;
+	unsigned long dirsec;
+	unsigned short dirlft;
+	unsigned short dirpos;
+	char filename[8];
+	char ext[3];
+	unsigned char atr;
+	unsigned short time;
+	unsigned short date;
+	unsigned int filelen;
+	char name[23];
+};
+
+struct dos_exfilbuf {
+	unsigned char searchatr;
+	unsigned char driveno;
+	unsigned long dirsec;
+	unsigned short dirlft;
+	unsigned short dirpos;
+	char filename[8];
+	char ext[3];
+	unsigned char atr;
+	unsigned short time;
+	unsigned short date;
+	unsigned int filelen;
+	char name[23];
+	char drive[2];
+	char path[65];
+	char unused[21];
+};
+
+// Number of calls made to each kind of DOS function
+typedef struct dosshim_calls {
+	long open;					// _dos_open() and _dos_create()
+	long read;					// _dos_read()
+	long write;					// _dos_write() and _dos_fputs()
+	long close;					// _dos_close()
+	long files;					// _dos_exfiles() and _dos_exnfiles()
+	long dir;					// _dos_chdir(), _dos_chgdrv(), _dos_curdir() and _dos_curdrv()
+	long other;					// Everything else
+} dosshim_calls_t;
+
+extern dosshim_calls_t dosshim_calls;
+
+// Shim functions
+int		dosshim_Init(const char *root);
+void	dosshim_Reset();
+long	dosshim_Total();
+int		dosshim_Path(const char *path, char *buffer);
+
+// Human68k DOS calls
+int		_dos_open(const char *path, int mode);
+int		_dos_create(const char *path, int attr);
+int		_dos_close(int f);
+int		_dos_read(int f, char *buffer, int size);
+int		_dos_write(int f, const char *buffer, int size);
+int		_dos_fputs(const char *s, int f);
+int		_dos_seek(int f, int offset, int mode);
+int		_dos_delete(const char *path);
+int		_dos_chdir(const char *path);
+int		_dos_chgdrv(int drive);
+int		_dos_curdir(int drive, char *buffer);
+int		_dos_curdrv(void);
+int		_dos_exfiles(struct dos_exfilbuf *buffer, const char *path, int attr);
+int		_dos_exnfiles(struct dos_exfilbuf *buffer);
+int		_dos_files(struct dos_filbuf *buffer, const char *path, int attr);
+int		_dos_nfiles(struct dos_filbuf *buffer);
+
+#endif
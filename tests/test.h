@@ -0,0 +1,328 @@
+/* test.h, Checks and timers shared by the x68Launcher host tests.
+ Copyright (C) 2020  John Snowdon
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Each test program is built on the host with the launcher sources and the DOS
+// shim in tests/host; see the test and bench targets of the Makefile. A program
+// run with "bench" as its argument also runs its (slower) benchmarks.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <utime.h>
+#include <sys/stat.h>
+#include <dos.h>
+
+#ifndef __HAS_DATA
+#include "data.h"
+#define __HAS_DATA
+#endif
+#include "fstools.h"
+#include "meta.h"
+#include "search.h"
+#include "sort.h"
+#include "filter.h"
+
+static int test_checks = 0;
+static int test_failures = 0;
+static int test_bench = 0;
+
+// Scratch launch.dat for scanGamedirs() to preload names into, as main() passes its own
+static hwdata_t test_scratch_hardware;
+static launchdat_t test_scratch;
+
+// Count a check, and report it if it fails
+#define TEST_CHECK(cond) do { \
+	test_checks++; \
+	if (!(cond)){ \
+		test_failures++; \
+		printf("%s.%d\t FAILED: %s\n", __FILE__, __LINE__, #cond); \
+	} \
+} while (0)
+
+static void test_Init(int argc, char **argv){
+	/* Pick up the command line; "bench" turns on the benchmarks */
+	
+	test_bench = (argc > 1) && (strcmp(argv[1], "bench") == 0);
+	test_scratch.hardware = &test_scratch_hardware;
+}
+
+static int test_Done(const char *name){
+	/* Print the result of a test program, returning its exit status */
+	
+	printf("%s: %d checks, %d failed\n", name, test_checks, test_failures);
+	return (test_failures == 0) ? 0 : 1;
+}
+
+static double test_Seconds(){
+	/* Monotonic time, for benchmarks */
+	
+	struct timespec ts;
+	
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + (ts.tv_nsec / 1e9);
+}
+
+static unsigned long test_random = 1;
+
+static int test_Random(int n){
+	/* Repeatable pseudo random number from 0 to n - 1 */
+	
+	test_random = (test_random * 1103515245UL) + 12345UL;
+	return (int)((test_random >> 16) % (unsigned long) n);
+}
+
+static void test_Name(char *buffer, int i){
+	/* A made up game name, such as "Cyber Blaster 12"; mostly distinct, with some repeats */
+	
+	static const char *first[] = { "Super", "Cyber", "Mega", "Star", "Dragon", "Space", "Night", "Final", "Galaxy", "Neo", "The", "Thunder" };
+	static const char *second[] = { "Blaster", "Force", "Quest", "Fighter", "Striker", "Knight", "Racer", "Wars", "Saga", "Zone", "Raid", "Hunter" };
+	
+	sprintf(buffer, "%s %s %d", first[(i * 7) % 12], second[(i / 12) % 12], i % 97);
+}
+
+static const char *test_genres[] = { "Shooter", "Action", "Puzzle", "RPG", "Racing", "Fighting", "Platform", "Adventure" };
+static const char *test_companies[] = { "Konami", "Capcom", "Hudson", "Sharp", "Taito", "Namco", "Enix", "Koei", "Falcom", "Sega" };
+
+static void test_Launchdat(launchdat_t *launchdat, int i){
+	/* The metadata of made up game i; a few games have no year, genre or publisher */
+	
+	hwdata_t *hardware;
+	
+	hardware = launchdat->hardware;
+	memset(launchdat, 0, sizeof(launchdat_t));
+	launchdat->hardware = hardware;
+	test_Name(launchdat->realname, i);
+	if ((i % 11) != 0){
+		strcpy(launchdat->genre, test_genres[i % 8]);
+	}
+	if ((i % 9) != 0){
+		launchdat->year = 1987 + (i % 13);
+	}
+	sprintf(launchdat->series, "Series %d", i % 20);
+	if ((i % 6) != 0){
+		strcpy(launchdat->publisher, test_companies[i % 10]);
+	}
+	strcpy(launchdat->developer, test_companies[(i / 10) % 10]);
+	strcpy(launchdat->start, "START.X");
+	strcpy(launchdat->alt_start, "CONFIG.X");
+	sprintf(launchdat->images, "SCR%d.BMP,SCR%dB.BMP", i, i);
+	launchdat->hardware->flags = 0;
+	if ((i % 5) == 0){
+		launchdat->hardware->flags |= META_HW_MIDI;
+	}
+	if ((i % 3) == 0){
+		launchdat->hardware->flags |= META_HW_FPU;
+	}
+	if ((i % 7) == 0){
+		launchdat->hardware->flags |= META_HW_CYBERSTICK;
+	}
+}
+
+static void test_LaunchDat(char *buffer, int i){
+	/* The text of the launch.dat of made up game i, as test_Launchdat() fills it in */
+	
+	launchdat_t launchdat;
+	hwdata_t hardware;
+	char year[16];
+	
+	launchdat.hardware = &hardware;
+	test_Launchdat(&launchdat, i);
+	year[0] = '\0';
+	if (launchdat.year != 0){
+		sprintf(year, "year=%d\r\n", launchdat.year);
+	}
+	sprintf(buffer, "[default]\r\nname=%s\r\ngenre=%s\r\n%sseries=%s\r\npublisher=%s\r\ndeveloper=%s\r\n"
+		"start=%s\r\nalt_start=%s\r\nimages=%s\r\nmidi_mpu=%d\r\n[misc]\r\nfpu=%d\r\ncyberstick=%d\r\n",
+		launchdat.realname, launchdat.genre, year, launchdat.series, launchdat.publisher, launchdat.developer,
+		launchdat.start, launchdat.alt_start, launchdat.images,
+		(hardware.flags & META_HW_MIDI) != 0, (hardware.flags & META_HW_FPU) != 0, (hardware.flags & META_HW_CYBERSTICK) != 0);
+}
+
+static void test_Metadata(gametable_t *gametable){
+	/* Index made up metadata for every game, without reading any launch.dat; game g gets that of test_Launchdat(g) */
+	
+	launchdat_t launchdat;
+	hwdata_t hardware;
+	int g;
+	
+	launchdat.hardware = &hardware;
+	for(g = 0; g < gametable->meta.size; g++){
+		test_Launchdat(&launchdat, g);
+		meta_Update(&gametable->meta, g, &launchdat);
+	}
+}
+
+#define TEST_PATH_SIZE 600
+
+static char test_root[512];
+
+static void test_Cleanup(){
+	/* Remove the directory tree made for the test */
+	
+	char cmd[TEST_PATH_SIZE];
+	
+	if (chdir("/") == 0){
+		snprintf(cmd, sizeof(cmd), "rm -rf %s", test_root);
+		if (system(cmd) != 0){
+			printf("Unable to remove %s\n", test_root);
+		}
+	}
+}
+
+static void test_Root(const char *name){
+	/* Make an empty tree for drive A: under /tmp, removed again at exit */
+	
+	snprintf(test_root, sizeof(test_root), "/tmp/x68test_%s_%d", name, (int) getpid());
+	dosshim_Init(test_root);
+	atexit(test_Cleanup);
+}
+
+static void test_HostPath(const char *path, char *buffer){
+	/* Host path of a path relative to the root of drive A:, or an empty string if it is too long */
+	
+	if (snprintf(buffer, TEST_PATH_SIZE, "%s/A/%s", test_root, path) >= TEST_PATH_SIZE){
+		buffer[0] = '\0';
+	}
+}
+
+static void test_WriteFile(const char *path, const char *text){
+	/* Write a file, relative to the root of drive A: */
+	
+	char host[TEST_PATH_SIZE];
+	FILE *f;
+	
+	test_HostPath(path, host);
+	f = fopen(host, "wb");
+	if (f != NULL){
+		fputs(text, f);
+		fclose(f);
+	}
+}
+
+static void test_SetTime(const char *path, long seconds){
+	/* Set the modification time of a file or directory, relative to the root of drive A: */
+	
+	// DOS times are to 2 seconds, so keep seconds even to get a different stamp
+	
+	char host[TEST_PATH_SIZE];
+	struct utimbuf t;
+	
+	test_HostPath(path, host);
+	t.actime = t.modtime = 946684800L + seconds;
+	utime(host, &t);
+}
+
+static void test_MakeGame(const char *dir, int i, int has_dat){
+	/* Make the directory of game i in a search path, with a launch.dat if asked for */
+	
+	char path[TEST_PATH_SIZE];
+	char host[TEST_PATH_SIZE];
+	char dat[1024];
+	
+	sprintf(path, "%s/GAME%04d", dir, i);
+	test_HostPath(path, host);
+	mkdir(host, 0755);
+	if (has_dat){
+		test_LaunchDat(dat, i);
+		strcat(path, "/" GAMEDAT);
+		test_WriteFile(path, dat);
+	}
+}
+
+static void test_MakeGames(const char *dir, int first, int n, int no_dat){
+	/* Make a search path with n games, numbered from first; every no_dat'th has no launch.dat */
+	
+	char host[TEST_PATH_SIZE];
+	int i;
+	
+	test_HostPath(dir, host);
+	mkdir(host, 0755);
+	for(i = first; i < first + n; i++){
+		test_MakeGame(dir, i, (no_dat == 0) || ((i % no_dat) != 0));
+	}
+	test_SetTime(dir, 0);
+}
+
+static void test_Config(config_t *config, gamedir_t *gamedir, const char *dirs, int preload_names){
+	/* Settings as launcher.ini would give them, with the search paths looked up as at startup */
+	
+	memset(config, 0, sizeof(config_t));
+	memset(gamedir, 0, sizeof(gamedir_t));
+	strcpy(config->dirs, dirs);
+	config->preload_names = preload_names;
+	config->metadata_cache = 16;
+	config->prefetch = 20;
+	getDirList(config, gamedir);
+}
+
+static void test_FreeConfig(config_t *config){
+	/* Free the list of search paths made by test_Config() */
+	
+	gamedir_t *gamedir;
+	gamedir_t *next;
+	
+	gamedir = config->dir;
+	if (gamedir == NULL){
+		return;
+	}
+	gamedir = gamedir->next;
+	while (gamedir != NULL){
+		next = gamedir->next;
+		free(gamedir);
+		gamedir = next;
+	}
+	config->dir->next = NULL;
+}
+
+static launchdat_t * test_NewLaunchdat(){
+	/* A zeroed launchdat_t, with its hardware data */
+	
+	launchdat_t *launchdat;
+	
+	launchdat = (launchdat_t *) calloc(1, sizeof(launchdat_t));
+	launchdat->hardware = (hwdata_t *) calloc(1, sizeof(hwdata_t));
+	return launchdat;
+}
+
+static void test_FreeLaunchdat(launchdat_t *launchdat){
+	free(launchdat->hardware);
+	free(launchdat);
+}
+
+static void test_Games(gametable_t *gametable, int n){
+	/* Fill an empty game table with n made up games, without touching the disk; sorted and indexed */
+	
+	char path[MAX_PATH_SIZE];
+	char name[MAX_NAME_SIZE];
+	gamedata_t *gamedata;
+	int i;
+	
+	for(i = 0; i < n; i++){
+		gamedata = addGamedata(gametable);
+		sprintf(path, "A:\\Games\\GAME%04d", i);
+		test_Name(name, i);
+		setGamedataPath(gametable, gamedata, path);
+		setGamedataName(gametable, gamedata, name);
+		gamedata->gameid = i;
+		gamedata->drive = 'A';
+		gamedata->has_dat = 1;
+	}
+	sortGamedata(gametable);
+	indexGamedata(gametable);
+}
@@ -0,0 +1,260 @@
+/* test_cache.c, Host tests of the cache of recently browsed launch.dat records for x68Launcher.
+ Copyright (C) 2020  John Snowdon
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "test.h"
+#include "cache.h"
+
+static int sameLaunchdat(launchdat_t *a, launchdat_t *b){
+	// Are two launchdat_t byte for byte the same, hardware flags included
+	
+	hwdata_t *hardware_a;
+	hwdata_t *hardware_b;
+	int same;
+	
+	hardware_a = a->hardware;
+	hardware_b = b->hardware;
+	a->hardware = NULL;
+	b->hardware = NULL;
+	same = (memcmp(a, b, sizeof(launchdat_t)) == 0) && (hardware_a->flags == hardware_b->flags);
+	a->hardware = hardware_a;
+	b->hardware = hardware_b;
+	return same;
+}
+
+static int referenceLookup(int *recent, int *size, int capacity, int gameid, int loaded){
+	// Reference LRU: recent holds the game ids cached, most recently used first; returns 1 for a hit
+	
+	int i;
+	int hit;
+	
+	for(i = 0; (i < *size) && (recent[i] != gameid); i++){
+	}
+	hit = (i < *size);
+	if (!hit){
+		// Only games whose launch.dat loaded are kept, pushing out the oldest
+		if (!loaded || (capacity < 1)){
+			return 0;
+		}
+		if (*size < capacity){
+			*size += 1;
+		}
+		i = *size - 1;
+	}
+	memmove(recent + 1, recent, i * sizeof(int));
+	recent[0] = gameid;
+	return hit;
+}
+
+static void testLRU(){
+	/* Lookups give what getLaunchdata() does, and hit or miss exactly as a reference LRU list */
+	
+	config_t config;
+	gamedir_t gamedir;
+	gametable_t gametable;
+	launchcache_t cache;
+	launchdat_t *launchdat;
+	launchdat_t *reference;
+	gamedata_t *gamedata;
+	int recent[CACHE_MAX_SIZE];
+	int recent_size;
+	int hits;
+	int status;
+	int same;
+	int lru;
+	int k;
+	
+	test_MakeGames("Cache", 0, 100, 10);
+	test_Config(&config, &gamedir, "A:\\Cache", 0);
+	initGametable(&gametable);
+	TEST_CHECK(scanGamedirs(&config, &gametable, NULL, &test_scratch, NULL, NULL) == 100);
+	
+	launchdat = test_NewLaunchdat();
+	reference = test_NewLaunchdat();
+	TEST_CHECK(cache_Init(&cache, 16) == CACHE_OK);
+	TEST_CHECK(cache.size == 16);
+	recent_size = 0;
+	hits = 0;
+	same = 1;
+	lru = 1;
+	for(k = 0; k < 5000; k++){
+		
+		// Mostly the games near the last one, as when scrolling
+		gamedata = &gametable.games[(k / 10 + test_Random(20)) % gametable.size];
+		status = cache_Get(&cache, gamedata, launchdat);
+		if ((status != getLaunchdata(gamedata, reference)) || ((status == 0) && !sameLaunchdat(launchdat, reference))){
+			same = 0;
+		}
+		if (referenceLookup(recent, &recent_size, cache.size, gamedata->gameid, status == 0)){
+			hits++;
+		}
+		if ((cache.hits != hits) || (cache.hits + cache.misses != k + 1)){
+			lru = 0;
+		}
+	}
+	TEST_CHECK(same);
+	TEST_CHECK(lru);
+	TEST_CHECK(cache.hits > cache.misses);
+	
+	// Looking for a record does not count as a lookup, and a clear forgets everything
+	k = cache.hits;
+	TEST_CHECK(cache_Find(&cache, recent[0]) != NULL);
+	TEST_CHECK(cache_Find(&cache, recent[0])->hardware == NULL);
+	TEST_CHECK(cache.hits == k);
+	cache_Clear(&cache);
+	TEST_CHECK(cache_Find(&cache, recent[0]) == NULL);
+	cache_Free(&cache);
+	
+	// A cache of no entries always reads from disk, and a huge one is limited
+	for(gamedata = gametable.games; gamedata->has_dat == 0; gamedata++){
+	}
+	TEST_CHECK(cache_Init(&cache, 0) == CACHE_OK);
+	dosshim_Reset();
+	for(k = 0; k < 10; k++){
+		cache_Get(&cache, gamedata, launchdat);
+	}
+	TEST_CHECK((cache.misses == 10) && (dosshim_calls.open == 10));
+	cache_Free(&cache);
+	TEST_CHECK(cache_Init(&cache, 10000) == CACHE_OK);
+	TEST_CHECK(cache.size == CACHE_MAX_SIZE);
+	cache_Free(&cache);
+	
+	test_FreeLaunchdat(launchdat);
+	test_FreeLaunchdat(reference);
+	removeGamedata(&gametable);
+	test_FreeConfig(&config);
+}
+
+static int browse(gametable_t *gametable, launchcache_t *cache, launchdat_t *launchdat){
+	/* Replay a browse, scrolling down and back up a line or a page at a time; returns the selections */
+	
+	// Each step of moves is a cursor movement: +1/-1 a line, +20/-20 a page
+	static const struct {
+		int move;
+		int times;
+	} moves[] = {
+		{ 1, 30 }, { -1, 12 }, { 1, 8 }, { -1, 20 }, { 20, 4 }, { -20, 2 }, { 1, 15 }, { -1, 15 },
+		{ 20, 3 }, { -1, 40 }, { 1, 25 }, { -20, 3 }, { 1, 10 }, { -1, 10 }, { 1, 10 }, { -1, 10 },
+	};
+	int selected;
+	int steps;
+	int i;
+	int j;
+	
+	selected = 0;
+	steps = 0;
+	for(i = 0; i < (int)(sizeof(moves) / sizeof(moves[0])); i++){
+		for(j = 0; j < moves[i].times; j++){
+			selected += moves[i].move;
+			if (selected < 0){
+				selected = 0;
+			}
+			if (selected >= gametable->size){
+				selected = gametable->size - 1;
+			}
+			cache_Get(cache, &gametable->games[selected], launchdat);
+			steps++;
+		}
+	}
+	return steps;
+}
+
+static void testBrowse(){
+	/* Disk reads saved on a typical browse, for a few sizes of cache */
+	
+	static const int sizes[] = { 0, 8, 16, 32 };
+	config_t config;
+	gamedir_t gamedir;
+	gametable_t gametable;
+	launchcache_t cache;
+	launchdat_t *launchdat;
+	int steps;
+	int reads[4];
+	int i;
+	
+	test_MakeGames("Browse", 0, 300, 0);
+	test_Config(&config, &gamedir, "A:\\Browse", 0);
+	initGametable(&gametable);
+	TEST_CHECK(scanGamedirs(&config, &gametable, NULL, &test_scratch, NULL, NULL) == 300);
+	
+	launchdat = test_NewLaunchdat();
+	for(i = 0; i < 4; i++){
+		cache_Init(&cache, sizes[i]);
+		dosshim_Reset();
+		steps = browse(&gametable, &cache, launchdat);
+		reads[i] = dosshim_calls.open;
+		TEST_CHECK(reads[i] == cache.misses);
+		cache_Free(&cache);
+	}
+	
+	// No cache reads every time; a bigger one never reads more
+	TEST_CHECK(reads[0] == steps);
+	TEST_CHECK((reads[1] < reads[0]) && (reads[2] <= reads[1]) && (reads[3] <= reads[2]));
+	printf("cache: browse of %d selections, launch.dat reads: %d without a cache, %d with 8 entries, %d with 16, %d with 32\n", steps, reads[0], reads[1], reads[2], reads[3]);
+	
+	test_FreeLaunchdat(launchdat);
+	removeGamedata(&gametable);
+	test_FreeConfig(&config);
+}
+
+static void benchCache(){
+	/* 100000 lookups of recently browsed games, from the cache against from disk */
+	
+	config_t config;
+	gamedir_t gamedir;
+	gametable_t gametable;
+	launchcache_t cache;
+	launchdat_t *launchdat;
+	double start;
+	double cache_time;
+	double disk_time;
+	int i;
+	
+	test_Config(&config, &gamedir, "A:\\Browse", 0);
+	initGametable(&gametable);
+	TEST_CHECK(scanGamedirs(&config, &gametable, NULL, &test_scratch, NULL, NULL) == 300);
+	
+	launchdat = test_NewLaunchdat();
+	cache_Init(&cache, 16);
+	start = test_Seconds();
+	for(i = 0; i < 100000; i++){
+		cache_Get(&cache, &gametable.games[i % 16], launchdat);
+	}
+	cache_time = test_Seconds() - start;
+	start = test_Seconds();
+	for(i = 0; i < 100000; i++){
+		getLaunchdata(&gametable.games[i % 16], launchdat);
+	}
+	disk_time = test_Seconds() - start;
+	TEST_CHECK(cache.misses == 16);
+	printf("cache: 100000 lookups of 16 games, %.4fs cached, %.4fs from disk\n", cache_time, disk_time);
+	
+	cache_Free(&cache);
+	test_FreeLaunchdat(launchdat);
+	removeGamedata(&gametable);
+	test_FreeConfig(&config);
+}
+
+int main(int argc, char **argv){
+	test_Init(argc, argv);
+	test_Root("cache");
+	testLRU();
+	testBrowse();
+	if (test_bench){
+		benchCache();
+	}
+	return test_Done("cache");
+}
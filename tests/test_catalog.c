@@ -0,0 +1,225 @@
+/* test_catalog.c, Host tests of the game catalog for x68Launcher.
+ Copyright (C) 2020  John Snowdon
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "test.h"
+#include "catalog.h"
+
+static int sameGames(gametable_t *a, gametable_t *b){
+	/* Check that two game tables hold the same games, in the same order */
+	
+	char path_a[MAX_PATH_SIZE];
+	char path_b[MAX_PATH_SIZE];
+	gamedata_t *ga;
+	gamedata_t *gb;
+	int same;
+	int i;
+	
+	if (a->size != b->size){
+		return 0;
+	}
+	same = 1;
+	for(i = 0; i < a->size; i++){
+		ga = &a->games[i];
+		gb = &b->games[i];
+		getGamedataPath(ga, path_a);
+		getGamedataPath(gb, path_b);
+		if ((ga->gameid != gb->gameid) || (ga->drive != gb->drive) || (strcmp(path_a, path_b) != 0) || (strcmp(ga->name, gb->name) != 0)){
+			same = 0;
+		}
+		if ((ga->has_dat != gb->has_dat) || (ga->dat_size != gb->dat_size) || (ga->stamp != gb->stamp)){
+			same = 0;
+		}
+		if (getGameid(ga->gameid, b) != gb){
+			same = 0;
+		}
+	}
+	return same;
+}
+
+static int sameTrigrams(trigramindex_t *a, trigramindex_t *b){
+	/* Check that two trigram indexes are identical */
+	
+	if ((a->keys_size != b->keys_size) || (a->postings_size != b->postings_size)){
+		return 0;
+	}
+	if (a->keys_size == 0){
+		return 1;
+	}
+	return (memcmp(a->keys, b->keys, a->keys_size * sizeof(unsigned short)) == 0)
+		&& (memcmp(a->offsets, b->offsets, (a->keys_size + 1) * sizeof(long)) == 0)
+		&& (memcmp(a->postings, b->postings, a->postings_size * sizeof(unsigned short)) == 0);
+}
+
+static void patchCatalog(long offset, const void *data, int size){
+	/* Overwrite part of the catalog file */
+	
+	char host[TEST_PATH_SIZE];
+	FILE *f;
+	
+	test_HostPath(CATALOGFILE, host);
+	f = fopen(host, "r+b");
+	fseek(f, offset, SEEK_SET);
+	fwrite(data, size, 1, f);
+	fclose(f);
+}
+
+static void testRoundTrip(){
+	/* Save a scanned game table, load it back and compare every field */
+	
+	config_t config;
+	gamedir_t gamedir;
+	gametable_t scanned;
+	gametable_t loaded;
+	catalog_header_t header;
+	unsigned short posting;
+	long trigrams;
+	long offset;
+	int changed;
+	int status;
+	int blocks;
+	
+	test_MakeGames("Games", 0, 300, 3);
+	test_MakeGames("More", 300, 40, 0);
+	test_Config(&config, &gamedir, "A:\\Games,A:\\More", 1);
+	
+	initGametable(&scanned);
+	status = scanGamedirs(&config, &scanned, NULL, &test_scratch, NULL, NULL);
+	TEST_CHECK(status == 340);
+	TEST_CHECK(scanned.trigrams.keys_size > 0);
+	
+	// Header, records in blocks, then the three arrays of the trigram index
+	dosshim_Reset();
+	status = catalog_Save(&config, &scanned);
+	TEST_CHECK(status == 340);
+	blocks = (340 + CATALOG_SAVE_RECORDS - 1) / CATALOG_SAVE_RECORDS;
+	TEST_CHECK(dosshim_calls.write == 1 + blocks + 3);
+	
+	initGametable(&loaded);
+	dosshim_Reset();
+	status = catalog_Load(&config, &loaded, &changed);
+	TEST_CHECK(status == 340);
+	TEST_CHECK(changed == 0);
+	TEST_CHECK(dosshim_calls.read == 5);
+	TEST_CHECK(sameGames(&scanned, &loaded));
+	TEST_CHECK(sameTrigrams(&scanned.trigrams, &loaded.trigrams));
+	removeGamedata(&loaded);
+	
+	// A new game makes its search path stale, but nothing else
+	test_MakeGame("More", 340, 1);
+	test_SetTime("More", 10);
+	gamedir.next->next->stamp = dirStamp("A:\\More");
+	status = catalog_Load(&config, &loaded, &changed);
+	TEST_CHECK(status == 340);
+	TEST_CHECK(changed == 1);
+	removeGamedata(&loaded);
+	
+	// Different settings
+	config.preload_names = 0;
+	TEST_CHECK(catalog_Load(&config, &loaded, &changed) == CATALOG_ERR_CONFIG);
+	removeGamedata(&loaded);
+	config.preload_names = 1;
+	strcpy(config.dirs, "A:\\Games");
+	TEST_CHECK(catalog_Load(&config, &loaded, &changed) == CATALOG_ERR_CONFIG);
+	removeGamedata(&loaded);
+	strcpy(config.dirs, "A:\\Games,A:\\More");
+	
+	// Written by another version
+	memset(&header, 0, sizeof(catalog_header_t));
+	header.version = CATALOG_VERSION + 1;
+	patchCatalog(sizeof(header.magic), &header.version, sizeof(header.version));
+	TEST_CHECK(catalog_Load(&config, &loaded, &changed) == CATALOG_ERR_VERSION);
+	removeGamedata(&loaded);
+	
+	// Cut short in the middle of the records
+	TEST_CHECK(catalog_Save(&config, &scanned) == 340);
+	{
+		char host[TEST_PATH_SIZE];
+		
+		test_HostPath(CATALOGFILE, host);
+		TEST_CHECK(truncate(host, sizeof(catalog_header_t) + (100 * sizeof(catalog_record_t))) == 0);
+	}
+	TEST_CHECK(catalog_Load(&config, &loaded, &changed) == CATALOG_ERR_READ);
+	removeGamedata(&loaded);
+	
+	// A damaged trigram index is dropped, leaving the games to be loaded as normal
+	TEST_CHECK(catalog_Save(&config, &scanned) == 340);
+	trigrams = sizeof(catalog_header_t) + (340L * sizeof(catalog_record_t)) + (scanned.trigrams.keys_size * sizeof(unsigned short));
+	offset = scanned.trigrams.postings_size + 1;
+	patchCatalog(trigrams + sizeof(long), &offset, sizeof(long));
+	TEST_CHECK(catalog_Load(&config, &loaded, &changed) == 340);
+	TEST_CHECK(sameGames(&scanned, &loaded) && (loaded.trigrams.keys_size == 0) && (loaded.trigrams.keys == NULL));
+	removeGamedata(&loaded);
+	TEST_CHECK(catalog_Save(&config, &scanned) == 340);
+	posting = 0xFFFF;
+	patchCatalog(trigrams + ((scanned.trigrams.keys_size + 1) * sizeof(long)), &posting, sizeof(posting));
+	TEST_CHECK(catalog_Load(&config, &loaded, &changed) == 340);
+	TEST_CHECK(sameGames(&scanned, &loaded) && (loaded.trigrams.keys_size == 0));
+	removeGamedata(&loaded);
+	
+	removeGamedata(&scanned);
+	test_FreeConfig(&config);
+}
+
+static void benchCatalog(){
+	/* Startup with 5000 games: scraping every directory, against loading the catalog */
+	
+	config_t config;
+	gamedir_t gamedir;
+	gametable_t gametable;
+	double start;
+	double scan_time;
+	double load_time;
+	long scan_calls;
+	long load_calls;
+	int changed;
+	int status;
+	
+	test_MakeGames("Bench", 1000, 5000, 4);
+	test_Config(&config, &gamedir, "A:\\Bench", 1);
+	
+	initGametable(&gametable);
+	dosshim_Reset();
+	start = test_Seconds();
+	status = scanGamedirs(&config, &gametable, NULL, &test_scratch, NULL, NULL);
+	scan_time = test_Seconds() - start;
+	scan_calls = dosshim_Total();
+	TEST_CHECK(status == 5000);
+	TEST_CHECK(catalog_Save(&config, &gametable) == 5000);
+	removeGamedata(&gametable);
+	
+	initGametable(&gametable);
+	dosshim_Reset();
+	start = test_Seconds();
+	status = catalog_Load(&config, &gametable, &changed);
+	load_time = test_Seconds() - start;
+	load_calls = dosshim_Total();
+	TEST_CHECK(status == 5000);
+	removeGamedata(&gametable);
+	
+	printf("catalog: 5000 games, scrape %.3fs / %ld DOS calls, catalog load %.3fs / %ld DOS calls\n", scan_time, scan_calls, load_time, load_calls);
+	test_FreeConfig(&config);
+}
+
+int main(int argc, char **argv){
+	test_Init(argc, argv);
+	test_Root("catalog");
+	testRoundTrip();
+	if (test_bench){
+		benchCatalog();
+	}
+	return test_Done("catalog");
+}
@@ -0,0 +1,267 @@
+/* test_collate.c, Host tests of name collation for x68Launcher.
+ Copyright (C) 2020  John Snowdon
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <ctype.h>
+#include "test.h"
+#include "collate.h"
+
+static const char * skipArticle(const char *s){
+	// Reference: skip a leading "The ", as long as something follows it
+	
+	if ((strncasecmp(s, COLLATE_ARTICLE, strlen(COLLATE_ARTICLE)) == 0) && (s[strlen(COLLATE_ARTICLE)] != '\0')){
+		return s + strlen(COLLATE_ARTICLE);
+	}
+	return s;
+}
+
+static int referenceCompare(const char *a, const char *b){
+	/* Reference collator: compare two names directly, a character or a number at a time */
+	
+	const char *x;
+	const char *y;
+	int ca;
+	int cb;
+	int compare;
+	
+	a = skipArticle(a);
+	b = skipArticle(b);
+	while ((*a != '\0') && (*b != '\0')){
+		if (isdigit((unsigned char) *a) && isdigit((unsigned char) *b)){
+			
+			// Numbers compare by value: without leading zeros, a shorter one is smaller
+			while ((*a == '0') && isdigit((unsigned char) a[1])){
+				a++;
+			}
+			while ((*b == '0') && isdigit((unsigned char) b[1])){
+				b++;
+			}
+			for(x = a; isdigit((unsigned char) *x); x++){
+			}
+			for(y = b; isdigit((unsigned char) *y); y++){
+			}
+			if ((x - a) != (y - b)){
+				return (x - a) - (y - b);
+			}
+			compare = strncmp(a, b, x - a);
+			if (compare != 0){
+				return compare;
+			}
+			a = x;
+			b = y;
+			continue;
+		}
+		ca = isdigit((unsigned char) *a) ? COLLATE_NUMBER : tolower((unsigned char) *a);
+		cb = isdigit((unsigned char) *b) ? COLLATE_NUMBER : tolower((unsigned char) *b);
+		if (ca != cb){
+			return ca - cb;
+		}
+		a++;
+		b++;
+	}
+	return (unsigned char) *a - (unsigned char) *b;
+}
+
+static int sign(int x){
+	// -1, 0 or 1 as x is less than, equal to or more than 0
+	
+	return (x > 0) - (x < 0);
+}
+
+static void randomString(char *s){
+	/* Up to 11 characters from a small alphabet, so that there are many near misses */
+	
+	static const char alphabet[] = "aB0 19tT-heX";
+	int n;
+	int i;
+	
+	n = test_Random(12);
+	for(i = 0; i < n; i++){
+		s[i] = alphabet[test_Random(sizeof(alphabet) - 1)];
+	}
+	s[n] = '\0';
+}
+
+static void testExamples(){
+	/* Orders a person would expect */
+	
+	static const struct {
+		const char *a;
+		const char *b;
+		int order;
+	} examples[] = {
+		{ "Game 2", "Game 10", -1 },
+		{ "game", "Game", 0 },
+		{ "The Tower", "Tetris", 1 },
+		{ "The Tower", "Tower", 0 },
+		{ "The", "Tetris", 1 },
+		{ "abc", "ABD", -1 },
+		{ "x007", "x7", 0 },
+		{ "R-Type", "R-Type II", -1 },
+		{ "Game 10", "Game 9 b", 1 },
+		{ "Game 9", "Game A", -1 },
+		{ "", "A", -1 },
+	};
+	int same;
+	int i;
+	
+	same = 1;
+	for(i = 0; i < (int)(sizeof(examples) / sizeof(examples[0])); i++){
+		if ((sign(collate_Compare(examples[i].a, examples[i].b)) != examples[i].order) || (sign(referenceCompare(examples[i].a, examples[i].b)) != examples[i].order)){
+			printf("collate: [%s] [%s] not in the expected order\n", examples[i].a, examples[i].b);
+			same = 0;
+		}
+	}
+	TEST_CHECK(same);
+}
+
+static void testProperties(){
+	/* Keys order 200000 random pairs as the reference does, and give a consistent total order */
+	
+	unsigned char key_a[COLLATE_KEY_SIZE];
+	unsigned char key_b[COLLATE_KEY_SIZE];
+	unsigned char key_c[COLLATE_KEY_SIZE];
+	char a[16];
+	char b[16];
+	char c[16];
+	int reference;
+	int ab;
+	int bc;
+	int same;
+	int symmetric;
+	int transitive;
+	int k;
+	
+	same = 1;
+	symmetric = 1;
+	transitive = 1;
+	for(k = 0; k < 200000; k++){
+		randomString(a);
+		randomString(b);
+		randomString(c);
+		collate_Key(a, key_a);
+		collate_Key(b, key_b);
+		collate_Key(c, key_c);
+		reference = sign(referenceCompare(a, b));
+		ab = sign(memcmp(key_a, key_b, COLLATE_KEY_SIZE));
+		bc = sign(memcmp(key_b, key_c, COLLATE_KEY_SIZE));
+		if ((ab != reference) || (sign(collate_Compare(a, b)) != ab)){
+			if (same){
+				printf("collate: [%s] [%s] reference %d, key %d\n", a, b, reference, ab);
+			}
+			same = 0;
+		}
+		if (sign(memcmp(key_b, key_a, COLLATE_KEY_SIZE)) != -ab){
+			symmetric = 0;
+		}
+		if ((ab == bc) && (sign(memcmp(key_a, key_c, COLLATE_KEY_SIZE)) != ab)){
+			transitive = 0;
+		}
+	}
+	TEST_CHECK(same);
+	TEST_CHECK(symmetric);
+	TEST_CHECK(transitive);
+	
+	// Case never matters
+	same = 1;
+	for(k = 0; k < 1000; k++){
+		randomString(a);
+		strcpy(b, a);
+		for(ab = 0; b[ab] != '\0'; ab++){
+			b[ab] = toupper((unsigned char) b[ab]);
+		}
+		if (collate_Compare(a, b) != 0){
+			same = 0;
+		}
+	}
+	TEST_CHECK(same);
+}
+
+// Names being sorted by the reference collator
+static char **reference_names = NULL;
+
+static int compareNames(const void *op1, const void *op2){
+	// Order two positions in reference_names with the reference collator
+	
+	return referenceCompare(reference_names[*(const int *) op1], reference_names[*(const int *) op2]);
+}
+
+static int compareKeys(const void *op1, const void *op2){
+	// Order two sort keys
+	
+	return memcmp(op1, op2, COLLATE_KEY_SIZE);
+}
+
+static void benchCollate(){
+	/* Sorting 10000 names by key, against comparing the names each time */
+	
+	char (*names)[MAX_NAME_SIZE];
+	unsigned char (*keys)[COLLATE_KEY_SIZE];
+	int *order;
+	double start;
+	double key_time;
+	double compare_time;
+	unsigned char key[COLLATE_KEY_SIZE];
+	int same;
+	int i;
+	
+	names = malloc(10000 * MAX_NAME_SIZE);
+	keys = malloc(10000 * COLLATE_KEY_SIZE);
+	order = (int *) malloc(10000 * sizeof(int));
+	reference_names = (char **) malloc(10000 * sizeof(char *));
+	for(i = 0; i < 10000; i++){
+		test_Name(names[i], (int)(((long) i * 7919) % 10000));
+		reference_names[i] = names[i];
+		order[i] = i;
+	}
+	
+	start = test_Seconds();
+	for(i = 0; i < 10000; i++){
+		collate_Key(names[i], keys[i]);
+	}
+	qsort(keys, 10000, COLLATE_KEY_SIZE, compareKeys);
+	key_time = test_Seconds() - start;
+	start = test_Seconds();
+	qsort(order, 10000, sizeof(int), compareNames);
+	compare_time = test_Seconds() - start;
+	
+	// Both give the same order
+	same = 1;
+	for(i = 0; i < 10000; i++){
+		collate_Key(names[order[i]], key);
+		if (memcmp(key, keys[i], COLLATE_KEY_SIZE) != 0){
+			same = 0;
+		}
+	}
+	TEST_CHECK(same);
+	printf("collate: sorting 10000 names, %.4fs by key, %.4fs comparing names\n", key_time, compare_time);
+	
+	free(names);
+	free(keys);
+	free(order);
+	free(reference_names);
+	reference_names = NULL;
+}
+
+int main(int argc, char **argv){
+	test_Init(argc, argv);
+	testExamples();
+	testProperties();
+	if (test_bench){
+		benchCollate();
+	}
+	return test_Done("collate");
+}
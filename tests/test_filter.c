@@ -0,0 +1,703 @@
+/* test_filter.c, Host tests of game filtering for x68Launcher.
+ Copyright (C) 2020  John Snowdon
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "test.h"
+
+// Criteria of the reference filter; NULL or 0 for any
+typedef struct criteria {
+	const char *genre;
+	const char *company;
+	unsigned char mask;
+} criteria_t;
+
+static int referenceFilter(gametable_t *gametable, criteria_t *criteria, int *list){
+	/* Reference: test the launch.dat of each game in turn, as the filters did before the bitsets */
+	
+	launchdat_t launchdat;
+	hwdata_t hardware;
+	int n;
+	int g;
+	
+	launchdat.hardware = &hardware;
+	n = 0;
+	for(g = 0; g < gametable->meta.size; g++){
+		if (gametable->meta.state[g] != META_STATE_LOADED){
+			continue;
+		}
+		test_Launchdat(&launchdat, g);
+		if ((criteria->genre != NULL) && (strcmp(launchdat.genre, criteria->genre) != 0)){
+			continue;
+		}
+		if ((criteria->company != NULL) && (strcmp(launchdat.developer, criteria->company) != 0) && (strcmp(launchdat.publisher, criteria->company) != 0)){
+			continue;
+		}
+		if ((hardware.flags & criteria->mask) != criteria->mask){
+			continue;
+		}
+		list[n] = g;
+		n++;
+	}
+	return n;
+}
+
+static int findString(state_t *state, const char *s){
+	/* Position of a string in the list of filter strings, or -1 */
+	
+	int i;
+	
+	for(i = 0; i < state->available_filter_strings; i++){
+		if (strcmp(state->filter_strings[i], s) == 0){
+			return i;
+		}
+	}
+	return -1;
+}
+
+static int sameSelection(state_t *state, gametable_t *gametable, criteria_t *criteria){
+	/* Check the selection list against the reference filter */
+	
+	int *expected;
+	int n;
+	int same;
+	
+	expected = (int *) malloc((gametable->meta.size + 1) * sizeof(int));
+	n = referenceFilter(gametable, criteria, expected);
+	same = (state->selected_max == n) && (memcmp(state->selected_list, expected, n * sizeof(int)) == 0);
+	if ((n > 0) && (state->selected_gameid != expected[0])){
+		same = 0;
+	}
+	free(expected);
+	return same;
+}
+
+static void pickGenre(state_t *state, gametable_t *gametable, launchdat_t *launchdat, const char *genre){
+	/* Choose a genre from the genre filter popup */
+	
+	filter_GetGenres(state, gametable, launchdat);
+	state->selected_filter_string = findString(state, genre);
+	filter_Genre(state, gametable, launchdat);
+}
+
+static void pickCompany(state_t *state, gametable_t *gametable, launchdat_t *launchdat, const char *company){
+	/* Choose a company from the company filter popup */
+	
+	filter_GetCompany(state, gametable, launchdat);
+	state->selected_filter_string = findString(state, company);
+	filter_Company(state, gametable, launchdat);
+}
+
+static void pickTechSpecs(state_t *state, gametable_t *gametable, launchdat_t *launchdat, unsigned char mask){
+	/* Tick every hardware flag in mask in the tech specs popup */
+	
+	int i;
+	
+	filter_GetTechSpecs(state, gametable, launchdat);
+	for(i = 0; i < META_HW_BITS; i++){
+		if (mask & (1 << i)){
+			state->filter_strings_selected[findString(state, meta_HardwareName(i))] = 1;
+		}
+	}
+	filter_TechSpecs(state, gametable, launchdat);
+}
+
+static void freeState(state_t *state){
+	/* Free what the filters allocated in the browser state */
+	
+	int i;
+	
+	for(i = 0; i < FILTER_CACHE_SIZE; i++){
+		free(state->filter_cache[i].bits);
+		free(state->filter_cache[i].list);
+	}
+	filter_ClearStrings(state);
+	free(state->filter_strings);
+	free(state->filter_counts);
+	free(state->filter_strings_selected);
+	free(state->selected_list);
+	free(state->filter_bits);
+}
+
+static void testBitsets(){
+	/* Every filter, alone and combined, selects the same games as testing each game in turn */
+	
+	gametable_t gametable;
+	state_t state;
+	launchdat_t *launchdat;
+	criteria_t criteria;
+	int same;
+	int i;
+	int g;
+	
+	initGametable(&gametable);
+	test_Games(&gametable, 2000);
+	test_Metadata(&gametable);
+	for(g = 0; g < gametable.meta.size; g += 17){
+		gametable.meta.state[g] = META_STATE_MISSING;
+	}
+	filter_StateInit(&state);
+	launchdat = test_NewLaunchdat();
+	TEST_CHECK(filter_None(&state, &gametable) == FILTER_OK);
+	
+	// Each genre and company on its own
+	same = 1;
+	for(i = 0; i < 8; i++){
+		memset(&criteria, 0, sizeof(criteria_t));
+		criteria.genre = test_genres[i];
+		pickGenre(&state, &gametable, launchdat, test_genres[i]);
+		same = same && sameSelection(&state, &gametable, &criteria);
+	}
+	TEST_CHECK(same);
+	filter_None(&state, &gametable);
+	same = 1;
+	for(i = 0; i < 10; i++){
+		memset(&criteria, 0, sizeof(criteria_t));
+		criteria.company = test_companies[i];
+		pickCompany(&state, &gametable, launchdat, test_companies[i]);
+		same = same && sameSelection(&state, &gametable, &criteria);
+	}
+	TEST_CHECK(same);
+	
+	// Every combination of hardware flags, all of which must be set
+	filter_None(&state, &gametable);
+	same = 1;
+	for(i = 0; i < (1 << META_HW_BITS); i++){
+		memset(&criteria, 0, sizeof(criteria_t));
+		criteria.mask = i;
+		pickTechSpecs(&state, &gametable, launchdat, i);
+		same = same && sameSelection(&state, &gametable, &criteria);
+	}
+	TEST_CHECK(same);
+	
+	// Filters of different types are combined with AND; a new one of the same type replaces the old
+	filter_None(&state, &gametable);
+	memset(&criteria, 0, sizeof(criteria_t));
+	criteria.genre = "Shooter";
+	criteria.mask = META_HW_CYBERSTICK;
+	pickGenre(&state, &gametable, launchdat, "Shooter");
+	pickTechSpecs(&state, &gametable, launchdat, META_HW_CYBERSTICK);
+	TEST_CHECK(sameSelection(&state, &gametable, &criteria) && (state.selected_max > 0));
+	criteria.company = "Capcom";
+	pickCompany(&state, &gametable, launchdat, "Capcom");
+	TEST_CHECK(sameSelection(&state, &gametable, &criteria));
+	criteria.genre = "Puzzle";
+	pickGenre(&state, &gametable, launchdat, "Puzzle");
+	TEST_CHECK(sameSelection(&state, &gametable, &criteria));
+	TEST_CHECK(filter_HasGame(&state, state.selected_list[0]) && !filter_HasGame(&state, -1) && !filter_HasGame(&state, 2000));
+	
+	// No filter at all is every game again
+	TEST_CHECK(filter_None(&state, &gametable) == FILTER_OK);
+	TEST_CHECK(state.selected_max == 2000);
+	
+	test_FreeLaunchdat(launchdat);
+	freeState(&state);
+	removeGamedata(&gametable);
+}
+
+// Which column a brute force count looks at
+#define COUNT_GENRE		0
+#define COUNT_SERIES	1
+#define COUNT_COMPANY	2
+
+static int bruteCount(gametable_t *gametable, int column, const char *s){
+	/* Reference: count the games with a value by testing the launch.dat of each game */
+	
+	launchdat_t launchdat;
+	hwdata_t hardware;
+	int n;
+	int g;
+	
+	launchdat.hardware = &hardware;
+	n = 0;
+	for(g = 0; g < gametable->meta.size; g++){
+		if (gametable->meta.state[g] != META_STATE_LOADED){
+			continue;
+		}
+		test_Launchdat(&launchdat, g);
+		if ((column == COUNT_GENRE) && (strcmp(launchdat.genre, s) == 0)){
+			n++;
+		} else if ((column == COUNT_SERIES) && (strcmp(launchdat.series, s) == 0)){
+			n++;
+		} else if ((column == COUNT_COMPANY) && ((strcmp(launchdat.developer, s) == 0) || (strcmp(launchdat.publisher, s) == 0))){
+			n++;
+		}
+	}
+	return n;
+}
+
+static int sameCounts(state_t *state, gametable_t *gametable, int column, int values){
+	/* Check the count of every filter string, and the order of the list, against the reference */
+	
+	int same;
+	int total;
+	int i;
+	
+	same = (state->available_filter_strings == values);
+	total = 0;
+	for(i = 0; (i < state->available_filter_strings) && same; i++){
+		if (state->filter_counts[i] != bruteCount(gametable, column, state->filter_strings[i])){
+			same = 0;
+		}
+		if ((i > 0) && (state->filter_sort == FILTER_SORT_NAME) && (collate_Compare(state->filter_strings[i - 1], state->filter_strings[i]) >= 0)){
+			same = 0;
+		}
+		if ((i > 0) && (state->filter_sort == FILTER_SORT_COUNT)){
+			if ((state->filter_counts[i - 1] < state->filter_counts[i]) || ((state->filter_counts[i - 1] == state->filter_counts[i]) && (collate_Compare(state->filter_strings[i - 1], state->filter_strings[i]) >= 0))){
+				same = 0;
+			}
+		}
+		total += state->filter_counts[i];
+	}
+	return same && (total > 0);
+}
+
+static void testCounts(){
+	/* The game count of every filter string is what counting the games one at a time gives */
+	
+	gametable_t gametable;
+	state_t state;
+	launchdat_t *launchdat;
+	launchdat_t reference;
+	hwdata_t hardware;
+	int counts[META_HW_BITS];
+	int expected[META_HW_BITS];
+	int same;
+	int i;
+	int g;
+	
+	initGametable(&gametable);
+	test_Games(&gametable, 3000);
+	test_Metadata(&gametable);
+	for(g = 0; g < gametable.meta.size; g += 13){
+		gametable.meta.state[g] = META_STATE_MISSING;
+	}
+	filter_StateInit(&state);
+	launchdat = test_NewLaunchdat();
+	
+	for(state.filter_sort = FILTER_SORT_NAME; state.filter_sort <= FILTER_SORT_COUNT; state.filter_sort++){
+		TEST_CHECK(filter_GetGenres(&state, &gametable, launchdat) == FILTER_OK);
+		TEST_CHECK(sameCounts(&state, &gametable, COUNT_GENRE, 8));
+		TEST_CHECK(filter_GetSeries(&state, &gametable, launchdat) == FILTER_OK);
+		TEST_CHECK(sameCounts(&state, &gametable, COUNT_SERIES, 20));
+		TEST_CHECK(filter_GetCompany(&state, &gametable, launchdat) == FILTER_OK);
+		TEST_CHECK(sameCounts(&state, &gametable, COUNT_COMPANY, 10));
+	}
+	state.filter_sort = FILTER_SORT_NAME;
+	
+	// Hardware flags, each counted on its own
+	reference.hardware = &hardware;
+	memset(expected, 0, sizeof(expected));
+	for(g = 0; g < gametable.meta.size; g++){
+		if (gametable.meta.state[g] == META_STATE_LOADED){
+			test_Launchdat(&reference, g);
+			for(i = 0; i < META_HW_BITS; i++){
+				if (hardware.flags & (1 << i)){
+					expected[i]++;
+				}
+			}
+		}
+	}
+	meta_CountHardware(&gametable.meta, counts);
+	TEST_CHECK(memcmp(counts, expected, sizeof(counts)) == 0);
+	TEST_CHECK(filter_GetTechSpecs(&state, &gametable, launchdat) == FILTER_OK);
+	same = (state.available_filter_strings == META_HW_BITS);
+	for(i = 0; (i < META_HW_BITS) && same; i++){
+		same = (state.filter_counts[findString(&state, meta_HardwareName(i))] == expected[i]);
+	}
+	TEST_CHECK(same);
+	
+	test_FreeLaunchdat(launchdat);
+	freeState(&state);
+	removeGamedata(&gametable);
+}
+
+static int referenceGenres(gametable_t *gametable, char (*genres)[MAX_STRING_SIZE], int *counts){
+	// Reference: list the genres with a linear search of those found so far, then count each one, as filter_GetGenres() used to
+	
+	launchdat_t launchdat;
+	hwdata_t hardware;
+	int n;
+	int g;
+	int i;
+	
+	launchdat.hardware = &hardware;
+	n = 0;
+	for(g = 0; g < gametable->meta.size; g++){
+		test_Launchdat(&launchdat, g);
+		if (launchdat.genre[0] == '\0'){
+			continue;
+		}
+		for(i = 0; i < n; i++){
+			if (strcmp(genres[i], launchdat.genre) == 0){
+				break;
+			}
+		}
+		if (i == n){
+			strcpy(genres[n], launchdat.genre);
+			n++;
+		}
+	}
+	for(i = 0; i < n; i++){
+		counts[i] = bruteCount(gametable, COUNT_GENRE, genres[i]);
+	}
+	return n;
+}
+
+static void benchCounts(){
+	/* Listing the genres of 10000 games with their counts, against the linear search */
+	
+	gametable_t gametable;
+	state_t state;
+	launchdat_t *launchdat;
+	char genres[16][MAX_STRING_SIZE];
+	int counts[16];
+	double start;
+	double count_time;
+	double reference_time;
+	int r;
+	
+	initGametable(&gametable);
+	test_Games(&gametable, 10000);
+	test_Metadata(&gametable);
+	filter_StateInit(&state);
+	launchdat = test_NewLaunchdat();
+	
+	start = test_Seconds();
+	for(r = 0; r < 100; r++){
+		filter_GetGenres(&state, &gametable, launchdat);
+	}
+	count_time = (test_Seconds() - start) / 100;
+	start = test_Seconds();
+	TEST_CHECK(referenceGenres(&gametable, genres, counts) == state.available_filter_strings);
+	reference_time = test_Seconds() - start;
+	printf("filter: genres and counts of 10000 games, one pass %.6fs, linear search and a count of each %.6fs\n", count_time, reference_time);
+	
+	test_FreeLaunchdat(launchdat);
+	freeState(&state);
+	removeGamedata(&gametable);
+}
+
+static void testBitsetList(){
+	/* meta_BitsetAnd() and meta_BitsetList() against testing one bit at a time */
+	
+	unsigned long a[40];
+	unsigned long b[40];
+	unsigned long before[40];
+	int list[40 * META_BITSET_BITS];
+	int expected[40 * META_BITSET_BITS];
+	int n;
+	int m;
+	int i;
+	
+	for(i = 0; i < 40; i++){
+		a[i] = ((unsigned long) test_Random(0x10000) << 16) | test_Random(0x10000);
+		b[i] = (i % 5) ? (((unsigned long) test_Random(0x10000) << 16) | test_Random(0x10000)) : 0;
+	}
+	a[7] = 0;
+	a[8] = 0xFFFFFFFFUL;
+	b[8] = 0xFFFFFFFFUL;
+	memcpy(before, a, sizeof(a));
+	m = 0;
+	for(i = 0; i < 40 * META_BITSET_BITS; i++){
+		if ((before[i / META_BITSET_BITS] & b[i / META_BITSET_BITS]) & (1UL << (i % META_BITSET_BITS))){
+			expected[m] = i;
+			m++;
+		}
+	}
+	meta_BitsetAnd(a, b, 40);
+	n = meta_BitsetList(a, 40, list);
+	TEST_CHECK((n == m) && (memcmp(list, expected, n * sizeof(int)) == 0));
+}
+
+static void testCompanies(){
+	/* 2000 distinct companies are all listed, in full, with their counts, and each can be filtered on */
+	
+	gametable_t gametable;
+	state_t state;
+	launchdat_t *launchdat;
+	launchdat_t company;
+	hwdata_t hardware;
+	int *expected;
+	int developer;
+	int publisher;
+	int same;
+	int last;
+	int n;
+	int i;
+	int g;
+	long fixed;
+	long bytes;
+	char name[MAX_STRING_SIZE];
+	
+	initGametable(&gametable);
+	test_Games(&gametable, 4000);
+	filter_StateInit(&state);
+	launchdat = test_NewLaunchdat();
+	
+	// Each game is developed and published by one of 2000 companies with long names
+	expected = (int *) calloc(2000, sizeof(int));
+	company.hardware = &hardware;
+	for(g = 0; g < gametable.meta.size; g++){
+		test_Launchdat(&company, g);
+		developer = g % 2000;
+		publisher = (g * 7) % 2000;
+		sprintf(company.developer, "Software Development House %04d", developer);
+		sprintf(company.publisher, "Software Development House %04d", publisher);
+		meta_Update(&gametable.meta, g, &company);
+		expected[developer]++;
+		if (publisher != developer){
+			expected[publisher]++;
+		}
+	}
+	TEST_CHECK(strlen(company.developer) == MAX_STRING_SIZE - 1);
+	
+	TEST_CHECK(filter_GetCompany(&state, &gametable, launchdat) == FILTER_OK);
+	TEST_CHECK(state.available_filter_strings == 2000);
+	TEST_CHECK(state.available_filter_pages == (2000 + MAXIMUM_FILTER_STRINGS_PER_PAGE - 1) / MAXIMUM_FILTER_STRINGS_PER_PAGE);
+	same = 1;
+	for(i = 0; i < state.available_filter_strings; i++){
+		if ((sscanf(state.filter_strings[i], "Software Development House %d", &n) != 1) || (i != n) || (state.filter_counts[i] != expected[n]) || state.filter_strings_selected[i]){
+			same = 0;
+		}
+	}
+	TEST_CHECK(same);
+	
+	// The last company of all
+	last = state.available_filter_strings - 1;
+	strcpy(name, state.filter_strings[last]);
+	state.selected_filter_string = last;
+	TEST_CHECK(filter_Company(&state, &gametable, launchdat) == FILTER_OK);
+	TEST_CHECK(state.selected_max == expected[1999]);
+	same = (state.selected_max > 0);
+	for(i = 0; i < state.selected_max; i++){
+		g = state.selected_list[i];
+		if ((strcmp(meta_String(&gametable.meta, gametable.meta.developer[g]), name) != 0) && (strcmp(meta_String(&gametable.meta, gametable.meta.publisher[g]), name) != 0)){
+			same = 0;
+		}
+	}
+	TEST_CHECK(same);
+	
+	// Against 200 fixed strings of MAX_STRING_SIZE, with a count and a selected flag each
+	filter_GetCompany(&state, &gametable, launchdat);
+	fixed = 200L * (MAX_STRING_SIZE + sizeof(int) + 1);
+	bytes = state.filter_pool.bytes_allocated + (state.filter_strings_size * (sizeof(char *) + sizeof(int) + 1));
+	printf("filter: %d companies in %d pages, %d slots, %ld bytes; 200 fixed strings took %ld bytes\n", state.available_filter_strings, state.available_filter_pages, state.filter_strings_size, bytes, fixed);
+	
+	// Strings added directly are kept in full, however long
+	filter_ClearStrings(&state);
+	same = 1;
+	for(i = 0; i < 5000; i++){
+		sprintf(name, "%d", i);
+		if (filter_AddString(&state, "A filter string far longer than any launch.dat field", i) != FILTER_OK){
+			same = 0;
+		}
+	}
+	for(i = 0; i < 5000; i++){
+		if ((strcmp(state.filter_strings[i], "A filter string far longer than any launch.dat field") != 0) || (state.filter_counts[i] != i)){
+			same = 0;
+		}
+	}
+	TEST_CHECK(same && (state.available_filter_strings == 5000));
+	
+	free(expected);
+	test_FreeLaunchdat(launchdat);
+	freeState(&state);
+	removeGamedata(&gametable);
+}
+
+static void testCache(){
+	/* Going back to a recent filter gives the same list from the cache, until the metadata changes */
+	
+	gametable_t gametable;
+	state_t state;
+	launchdat_t *launchdat;
+	criteria_t criteria;
+	int *first;
+	int count;
+	int hits;
+	int misses;
+	int i;
+	
+	initGametable(&gametable);
+	test_Games(&gametable, 2000);
+	test_Metadata(&gametable);
+	filter_StateInit(&state);
+	launchdat = test_NewLaunchdat();
+	first = (int *) malloc(2000 * sizeof(int));
+	memset(&criteria, 0, sizeof(criteria_t));
+	criteria.genre = "Racing";
+	
+	filter_None(&state, &gametable);
+	pickGenre(&state, &gametable, launchdat, "Racing");
+	TEST_CHECK((state.filter_cache_hits == 0) && (state.filter_cache_misses == 1));
+	count = state.selected_max;
+	memcpy(first, state.selected_list, count * sizeof(int));
+	
+	// Back and forth between the genre and no filter
+	for(i = 0; i < 5; i++){
+		filter_None(&state, &gametable);
+		pickGenre(&state, &gametable, launchdat, "Racing");
+	}
+	TEST_CHECK((state.filter_cache_hits == 5) && (state.filter_cache_misses == 1));
+	TEST_CHECK((state.selected_max == count) && (memcmp(state.selected_list, first, count * sizeof(int)) == 0));
+	TEST_CHECK(sameSelection(&state, &gametable, &criteria));
+	TEST_CHECK(state.selected_gameid == first[0]);
+	
+	// The same genre combined with another filter is a different result, kept as well
+	pickTechSpecs(&state, &gametable, launchdat, META_HW_FPU);
+	pickGenre(&state, &gametable, launchdat, "Racing");
+	criteria.mask = META_HW_FPU;
+	TEST_CHECK(sameSelection(&state, &gametable, &criteria));
+	TEST_CHECK((state.filter_cache_hits == 5 + 1) && (state.filter_cache_misses == 2));
+	criteria.mask = 0;
+	
+	// Only the FILTER_CACHE_SIZE most recent results are kept
+	filter_None(&state, &gametable);
+	hits = state.filter_cache_hits;
+	for(i = 0; i < 8; i++){
+		pickGenre(&state, &gametable, launchdat, test_genres[i]);
+		filter_None(&state, &gametable);
+	}
+	pickGenre(&state, &gametable, launchdat, test_genres[7]);
+	TEST_CHECK(state.filter_cache_hits == hits + 1);
+	filter_None(&state, &gametable);
+	misses = state.filter_cache_misses;
+	pickGenre(&state, &gametable, launchdat, test_genres[0]);
+	TEST_CHECK(state.filter_cache_misses == misses + 1);
+	
+	// A change to the metadata of any game makes every result out of date
+	filter_None(&state, &gametable);
+	pickGenre(&state, &gametable, launchdat, "Racing");
+	filter_None(&state, &gametable);
+	test_Launchdat(launchdat, first[0]);
+	strcpy(launchdat->genre, "Shooter");
+	meta_Update(&gametable.meta, first[0], launchdat);
+	misses = state.filter_cache_misses;
+	pickGenre(&state, &gametable, launchdat, "Racing");
+	TEST_CHECK(state.filter_cache_misses == misses + 1);
+	TEST_CHECK((state.selected_max == count - 1) && (state.selected_list[0] == first[1]));
+	
+	// As does a rescan
+	filter_CacheClear(&state);
+	filter_None(&state, &gametable);
+	misses = state.filter_cache_misses;
+	pickGenre(&state, &gametable, launchdat, "Racing");
+	TEST_CHECK(state.filter_cache_misses == misses + 1);
+	
+	free(first);
+	test_FreeLaunchdat(launchdat);
+	freeState(&state);
+	removeGamedata(&gametable);
+}
+
+static void benchCache(){
+	/* Going back to a genre filter of 10000 games, from the cache and worked out again */
+	
+	gametable_t gametable;
+	state_t state;
+	unsigned long *bits;
+	double start;
+	double hit_time;
+	double miss_time;
+	int id;
+	int r;
+	
+	initGametable(&gametable);
+	test_Games(&gametable, 10000);
+	test_Metadata(&gametable);
+	filter_StateInit(&state);
+	filter_None(&state, &gametable);
+	id = meta_Find(&gametable.meta, "Racing");
+	
+	// What filter_Genre() does on a miss, and on a hit
+	start = test_Seconds();
+	for(r = 0; r < 1000; r++){
+		bits = filter_NewBitset(&state, &gametable, FILTER_GENRE, id);
+		meta_BitsetMatch(&gametable.meta, gametable.meta.genre, id, bits);
+		filter_ApplyBitsets(&state, &gametable);
+	}
+	miss_time = test_Seconds() - start;
+	start = test_Seconds();
+	for(r = 0; r < 1000; r++){
+		filter_CacheFind(&state, &gametable, FILTER_GENRE, id);
+	}
+	hit_time = test_Seconds() - start;
+	TEST_CHECK((state.filter_cache_hits == 1000) && (state.filter_cache_misses == 0));
+	printf("filter: 1000 genre filters of 10000 games, %.4fs worked out, %.4fs from the cache\n", miss_time, hit_time);
+	
+	freeState(&state);
+	removeGamedata(&gametable);
+}
+
+static void benchBitsets(){
+	/* A genre AND cyberstick filter of 10000 games, with bitsets and testing each game in turn */
+	
+	gametable_t gametable;
+	state_t state;
+	launchdat_t *launchdat;
+	criteria_t criteria;
+	int *list;
+	double start;
+	double bitset_time;
+	double reference_time;
+	int r;
+	
+	initGametable(&gametable);
+	test_Games(&gametable, 10000);
+	test_Metadata(&gametable);
+	filter_StateInit(&state);
+	launchdat = test_NewLaunchdat();
+	list = (int *) malloc(10000 * sizeof(int));
+	memset(&criteria, 0, sizeof(criteria_t));
+	criteria.genre = "Shooter";
+	criteria.mask = META_HW_CYBERSTICK;
+	filter_None(&state, &gametable);
+	
+	start = test_Seconds();
+	for(r = 0; r < 100; r++){
+		filter_CacheClear(&state);
+		pickGenre(&state, &gametable, launchdat, "Shooter");
+		pickTechSpecs(&state, &gametable, launchdat, META_HW_CYBERSTICK);
+	}
+	bitset_time = (test_Seconds() - start) / 100;
+	start = test_Seconds();
+	for(r = 0; r < 100; r++){
+		referenceFilter(&gametable, &criteria, list);
+	}
+	reference_time = (test_Seconds() - start) / 100;
+	TEST_CHECK(sameSelection(&state, &gametable, &criteria));
+	printf("filter: genre AND cyberstick of 10000 games, bitsets %.6fs (with both popups), per game %.6fs\n", bitset_time, reference_time);
+	
+	free(list);
+	test_FreeLaunchdat(launchdat);
+	freeState(&state);
+	removeGamedata(&gametable);
+}
+
+int main(int argc, char **argv){
+	test_Init(argc, argv);
+	testBitsets();
+	testBitsetList();
+	testCounts();
+	testCompanies();
+	testCache();
+	if (test_bench){
+		benchBitsets();
+		benchCounts();
+		benchCache();
+	}
+	return test_Done("filter");
+}
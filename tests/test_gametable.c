@@ -0,0 +1,279 @@
+/* test_gametable.c, Host tests of the game table for x68Launcher.
+ Copyright (C) 2020  John Snowdon
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "test.h"
+#include "ui.h"
+
+static void testAppend(){
+	/* Games added one at a time all end up in one array, in the order they were added */
+	
+	gametable_t gametable;
+	gamedata_t *gamedata;
+	char path[MAX_PATH_SIZE];
+	char name[MAX_NAME_SIZE];
+	int grown;
+	int capacity;
+	int same;
+	int i;
+	
+	initGametable(&gametable);
+	TEST_CHECK(gametable.games == NULL);
+	TEST_CHECK(gametable.capacity == 0);
+	
+	grown = 0;
+	capacity = 0;
+	for(i = 0; i < 10000; i++){
+		gamedata = addGamedata(&gametable);
+		sprintf(path, "A:\\Games\\GAME%04d", i);
+		test_Name(name, i);
+		setGamedataPath(&gametable, gamedata, path);
+		setGamedataName(&gametable, gamedata, name);
+		gamedata->gameid = i;
+		if (gametable.capacity != capacity){
+			grown++;
+			capacity = gametable.capacity;
+		}
+	}
+	TEST_CHECK(gametable.size == 10000);
+	TEST_CHECK(gametable.capacity >= 10000);
+	
+	// Doubling from GAMETABLE_INITIAL_SIZE
+	TEST_CHECK(grown <= 9);
+	TEST_CHECK(gametable.capacity == GAMETABLE_INITIAL_SIZE * 256);
+	
+	same = 1;
+	for(i = 0; i < gametable.size; i++){
+		gamedata = &gametable.games[i];
+		sprintf(path, "A:\\Games\\GAME%04d", i);
+		test_Name(name, i);
+		if ((gamedata->gameid != i) || (strcmp(getGamedataPath(gamedata, path), path) != 0) || (strcmp(gamedata->name, name) != 0)){
+			same = 0;
+		}
+	}
+	TEST_CHECK(same);
+	
+	removeGamedata(&gametable);
+	TEST_CHECK(gametable.size == 0);
+	TEST_CHECK(gametable.games == NULL);
+}
+
+static void testLookup(){
+	/* getGameid() finds every game by id, wherever it is in the table, and nothing else */
+	
+	gametable_t gametable;
+	gamedata_t *gamedata;
+	char path[MAX_PATH_SIZE];
+	int *ids;
+	int found;
+	int i;
+	int j;
+	int t;
+	
+	// Ids 0, 2, 4... in a shuffled order, leaving a hole at every odd id
+	ids = (int *) malloc(3000 * sizeof(int));
+	for(i = 0; i < 3000; i++){
+		ids[i] = i * 2;
+	}
+	for(i = 2999; i > 0; i--){
+		j = test_Random(i + 1);
+		t = ids[i];
+		ids[i] = ids[j];
+		ids[j] = t;
+	}
+	initGametable(&gametable);
+	for(i = 0; i < 3000; i++){
+		gamedata = addGamedata(&gametable);
+		sprintf(path, "A:\\Games\\GAME%04d", ids[i]);
+		setGamedataPath(&gametable, gamedata, path);
+		setGamedataName(&gametable, gamedata, gamedata->dir);
+		gamedata->gameid = ids[i];
+	}
+	TEST_CHECK(indexGamedata(&gametable) == 3000);
+	TEST_CHECK(gametable.ids_size == 5999);
+	
+	found = 0;
+	for(i = 0; i < gametable.ids_size; i++){
+		gamedata = getGameid(i, &gametable);
+		if ((i % 2) == 0){
+			sprintf(path, "GAME%04d", i);
+			if ((gamedata != NULL) && (gamedata->gameid == i) && (strcmp(gamedata->dir, path) == 0)){
+				found++;
+			}
+		} else if (gamedata == NULL){
+			found++;
+		}
+	}
+	TEST_CHECK(found == gametable.ids_size);
+	TEST_CHECK(getGameid(-1, &gametable) == NULL);
+	TEST_CHECK(getGameid(gametable.ids_size, &gametable) == NULL);
+	
+	// Ids follow the sorted order once the table is sorted
+	TEST_CHECK(sortGamedata(&gametable) == 0);
+	TEST_CHECK(indexGamedata(&gametable) == 3000);
+	found = 0;
+	for(i = 0; i < gametable.size; i++){
+		if (getGameid(i, &gametable) == &gametable.games[i]){
+			found++;
+		}
+	}
+	TEST_CHECK(found == 3000);
+	
+	free(ids);
+	removeGamedata(&gametable);
+}
+
+static gamedata_t * findGameid(int gameid, gametable_t *gametable){
+	// Reference lookup: walk the table, as getGameid() did before it was indexed
+	
+	int i;
+	
+	for(i = 0; i < gametable->size; i++){
+		if (gametable->games[i].gameid == gameid){
+			return &gametable->games[i];
+		}
+	}
+	return NULL;
+}
+
+static void benchLookup(){
+	/* Looking up one browser page of games at a time from 5000, indexed and walked */
+	
+	gametable_t gametable;
+	double start;
+	double index_time;
+	double walk_time;
+	long total;
+	int i;
+	
+	initGametable(&gametable);
+	test_Games(&gametable, 5000);
+	
+	total = 0;
+	start = test_Seconds();
+	for(i = 0; i < 1000000; i++){
+		total += getGameid((int)(((long) i * 7919) % 5000), &gametable)->gameid;
+	}
+	index_time = test_Seconds() - start;
+	start = test_Seconds();
+	for(i = 0; i < 20000; i++){
+		total -= findGameid((int)(((long) i * 7919) % 5000), &gametable)->gameid;
+	}
+	walk_time = (test_Seconds() - start) * 50;
+	TEST_CHECK(total != 0);
+	printf("gametable: 1000000 lookups in 5000 games, indexed %.4fs, walking the table %.4fs (estimated)\n", index_time, walk_time);
+	removeGamedata(&gametable);
+}
+
+static void testSelection(){
+	/* A selection of 5000 games pages through every game once, 19 to a page */
+	
+	gametable_t gametable;
+	state_t state;
+	unsigned char *seen;
+	int page;
+	int line;
+	int pos;
+	int ok;
+	int lines;
+	
+	initGametable(&gametable);
+	test_Games(&gametable, 5000);
+	filter_StateInit(&state);
+	
+	TEST_CHECK(filter_None(&state, &gametable) == FILTER_OK);
+	TEST_CHECK(state.selected_max == 5000);
+	TEST_CHECK(state.selected_list_size >= 5000);
+	TEST_CHECK(state.total_pages == (5000 + ui_browser_max_lines - 1) / ui_browser_max_lines);
+	TEST_CHECK(state.selected_gameid == 0);
+	
+	// As the browser pane works out the game on each line of each page
+	seen = (unsigned char *) calloc(5000, 1);
+	ok = 1;
+	lines = 0;
+	for(page = 1; page <= state.total_pages; page++){
+		for(line = 0; line < ui_browser_max_lines; line++){
+			pos = ((page - 1) * ui_browser_max_lines) + line;
+			if (pos >= state.selected_max){
+				break;
+			}
+			if ((state.selected_list[pos] < 0) || (getGameid(state.selected_list[pos], &gametable) == NULL) || seen[state.selected_list[pos]]){
+				ok = 0;
+			} else {
+				seen[state.selected_list[pos]] = 1;
+			}
+			if (page == state.total_pages){
+				lines++;
+			}
+		}
+	}
+	TEST_CHECK(ok);
+	TEST_CHECK(memchr(seen, 0, 5000) == NULL);
+	TEST_CHECK(lines == 5000 - ((state.total_pages - 1) * ui_browser_max_lines));
+	printf("gametable: selection of %d games, %d pages, %ld bytes\n", state.selected_max, state.total_pages, (long)(state.selected_list_size * sizeof(int)));
+	
+	// An empty selection still has one page
+	state.selected_max = 0;
+	filter_SetPages(&state);
+	TEST_CHECK(state.total_pages == 1);
+	
+	free(seen);
+	free(state.selected_list);
+	free(state.filter_bits);
+	removeGamedata(&gametable);
+}
+
+static void benchAppend(){
+	/* Adding and walking 1000 and 10000 games */
+	
+	gametable_t gametable;
+	double start;
+	double build_time;
+	double walk_time;
+	long total;
+	int sizes[2] = { 1000, 10000 };
+	int s;
+	int i;
+	
+	for(s = 0; s < 2; s++){
+		initGametable(&gametable);
+		start = test_Seconds();
+		test_Games(&gametable, sizes[s]);
+		build_time = test_Seconds() - start;
+		
+		start = test_Seconds();
+		total = 0;
+		for(i = 0; i < gametable.size; i++){
+			total += strlen(gametable.games[i].name);
+		}
+		walk_time = test_Seconds() - start;
+		TEST_CHECK(total > 0);
+		printf("gametable: %d games, add/sort/index %.4fs, walk %.6fs\n", sizes[s], build_time, walk_time);
+		removeGamedata(&gametable);
+	}
+}
+
+int main(int argc, char **argv){
+	test_Init(argc, argv);
+	testAppend();
+	testLookup();
+	testSelection();
+	if (test_bench){
+		benchAppend();
+		benchLookup();
+	}
+	return test_Done("gametable");
+}
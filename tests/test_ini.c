@@ -0,0 +1,577 @@
+/* test_ini.c, Host tests of launch.dat and ini file parsing for x68Launcher.
+ Copyright (C) 2020  John Snowdon
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stddef.h>
+#include "test.h"
+#include "ini.h"
+
+// Not in data.h; getLaunchdata() calls it before each parse
+void launchdataDefaults(launchdat_t *launchdat);
+
+// Copies with the full size of each field, as the old handler did, so gcc warns that
+// the copy may be left unterminated
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wstringop-truncation"
+static int referenceHandler(void* user, const char* section, const char* name, const char* value){
+	// Reference: the chain of strcmp() tests that launchdatHandler() used to be
+	
+	launchdat_t* launchdat = (launchdat_t*)user;
+	unsigned char flag;
+	
+	#define MATCH(s, n) strcmp(section, s) == 0 && strcmp(name, n) == 0
+	if (MATCH("default", "name")){
+		strncpy(launchdat->realname, value, MAX_NAME_SIZE);
+	} else if (MATCH("default", "genre")){
+		strncpy(launchdat->genre, value, MAX_STRING_SIZE);
+	} else if (MATCH("default", "developer")){
+		strncpy(launchdat->developer, value, MAX_STRING_SIZE);
+	} else if (MATCH("default", "publisher")){
+		strncpy(launchdat->publisher, value, MAX_STRING_SIZE);
+	} else if (MATCH("default", "year")){
+		launchdat->year = atoi(value);
+	} else if (MATCH("default", "start")){
+		strncpy(launchdat->start, value, MAX_FILENAME_SIZE);
+	} else if (MATCH("default", "alt_start")){
+		strncpy(launchdat->alt_start, value, MAX_FILENAME_SIZE);
+	} else if (MATCH("default", "images")){
+		strncpy(launchdat->images, value, IMAGE_BUFFER_SIZE);
+	} else if (MATCH("default", "series")){
+		strncpy(launchdat->series, value, MAX_STRING_SIZE);
+	} else {
+		flag = meta_HardwareKey(section, name);
+		if (flag == 0){
+			return 0;
+		}
+		if (atoi(value) == 1){
+			launchdat->hardware->flags |= flag;
+		}
+	}
+	return 1;
+}
+#pragma GCC diagnostic pop
+
+static int referenceLaunchdata(gamedata_t *gamedata, launchdat_t *launchdat){
+	// Reference: parse a launch.dat a line at a time from the host file, as getLaunchdata() used to
+	
+	char path[MAX_PATH_SIZE + MAX_FILENAME_SIZE];
+	char host[TEST_PATH_SIZE];
+	
+	getGamedataPath(gamedata, path);
+	strcat(path, "\\" GAMEDAT);
+	dosshim_Path(path, host);
+	launchdataDefaults(launchdat);
+	return (ini_parse(host, referenceHandler, launchdat) < 0) ? -1 : 0;
+}
+
+static int sameLaunchdat(launchdat_t *a, launchdat_t *b){
+	// Are two launchdat_t byte for byte the same, hardware flags included
+	
+	hwdata_t *hardware_a;
+	hwdata_t *hardware_b;
+	int same;
+	
+	hardware_a = a->hardware;
+	hardware_b = b->hardware;
+	a->hardware = NULL;
+	b->hardware = NULL;
+	same = (memcmp(a, b, sizeof(launchdat_t)) == 0) && (hardware_a->flags == hardware_b->flags);
+	a->hardware = hardware_a;
+	b->hardware = hardware_b;
+	return same;
+}
+
+static void randomValue(char *value){
+	/* A value of up to 250 characters; often a number, sometimes longer than any field */
+	
+	int n;
+	int i;
+	
+	n = test_Random(4) ? test_Random(40) : test_Random(250);
+	for(i = 0; i < n; i++){
+		value[i] = test_Random(3) ? '0' + test_Random(10) : 'a' + test_Random(26);
+	}
+	value[n] = '\0';
+}
+
+static void randomDat(char *buffer){
+	/* A launch.dat of random lines: every kind of key, in any order and section, with odd spacing */
+	
+	static const char *keys[] = { "name", "genre", "developer", "publisher", "year", "start", "alt_start", "images", "series",
+		"fpu", "cyberstick", "2hdboot", "midi_mpu", "midi_serial", "nam", "names", "unknown" };
+	static const char *sections[] = { "[default]", "[misc]", "[other]" };
+	char value[256];
+	char *p;
+	int lines;
+	int i;
+	
+	p = buffer;
+	lines = test_Random(30);
+	for(i = 0; i < lines; i++){
+		switch(test_Random(10)){
+			case(0):
+				p += sprintf(p, "%s\r\n", sections[test_Random(3)]);
+				break;
+			case(1):
+				p += sprintf(p, "; a comment\n");
+				break;
+			default:
+				randomValue(value);
+				p += sprintf(p, "%s%s%s%s%s\r\n", test_Random(4) ? "" : "  ", keys[test_Random(17)], test_Random(2) ? "=" : " = ", value, test_Random(5) ? "" : " ;note");
+		}
+	}
+	*p = '\0';
+}
+
+static void testIdentical(){
+	/* The field table fills in exactly the launchdat_t the strcmp() handler did, for real and random files */
+	
+	config_t config;
+	gamedir_t gamedir;
+	gametable_t gametable;
+	launchdat_t *launchdat;
+	launchdat_t *reference;
+	char path[TEST_PATH_SIZE];
+	char dat[30 * 300];
+	int same;
+	int i;
+	int k;
+	
+	test_MakeGames("Dats", 0, 200, 0);
+	test_Config(&config, &gamedir, "A:\\Dats", 0);
+	initGametable(&gametable);
+	TEST_CHECK(scanGamedirs(&config, &gametable, NULL, &test_scratch, NULL, NULL) == 200);
+	
+	// Both are reused from one file to the next, as the launcher does
+	launchdat = test_NewLaunchdat();
+	reference = test_NewLaunchdat();
+	same = 1;
+	for(i = 0; i < gametable.size; i++){
+		if ((getLaunchdata(&gametable.games[i], launchdat) != 0) || (referenceLaunchdata(&gametable.games[i], reference) != 0) || !sameLaunchdat(launchdat, reference)){
+			same = 0;
+		}
+	}
+	TEST_CHECK(same);
+	
+	// Random files, each written over the launch.dat of one of the games
+	same = 1;
+	for(k = 0; k < 5000; k++){
+		i = test_Random(gametable.size);
+		randomDat(dat);
+		sprintf(path, "Dats/%s/" GAMEDAT, gametable.games[i].dir);
+		test_WriteFile(path, dat);
+		if ((getLaunchdata(&gametable.games[i], launchdat) != referenceLaunchdata(&gametable.games[i], reference)) || !sameLaunchdat(launchdat, reference)){
+			if (same){
+				printf("ini: different launchdat_t from:\n%s\n", dat);
+			}
+			same = 0;
+		}
+	}
+	TEST_CHECK(same);
+	
+	test_FreeLaunchdat(launchdat);
+	test_FreeLaunchdat(reference);
+	removeGamedata(&gametable);
+	test_FreeConfig(&config);
+}
+
+// What a handler was given, in order, while parsing one ini text
+typedef struct {
+	char log[16384];
+	int len;
+} calls_t;
+
+static int recordHandler(void* user, const char* section, const char* name, const char* value){
+	// Log every call; a name starting with 'x' is an error, and "stop" ends the parse
+	
+	calls_t *calls = (calls_t *) user;
+	
+	if (calls->len < (int) sizeof(calls->log) - 1){
+		calls->len += snprintf(calls->log + calls->len, sizeof(calls->log) - calls->len, "[%s|%s|%s]", section, name, (value != NULL) ? value : "(null)");
+	}
+	if (strcmp(name, "stop") == 0){
+		return INI_STOP;
+	}
+	return name[0] != 'x';
+}
+
+static int randomIni(char *buffer){
+	/* Up to 60 random pieces of ini syntax, some lines longer than INI_MAX_LINE; returns the length */
+	
+	static const char *pieces[] = { "[default]", "[misc]", "[", "]", "name", "year", "x", "stop", "=", ":", " ", "\t",
+		";", "#", "\n", "\r\n", "\r", "value", "year=1987\n", "; comment\n",
+		"aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa" };
+	const char *piece;
+	int len;
+	int n;
+	
+	len = 0;
+	for(n = test_Random(60); n > 0; n--){
+		piece = pieces[test_Random(sizeof(pieces) / sizeof(pieces[0]))];
+		strcpy(buffer + len, piece);
+		len += strlen(piece);
+	}
+	buffer[len] = '\0';
+	return len;
+}
+
+static int parseStream(char *text, int len, ini_handler handler, void *user){
+	// Parse a text with ini_parse_stream(), reading it with fgets() as ini_parse() does
+	
+	FILE *f;
+	int status;
+	
+	f = fmemopen(text, len, "r");
+	if (f == NULL){
+		return -1;
+	}
+	status = ini_parse_stream((ini_reader) fgets, f, handler, user);
+	fclose(f);
+	return status;
+}
+
+static void testBuffer(){
+	/* ini_parse_buffer() makes the same handler calls, and returns the same, as ini_parse_stream() */
+	
+	static calls_t stream_calls;
+	static calls_t buffer_calls;
+	char text[60 * 128];
+	char buffer[60 * 128];
+	int stream_status;
+	int buffer_status;
+	int len;
+	int same;
+	int k;
+	
+	same = 1;
+	for(k = 0; k < 100000; k++){
+		len = randomIni(text);
+		
+		// The buffer is parsed in place, with a spare byte after the text
+		memcpy(buffer, text, len + 1);
+		stream_calls.len = 0;
+		buffer_calls.len = 0;
+		stream_status = parseStream(text, len, recordHandler, &stream_calls);
+		buffer_status = ini_parse_buffer(buffer, len, recordHandler, &buffer_calls);
+		if ((stream_status != buffer_status) || (stream_calls.len != buffer_calls.len) || (memcmp(stream_calls.log, buffer_calls.log, stream_calls.len) != 0)){
+			if (same){
+				printf("ini: stream %d, buffer %d from:\n%s\n%.*s\n%.*s\n", stream_status, buffer_status, text, stream_calls.len, stream_calls.log, buffer_calls.len, buffer_calls.log);
+			}
+			same = 0;
+		}
+	}
+	TEST_CHECK(same);
+}
+
+static void testSingleRead(){
+	/* Each launch.dat is read whole, with one DOS read and no seeks once the scan has found its size */
+	
+	config_t config;
+	gamedir_t gamedir;
+	gametable_t gametable;
+	gamedata_t *gamedata;
+	launchdat_t *launchdat;
+	char path[TEST_PATH_SIZE];
+	char dat[1024];
+	int loaded;
+	int empty;
+	int i;
+	
+	test_Config(&config, &gamedir, "A:\\Dats", 0);
+	initGametable(&gametable);
+	TEST_CHECK(scanGamedirs(&config, &gametable, NULL, &test_scratch, NULL, NULL) == 200);
+	launchdat = test_NewLaunchdat();
+	dosshim_Reset();
+	loaded = 0;
+	for(i = 0; i < gametable.size; i++){
+		loaded += (getLaunchdata(&gametable.games[i], launchdat) == 0);
+	}
+	TEST_CHECK(dosshim_calls.open == loaded);
+	TEST_CHECK(dosshim_calls.read == loaded);
+	TEST_CHECK(dosshim_calls.close == loaded);
+	
+	// The size comes from the scan, so only empty files are measured with two seeks
+	empty = 0;
+	for(i = 0; i < gametable.size; i++){
+		empty += (gametable.games[i].has_dat == 1) && (gametable.games[i].dat_size == 0);
+	}
+	TEST_CHECK(dosshim_calls.other == 2 * empty);
+	
+	// A file that has grown since the scan is measured too; one that has shrunk is still read in one go
+	for(gamedata = gametable.games; gamedata->has_dat == 0; gamedata++){
+	}
+	test_LaunchDat(dat, 0);
+	gamedata->dat_size = strlen(dat);
+	strcat(dat, "[default]\r\nseries=Grown since the scan\r\n");
+	sprintf(path, "Dats/%s/" GAMEDAT, gamedata->dir);
+	test_WriteFile(path, dat);
+	dosshim_Reset();
+	TEST_CHECK(getLaunchdata(gamedata, launchdat) == 0);
+	TEST_CHECK((strcmp(launchdat->series, "Grown since the scan") == 0) && (dosshim_calls.other == 2));
+	test_WriteFile(path, "[default]\r\nname=Shrunk\r\n");
+	dosshim_Reset();
+	TEST_CHECK(getLaunchdata(gamedata, launchdat) == 0);
+	TEST_CHECK((strcmp(launchdat->realname, "Shrunk") == 0) && (dosshim_calls.read == 1) && (dosshim_calls.other == 0));
+	
+	test_FreeLaunchdat(launchdat);
+	removeGamedata(&gametable);
+	test_FreeConfig(&config);
+}
+
+// Every launch.dat field, with its size in launchdat_t; a size of 0 is the year
+static const struct {
+	int mask;
+	const char *key;
+	int offset;
+	int size;
+} fields[] = {
+	{ LAUNCHDAT_NAME,		"name",			offsetof(launchdat_t, realname),	MAX_NAME_SIZE },
+	{ LAUNCHDAT_GENRE,		"genre",		offsetof(launchdat_t, genre),		MAX_STRING_SIZE },
+	{ LAUNCHDAT_YEAR,		"year",			offsetof(launchdat_t, year),		0 },
+	{ LAUNCHDAT_SERIES,		"series",		offsetof(launchdat_t, series),		MAX_STRING_SIZE },
+	{ LAUNCHDAT_PUBLISHER,	"publisher",	offsetof(launchdat_t, publisher),	MAX_STRING_SIZE },
+	{ LAUNCHDAT_DEVELOPER,	"developer",	offsetof(launchdat_t, developer),	MAX_STRING_SIZE },
+	{ LAUNCHDAT_START,		"start",		offsetof(launchdat_t, start),		MAX_FILENAME_SIZE },
+	{ LAUNCHDAT_ALT_START,	"alt_start",	offsetof(launchdat_t, alt_start),	MAX_FILENAME_SIZE },
+	{ LAUNCHDAT_IMAGES,		"images",		offsetof(launchdat_t, images),		IMAGE_BUFFER_SIZE },
+};
+
+#define FIELDS_SIZE (int)(sizeof(fields) / sizeof(fields[0]))
+
+static int sameFields(launchdat_t *loaded, launchdat_t *full, int mask){
+	// Does a partial load hold the fields of the full one in mask, and defaults for the rest
+	
+	char *a;
+	char *b;
+	int i;
+	
+	for(i = 0; i < FIELDS_SIZE; i++){
+		a = (char *) loaded + fields[i].offset;
+		b = (char *) full + fields[i].offset;
+		if (fields[i].size == 0){
+			if (*(int *) a != ((fields[i].mask & mask) ? *(int *) b : DEFAULT_YEAR)){
+				return 0;
+			}
+		} else if (strncmp(a, (fields[i].mask & mask) ? b : "", fields[i].size) != 0){
+			return 0;
+		}
+	}
+	return loaded->hardware->flags == ((mask & LAUNCHDAT_HARDWARE) ? full->hardware->flags : 0);
+}
+
+static void testFields(){
+	/* A load of some fields gives just those fields of a full load, whatever was loaded before */
+	
+	static const int masks[] = { LAUNCHDAT_NAME, LAUNCHDAT_GENRE, LAUNCHDAT_YEAR, LAUNCHDAT_IMAGES, LAUNCHDAT_HARDWARE,
+		LAUNCHDAT_NAME | LAUNCHDAT_SERIES, LAUNCHDAT_META, LAUNCHDAT_ALL };
+	config_t config;
+	gamedir_t gamedir;
+	gametable_t gametable;
+	launchdat_t *launchdat;
+	launchdat_t *full;
+	int same;
+	int i;
+	int m;
+	
+	test_MakeGames("Fields", 0, 100, 0);
+	test_Config(&config, &gamedir, "A:\\Fields", 0);
+	initGametable(&gametable);
+	TEST_CHECK(scanGamedirs(&config, &gametable, NULL, &test_scratch, NULL, NULL) == 100);
+	
+	launchdat = test_NewLaunchdat();
+	full = test_NewLaunchdat();
+	same = 1;
+	for(i = 0; i < gametable.size; i++){
+		for(m = 0; m < (int)(sizeof(masks) / sizeof(masks[0])); m++){
+			
+			// Another game first, so that anything left over would show
+			getLaunchdata(&gametable.games[(i + 1) % gametable.size], launchdat);
+			if ((getLaunchdata(&gametable.games[i], full) != 0) || (getLaunchdataFields(&gametable.games[i], launchdat, masks[m]) != 0) || !sameFields(launchdat, full, masks[m])){
+				same = 0;
+			}
+		}
+	}
+	TEST_CHECK(same);
+	
+	test_FreeLaunchdat(launchdat);
+	test_FreeLaunchdat(full);
+	removeGamedata(&gametable);
+	test_FreeConfig(&config);
+}
+
+// How far into a launch.dat a load of some fields gets
+typedef struct {
+	char *text;
+	int wanted;
+	int found;
+	int bytes;
+} reach_t;
+
+static int reachHandler(void* user, const char* section, const char* name, const char* value){
+	// Reference: note the end of each line, stopping as getLaunchdataFields() does once every field wanted is found
+	
+	reach_t *reach = (reach_t *) user;
+	int i;
+	
+	reach->bytes = (value + strlen(value)) - reach->text;
+	for(i = 0; i < FIELDS_SIZE; i++){
+		if ((strcmp(section, "default") == 0) && (strcmp(name, fields[i].key) == 0)){
+			reach->found |= fields[i].mask;
+		}
+	}
+	if ((reach->found & reach->wanted) == reach->wanted){
+		return INI_STOP;
+	}
+	return 1;
+}
+
+static void benchFields(){
+	/* Bytes parsed and time per launch.dat for the masks the launcher uses */
+	
+	static const struct {
+		const char *name;
+		int mask;
+	} masks[] = {
+		{ "NAME", LAUNCHDAT_NAME },
+		{ "GENRE", LAUNCHDAT_GENRE },
+		{ "META", LAUNCHDAT_META },
+		{ "ALL", LAUNCHDAT_ALL },
+	};
+	config_t config;
+	gamedir_t gamedir;
+	gametable_t gametable;
+	launchdat_t *launchdat;
+	reach_t reach;
+	char text[1024];
+	double start;
+	long bytes;
+	long total;
+	int i;
+	int m;
+	
+	test_MakeGames("Masks", 0, 2000, 0);
+	test_Config(&config, &gamedir, "A:\\Masks", 0);
+	initGametable(&gametable);
+	TEST_CHECK(scanGamedirs(&config, &gametable, NULL, &test_scratch, NULL, NULL) == 2000);
+	
+	launchdat = test_NewLaunchdat();
+	for(m = 0; m < (int)(sizeof(masks) / sizeof(masks[0])); m++){
+		bytes = 0;
+		total = 0;
+		for(i = 0; i < gametable.size; i++){
+			test_LaunchDat(text, gametable.games[i].gameid);
+			total += strlen(text);
+			reach.text = text;
+			reach.wanted = masks[m].mask;
+			reach.found = 0;
+			reach.bytes = 0;
+			ini_parse_buffer(text, strlen(text), reachHandler, &reach);
+			bytes += reach.bytes;
+		}
+		start = test_Seconds();
+		for(i = 0; i < gametable.size; i++){
+			getLaunchdataFields(&gametable.games[i], launchdat, masks[m].mask);
+		}
+		printf("ini: mask %-5s %3ld of %3ld bytes parsed, %.2fus per file\n", masks[m].name, bytes / gametable.size, total / gametable.size, (test_Seconds() - start) * 1e6 / gametable.size);
+	}
+	
+	test_FreeLaunchdat(launchdat);
+	removeGamedata(&gametable);
+	test_FreeConfig(&config);
+}
+
+static void benchBuffer(){
+	/* Parsing 100000 launch.dat texts in memory, from a buffer against through fgets() */
+	
+	static calls_t calls;
+	char text[1024];
+	char buffer[1024];
+	double start;
+	double buffer_time;
+	double stream_time;
+	int len;
+	int i;
+	
+	test_LaunchDat(text, 12);
+	len = strlen(text);
+	start = test_Seconds();
+	for(i = 0; i < 100000; i++){
+		calls.len = 0;
+		memcpy(buffer, text, len + 1);
+		ini_parse_buffer(buffer, len, recordHandler, &calls);
+	}
+	buffer_time = test_Seconds() - start;
+	start = test_Seconds();
+	for(i = 0; i < 100000; i++){
+		calls.len = 0;
+		parseStream(text, len, recordHandler, &calls);
+	}
+	stream_time = test_Seconds() - start;
+	printf("ini: 100000 x %d byte launch.dat, buffer %.4fs, stream %.4fs\n", len, buffer_time, stream_time);
+}
+
+static void benchParse(){
+	/* Parsing 10000 launch.dat files, with the field table against the strcmp() handler */
+	
+	config_t config;
+	gamedir_t gamedir;
+	gametable_t gametable;
+	launchdat_t *launchdat;
+	double start;
+	double table_time;
+	double reference_time;
+	int loaded;
+	int i;
+	
+	test_MakeGames("Bench", 0, 10000, 0);
+	test_Config(&config, &gamedir, "A:\\Bench", 0);
+	initGametable(&gametable);
+	TEST_CHECK(scanGamedirs(&config, &gametable, NULL, &test_scratch, NULL, NULL) == 10000);
+	
+	launchdat = test_NewLaunchdat();
+	loaded = 0;
+	start = test_Seconds();
+	for(i = 0; i < gametable.size; i++){
+		loaded += (getLaunchdata(&gametable.games[i], launchdat) == 0);
+	}
+	table_time = test_Seconds() - start;
+	start = test_Seconds();
+	for(i = 0; i < gametable.size; i++){
+		loaded += (referenceLaunchdata(&gametable.games[i], launchdat) == 0);
+	}
+	reference_time = test_Seconds() - start;
+	TEST_CHECK(loaded == 20000);
+	printf("ini: 10000 launch.dat, field table %.4fs, line at a time with the strcmp() handler %.4fs\n", table_time, reference_time);
+	
+	test_FreeLaunchdat(launchdat);
+	removeGamedata(&gametable);
+	test_FreeConfig(&config);
+}
+
+int main(int argc, char **argv){
+	test_Init(argc, argv);
+	test_Root("ini");
+	testIdentical();
+	testBuffer();
+	testSingleRead();
+	testFields();
+	if (test_bench){
+		benchParse();
+		benchBuffer();
+		benchFields();
+	}
+	return test_Done("ini");
+}
@@ -0,0 +1,498 @@
+/* test_meta.c, Host tests of the metadata index for x68Launcher.
+ Copyright (C) 2020  John Snowdon
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "test.h"
+
+static void testIndex(){
+	/* The index holds what a full parse of each launch.dat gives, and is only read from disk once */
+	
+	config_t config;
+	gamedir_t gamedir;
+	gametable_t gametable;
+	gamedata_t *gamedata;
+	launchdat_t *launchdat;
+	launchdat_t *reference;
+	metaindex_t *meta;
+	int gameid;
+	int same;
+	int i;
+	
+	test_MakeGames("Meta", 0, 300, 4);
+	test_Config(&config, &gamedir, "A:\\Meta", 0);
+	initGametable(&gametable);
+	TEST_CHECK(scanGamedirs(&config, &gametable, NULL, &test_scratch, NULL, NULL) == 300);
+	
+	meta = &gametable.meta;
+	TEST_CHECK(meta->size == gametable.ids_size);
+	TEST_CHECK(memchr(meta->state, META_STATE_LOADED, meta->size) == NULL);
+	
+	// One open of each launch.dat, and nothing for the games without one
+	launchdat = test_NewLaunchdat();
+	dosshim_Reset();
+	TEST_CHECK(meta_LoadAll(meta, &gametable, launchdat) == 225);
+	TEST_CHECK(dosshim_calls.open == 225);
+	
+	reference = test_NewLaunchdat();
+	same = 1;
+	for(i = 0; i < gametable.size; i++){
+		gamedata = &gametable.games[i];
+		gameid = gamedata->gameid;
+		if (gamedata->has_dat == 0){
+			if (meta->state[gameid] == META_STATE_LOADED){
+				same = 0;
+			}
+			continue;
+		}
+		if ((getLaunchdata(gamedata, reference) != 0) || (meta->state[gameid] != META_STATE_LOADED)){
+			same = 0;
+			continue;
+		}
+		if ((strcmp(meta_String(meta, meta->genre[gameid]), reference->genre) != 0)
+			|| (strcmp(meta_String(meta, meta->series[gameid]), reference->series) != 0)
+			|| (strcmp(meta_String(meta, meta->developer[gameid]), reference->developer) != 0)
+			|| (strcmp(meta_String(meta, meta->publisher[gameid]), reference->publisher) != 0)
+			|| (meta->year[gameid] != reference->year) || (meta->hardware[gameid] != reference->hardware->flags)){
+			same = 0;
+		}
+	}
+	TEST_CHECK(same);
+	
+	// After the first time, everything comes from the index
+	dosshim_Reset();
+	TEST_CHECK(meta_LoadAll(meta, &gametable, launchdat) == 225);
+	TEST_CHECK(dosshim_Total() == 0);
+	
+	// A rescan starts again, keeping the string ids
+	i = meta_Find(meta, (char *) test_genres[1]);
+	TEST_CHECK(indexGamedata(&gametable) == 300);
+	TEST_CHECK(memchr(meta->state, META_STATE_LOADED, meta->size) == NULL);
+	TEST_CHECK(meta_Find(meta, (char *) test_genres[1]) == i);
+	
+	test_FreeLaunchdat(launchdat);
+	test_FreeLaunchdat(reference);
+	removeGamedata(&gametable);
+	test_FreeConfig(&config);
+}
+
+static int referenceGenres(gametable_t *gametable, launchdat_t *launchdat, char (*genres)[MAX_STRING_SIZE]){
+	// Reference: read every launch.dat and list the genres with a linear search, as filter_GetGenres() used to
+	
+	int n;
+	int i;
+	int j;
+	
+	n = 0;
+	for(i = 0; i < gametable->size; i++){
+		if ((gametable->games[i].has_dat == 0) || (getLaunchdata(&gametable->games[i], launchdat) != 0) || (launchdat->genre[0] == '\0')){
+			continue;
+		}
+		for(j = 0; j < n; j++){
+			if (strcmp(genres[j], launchdat->genre) == 0){
+				break;
+			}
+		}
+		if (j == n){
+			strcpy(genres[n], launchdat->genre);
+			n++;
+		}
+	}
+	return n;
+}
+
+static int referenceGenre(gametable_t *gametable, launchdat_t *launchdat, char *genre, int *list){
+	// Reference: read every launch.dat again and keep the games of one genre, as filter_Genre() used to
+	
+	int n;
+	int i;
+	
+	n = 0;
+	for(i = 0; i < gametable->size; i++){
+		if ((gametable->games[i].has_dat == 1) && (getLaunchdata(&gametable->games[i], launchdat) == 0) && (strcmp(launchdat->genre, genre) == 0)){
+			list[n] = gametable->games[i].gameid;
+			n++;
+		}
+	}
+	return n;
+}
+
+static void benchIndex(){
+	/* Listing and applying a genre filter on 5000 games, from the index and by reading every launch.dat */
+	
+	config_t config;
+	gamedir_t gamedir;
+	gametable_t gametable;
+	state_t state;
+	launchdat_t *launchdat;
+	char (*genres)[MAX_STRING_SIZE];
+	char genre[MAX_STRING_SIZE];
+	int *list;
+	double start;
+	double first_time;
+	double index_time;
+	double reference_time;
+	int genres_size;
+	int n;
+	int r;
+	
+	test_MakeGames("Bench", 1000, 5000, 4);
+	test_Config(&config, &gamedir, "A:\\Bench", 1);
+	initGametable(&gametable);
+	TEST_CHECK(scanGamedirs(&config, &gametable, NULL, &test_scratch, NULL, NULL) == 5000);
+	filter_StateInit(&state);
+	launchdat = test_NewLaunchdat();
+	filter_None(&state, &gametable);
+	
+	// The first filter reads every launch.dat into the index
+	start = test_Seconds();
+	filter_GetGenres(&state, &gametable, launchdat);
+	strcpy(genre, state.filter_strings[0]);
+	genres_size = state.available_filter_strings;
+	filter_Genre(&state, &gametable, launchdat);
+	first_time = test_Seconds() - start;
+	n = state.selected_max;
+	
+	start = test_Seconds();
+	for(r = 0; r < 10; r++){
+		filter_GetGenres(&state, &gametable, launchdat);
+		filter_Genre(&state, &gametable, launchdat);
+	}
+	index_time = (test_Seconds() - start) / 10;
+	
+	genres = malloc(100 * MAX_STRING_SIZE);
+	list = (int *) malloc(5000 * sizeof(int));
+	start = test_Seconds();
+	TEST_CHECK(referenceGenres(&gametable, launchdat, genres) == genres_size);
+	TEST_CHECK(referenceGenre(&gametable, launchdat, genre, list) == n);
+	TEST_CHECK(memcmp(list, state.selected_list, n * sizeof(int)) == 0);
+	reference_time = test_Seconds() - start;
+	printf("meta: genre list and filter of 5000 games, first %.4fs then %.6fs from the index; %.4fs reading every launch.dat\n", first_time, index_time, reference_time);
+	
+	free(genres);
+	free(list);
+	free(state.selected_list);
+	free(state.filter_bits);
+	test_FreeLaunchdat(launchdat);
+	removeGamedata(&gametable);
+	test_FreeConfig(&config);
+}
+
+static int bruteYears(metaindex_t *meta, int from, int to, unsigned long *bits){
+	// Reference: test the year of every game in turn
+	
+	int n;
+	int g;
+	
+	n = 0;
+	for(g = 0; g < meta->size; g++){
+		if ((meta->state[g] == META_STATE_LOADED) && (meta->year[g] > 0) && (meta->year[g] >= from) && (meta->year[g] <= to)){
+			bits[g / META_BITSET_BITS] |= 1UL << (g % META_BITSET_BITS);
+			n++;
+		}
+	}
+	return n;
+}
+
+static void testYears(){
+	/* Every range of years selects the same games as testing the year of each game */
+	
+	gametable_t gametable;
+	state_t state;
+	launchdat_t *launchdat;
+	unsigned long *bits;
+	unsigned long *expected;
+	int words;
+	int same;
+	int from;
+	int to;
+	int count;
+	int n;
+	int i;
+	int g;
+	
+	initGametable(&gametable);
+	test_Games(&gametable, 3000);
+	test_Metadata(&gametable);
+	for(g = 0; g < gametable.meta.size; g += 17){
+		gametable.meta.state[g] = META_STATE_MISSING;
+	}
+	TEST_CHECK(meta_BuildYears(&gametable.meta) == META_OK);
+	
+	// Sorted by year, then gameid, with every game that has a year
+	n = 0;
+	for(g = 0; g < gametable.meta.size; g++){
+		if ((gametable.meta.state[g] == META_STATE_LOADED) && (gametable.meta.year[g] > 0)){
+			n++;
+		}
+	}
+	TEST_CHECK(gametable.meta.years_size == n);
+	same = 1;
+	for(i = 1; i < gametable.meta.years_size; i++){
+		if ((gametable.meta.years[i - 1].year > gametable.meta.years[i].year) || ((gametable.meta.years[i - 1].year == gametable.meta.years[i].year) && (gametable.meta.years[i - 1].gameid >= gametable.meta.years[i].gameid))){
+			same = 0;
+		}
+	}
+	TEST_CHECK(same);
+	
+	// Every range from before the first year to after the last, including empty ones
+	words = meta_BitsetWords(&gametable.meta);
+	bits = (unsigned long *) malloc(words * sizeof(unsigned long));
+	expected = (unsigned long *) malloc(words * sizeof(unsigned long));
+	same = 1;
+	for(from = 1980; from <= 2005; from++){
+		for(to = from - 1; to <= 2005; to++){
+			memset(bits, 0, words * sizeof(unsigned long));
+			memset(expected, 0, words * sizeof(unsigned long));
+			n = meta_BitsetYears(&gametable.meta, from, to, bits);
+			if ((n != bruteYears(&gametable.meta, from, to, expected)) || (memcmp(bits, expected, words * sizeof(unsigned long)) != 0)){
+				same = 0;
+			}
+		}
+	}
+	TEST_CHECK(same);
+	
+	// The histogram: each decade, then each of its years, with the games of each
+	filter_StateInit(&state);
+	launchdat = test_NewLaunchdat();
+	TEST_CHECK(filter_GetYears(&state, &gametable, launchdat) == FILTER_OK);
+	TEST_CHECK(state.available_filter_strings == 2 + 13);
+	same = 1;
+	for(i = 0; i < state.available_filter_strings; i++){
+		if (sscanf(state.filter_strings[i], FILTER_STRING_YEARS, &from, &to) == 1){
+			to = from;
+		}
+		memset(expected, 0, words * sizeof(unsigned long));
+		if (state.filter_counts[i] != bruteYears(&gametable.meta, from, to, expected)){
+			same = 0;
+		}
+	}
+	TEST_CHECK(same);
+	TEST_CHECK(strcmp(state.filter_strings[0], "1980-1989") == 0);
+	TEST_CHECK(strcmp(state.filter_strings[1], "1987") == 0);
+	
+	// Choosing the 1990s, then a single year
+	memset(expected, 0, words * sizeof(unsigned long));
+	count = bruteYears(&gametable.meta, 1990, 1999, expected);
+	state.selected_filter_string = 4;
+	TEST_CHECK(strcmp(state.filter_strings[4], "1990-1999") == 0);
+	TEST_CHECK(filter_Year(&state, &gametable, launchdat) == FILTER_OK);
+	same = (state.selected_max == count);
+	for(i = 0; (i < state.selected_max) && same; i++){
+		g = state.selected_list[i];
+		same = ((expected[g / META_BITSET_BITS] & (1UL << (g % META_BITSET_BITS))) != 0);
+	}
+	TEST_CHECK(same);
+	filter_GetYears(&state, &gametable, launchdat);
+	state.selected_filter_string = 1;
+	memset(expected, 0, words * sizeof(unsigned long));
+	TEST_CHECK(filter_Year(&state, &gametable, launchdat) == FILTER_OK);
+	TEST_CHECK(state.selected_max == bruteYears(&gametable.meta, 1987, 1987, expected));
+	
+	// A change of year throws the index away, to be built again when next needed
+	launchdat->year = 2001;
+	g = gametable.meta.years[0].gameid;
+	launchdat->hardware->flags = gametable.meta.hardware[g];
+	strcpy(launchdat->genre, meta_String(&gametable.meta, gametable.meta.genre[g]));
+	meta_Update(&gametable.meta, g, launchdat);
+	TEST_CHECK(gametable.meta.years == NULL);
+	TEST_CHECK(meta_BuildYears(&gametable.meta) == META_OK);
+	TEST_CHECK(gametable.meta.years[gametable.meta.years_size - 1].gameid == g);
+	
+	free(bits);
+	free(expected);
+	free(state.selected_list);
+	free(state.filter_bits);
+	filter_ClearStrings(&state);
+	free(state.filter_strings);
+	free(state.filter_counts);
+	free(state.filter_strings_selected);
+	for(i = 0; i < FILTER_CACHE_SIZE; i++){
+		free(state.filter_cache[i].bits);
+		free(state.filter_cache[i].list);
+	}
+	test_FreeLaunchdat(launchdat);
+	removeGamedata(&gametable);
+}
+
+static void benchYears(){
+	/* Range queries of 10000 games, with the year index and testing each game */
+	
+	gametable_t gametable;
+	unsigned long *bits;
+	double start;
+	double build_time;
+	double index_time;
+	double brute_time;
+	long total;
+	int words;
+	int r;
+	
+	initGametable(&gametable);
+	test_Games(&gametable, 10000);
+	test_Metadata(&gametable);
+	words = meta_BitsetWords(&gametable.meta);
+	bits = (unsigned long *) calloc(words, sizeof(unsigned long));
+	
+	start = test_Seconds();
+	meta_BuildYears(&gametable.meta);
+	build_time = test_Seconds() - start;
+	total = 0;
+	start = test_Seconds();
+	for(r = 0; r < 1000; r++){
+		total += meta_BitsetYears(&gametable.meta, 1987 + (r % 13), 1990 + (r % 13), bits);
+	}
+	index_time = (test_Seconds() - start) / 1000;
+	start = test_Seconds();
+	for(r = 0; r < 1000; r++){
+		total -= bruteYears(&gametable.meta, 1987 + (r % 13), 1990 + (r % 13), bits);
+	}
+	brute_time = (test_Seconds() - start) / 1000;
+	TEST_CHECK(total == 0);
+	printf("meta: year index of 10000 games built in %.5fs, range query %.6fs, testing each game %.6fs\n", build_time, index_time, brute_time);
+	
+	free(bits);
+	removeGamedata(&gametable);
+}
+
+static void testHardware(){
+	/* Every hardware key in launch.dat sets its own flag, and a mask matches only the games with all of its flags */
+	
+	static const struct {
+		const char *section;
+		const char *key;
+		unsigned char flag;
+	} keys[] = {
+		{ "misc", "fpu", META_HW_FPU },
+		{ "misc", "cyberstick", META_HW_CYBERSTICK },
+		{ "misc", "2hdsim", META_HW_2HDSIM },
+		{ "misc", "2hdboot", META_HW_2HDBOOT },
+		{ "default", "midi_mpu", META_HW_MIDI },
+		{ "default", "midi_serial", META_HW_MIDI_SERIAL },
+	};
+	config_t config;
+	gamedir_t gamedir;
+	gametable_t gametable;
+	launchdat_t *launchdat;
+	unsigned long bits[(64 + META_BITSET_BITS - 1) / META_BITSET_BITS];
+	char path[TEST_PATH_SIZE];
+	char dat[1024];
+	char line[64];
+	int gameid;
+	int mask;
+	int same;
+	int dir;
+	int n;
+	int i;
+	int g;
+	
+	// The table of keys
+	same = 1;
+	for(i = 0; i < META_HW_BITS; i++){
+		if ((meta_HardwareKey(keys[i].section, keys[i].key) != keys[i].flag) || (keys[i].flag != (1 << i))){
+			same = 0;
+		}
+		if (meta_HardwareFlag(meta_HardwareName(i)) != (1 << i)){
+			same = 0;
+		}
+	}
+	TEST_CHECK(same);
+	TEST_CHECK(meta_HardwareKey("misc", "joystick") == 0);
+	TEST_CHECK(meta_HardwareKey("default", "fpu") == 0);
+	TEST_CHECK((meta_HardwareName(-1) == NULL) && (meta_HardwareName(META_HW_BITS) == NULL));
+	TEST_CHECK(meta_HardwareFlag("Misc: Joystick") == 0);
+	
+	// Game i has the flags of mask i; unset flags are sometimes 0 and sometimes left out
+	test_MakeGames("Hardware", 0, 64, 1);
+	for(i = 0; i < 64; i++){
+		strcpy(dat, "[default]\r\nname=Hardware\r\n");
+		for(dir = 0; dir < 2; dir++){
+			if (dir == 1){
+				strcat(dat, "[misc]\r\n");
+			}
+			for(n = 0; n < META_HW_BITS; n++){
+				if ((strcmp(keys[n].section, "misc") == 0) != dir){
+					continue;
+				}
+				if (i & keys[n].flag){
+					sprintf(line, "%s=1\r\n", keys[n].key);
+					strcat(dat, line);
+				} else if ((i + n) % 2){
+					sprintf(line, "%s=0\r\n", keys[n].key);
+					strcat(dat, line);
+				}
+			}
+		}
+		sprintf(path, "Hardware/GAME%04d/" GAMEDAT, i);
+		test_WriteFile(path, dat);
+	}
+	test_Config(&config, &gamedir, "A:\\Hardware", 0);
+	initGametable(&gametable);
+	TEST_CHECK(scanGamedirs(&config, &gametable, NULL, &test_scratch, NULL, NULL) == 64);
+	launchdat = test_NewLaunchdat();
+	TEST_CHECK(meta_LoadAll(&gametable.meta, &gametable, launchdat) == 64);
+	same = 1;
+	for(g = 0; g < gametable.size; g++){
+		sscanf(gametable.games[g].dir, "GAME%d", &i);
+		if (gametable.meta.hardware[gametable.games[g].gameid] != i){
+			same = 0;
+		}
+	}
+	TEST_CHECK(same);
+	
+	// Every mask, each of which matches the games with all of its flags and maybe more
+	same = 1;
+	for(mask = 0; mask < 64; mask++){
+		memset(bits, 0, sizeof(bits));
+		meta_BitsetHardware(&gametable.meta, mask, bits);
+		n = 0;
+		for(g = 0; g < gametable.size; g++){
+			sscanf(gametable.games[g].dir, "GAME%d", &i);
+			gameid = gametable.games[g].gameid;
+			if (((bits[gameid / META_BITSET_BITS] & (1UL << (gameid % META_BITSET_BITS))) != 0) != ((i & mask) == mask)){
+				same = 0;
+			}
+			n += ((i & mask) == mask);
+		}
+		
+		// One game for each combination of the flags not in the mask
+		for(i = mask; i != 0; i >>= 1){
+			if (i & 1){
+				n *= 2;
+			}
+		}
+		if (n != 64){
+			same = 0;
+		}
+	}
+	TEST_CHECK(same);
+	
+	test_FreeLaunchdat(launchdat);
+	removeGamedata(&gametable);
+	test_FreeConfig(&config);
+}
+
+int main(int argc, char **argv){
+	test_Init(argc, argv);
+	test_Root("meta");
+	testIndex();
+	testYears();
+	testHardware();
+	if (test_bench){
+		benchIndex();
+		benchYears();
+	}
+	return test_Done("meta");
+}
@@ -0,0 +1,259 @@
+/* test_prefetch.c, Host tests of the idle-time prefetch scheduler for x68Launcher.
+ Copyright (C) 2020  John Snowdon
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "test.h"
+#include "prefetch.h"
+
+// Fake clock and keyboard; each step of work takes fake_cost ticks
+static long int fake_now = 0;
+static long int fake_cost = 3;
+static int fake_pressed = 0;
+static int fake_press_after = -1;		// Press a key once this many more steps are done; -1 for never
+static int fake_skip = -1;				// Game id whose launch.dat step finds nothing more to do
+
+// Every step carried out, in order
+static int work_gameids[256];
+static int work_steps[256];
+static long int work_started[256];
+static int work_size = 0;
+
+static long int fakeClock(){
+	// Current time, in ticks
+	
+	return fake_now;
+}
+
+static int fakePending(){
+	// Is a key being pressed
+	
+	return fake_pressed;
+}
+
+static int fakeWork(void *user, int gameid, int step){
+	// Log a step, then let the time it takes pass and maybe press a key
+	
+	if (work_size < 256){
+		work_gameids[work_size] = gameid;
+		work_steps[work_size] = step;
+		work_started[work_size] = fake_now;
+		work_size++;
+	}
+	fake_now += fake_cost;
+	if (fake_press_after > 0){
+		fake_press_after--;
+		if (fake_press_after == 0){
+			fake_pressed = 1;
+		}
+	}
+	return (gameid == fake_skip) ? PREFETCH_SKIP : PREFETCH_OK;
+}
+
+static void fakeReset(long int cost){
+	// Start again with an empty log and nothing pressed
+	
+	fake_now = 1000;
+	fake_cost = cost;
+	fake_pressed = 0;
+	fake_press_after = -1;
+	fake_skip = -1;
+	work_size = 0;
+}
+
+static int sameQueue(prefetch_t *prefetch, const int *gameids, int size){
+	// Is the queue exactly these games, in this order
+	
+	int i;
+	
+	if (prefetch->size != size){
+		return 0;
+	}
+	for(i = 0; i < size; i++){
+		if (prefetch->gameids[i] != gameids[i]){
+			return 0;
+		}
+	}
+	return 1;
+}
+
+static void testPlan(){
+	/* Games are queued in the order the browser keys reach them, at either end of a page and of the list */
+	
+	static const int top[] = { 1, 20, 10, 2, 3, 4, 5, 6 };
+	static const int bottom_line[] = { 10, 8, 20, 11, 7, 12, 6, 13 };
+	static const int last[] = { 0, 23, 10, 22, 21, 20, 19, 18 };
+	static const int middle[] = { 118, 112, 130, 160, 121, 109, 124, 106 };
+	prefetch_t prefetch;
+	int list[25];
+	int ids[25];
+	int same;
+	int pos;
+	int i;
+	int j;
+	
+	for(i = 0; i < 25; i++){
+		list[i] = i;
+		ids[i] = 100 + i * 3;
+	}
+	prefetch_Init(&prefetch, 10, fakeClock, fakePending, fakeWork, NULL);
+	
+	// 25 games, 10 lines a page: the top of the list, the bottom line of a page, the last game
+	prefetch_Plan(&prefetch, list, 25, 0, 10);
+	TEST_CHECK(sameQueue(&prefetch, top, 8));
+	prefetch_Plan(&prefetch, list, 25, 9, 10);
+	TEST_CHECK(sameQueue(&prefetch, bottom_line, 8));
+	prefetch_Plan(&prefetch, list, 25, 24, 10);
+	TEST_CHECK(sameQueue(&prefetch, last, 8));
+	
+	// Game ids are queued, not positions
+	prefetch_Plan(&prefetch, ids, 25, 5, 10);
+	TEST_CHECK(sameQueue(&prefetch, middle, 8));
+	
+	// Never the game under the cursor, and never one twice, wherever it is
+	same = 1;
+	for(pos = 0; pos < 25; pos++){
+		prefetch_Plan(&prefetch, list, 25, pos, 7);
+		if ((prefetch.size != PREFETCH_MAX) || (prefetch.next != 0) || (prefetch.step != PREFETCH_STEP_META)){
+			same = 0;
+		}
+		for(i = 0; i < prefetch.size; i++){
+			if (prefetch.gameids[i] == pos){
+				same = 0;
+			}
+			for(j = 0; j < i; j++){
+				if (prefetch.gameids[i] == prefetch.gameids[j]){
+					same = 0;
+				}
+			}
+		}
+	}
+	TEST_CHECK(same);
+	
+	// Short lists: nothing else to read, or only one other game
+	prefetch_Plan(&prefetch, list, 1, 0, 10);
+	TEST_CHECK(prefetch.size == 0);
+	prefetch_Plan(&prefetch, list, 2, 0, 10);
+	TEST_CHECK((prefetch.size == 1) && (prefetch.gameids[0] == 1));
+	prefetch_Plan(&prefetch, list, 25, 25, 10);
+	TEST_CHECK(prefetch.size == 0);
+}
+
+static void testBudget(){
+	/* The budget is checked before each step, and each run carries on where the last one stopped */
+	
+	prefetch_t prefetch;
+	int list[25];
+	int order;
+	int same;
+	int i;
+	
+	for(i = 0; i < 25; i++){
+		list[i] = i;
+	}
+	
+	// 3 ticks a step with 10 to spend: steps start at 0, 3, 6 and 9 ticks
+	fakeReset(3);
+	prefetch_Init(&prefetch, 10, fakeClock, fakePending, fakeWork, NULL);
+	prefetch_Plan(&prefetch, list, 25, 4, 10);
+	TEST_CHECK(prefetch_Run(&prefetch) == 4);
+	same = 1;
+	for(i = 0; i < work_size; i++){
+		if (work_started[i] - 1000 >= 10){
+			same = 0;
+		}
+	}
+	TEST_CHECK(same);
+	TEST_CHECK(fake_now - 1000 == 12);
+	
+	// A step slower than the budget is still finished, but is the only one
+	fake_cost = 25;
+	TEST_CHECK(prefetch_Run(&prefetch) == 1);
+	fake_cost = 3;
+	
+	// The rest of the queue, in order: the launch.dat then the artwork of each game
+	while (prefetch_Run(&prefetch) > 0){
+	}
+	TEST_CHECK(work_size == 2 * PREFETCH_MAX);
+	TEST_CHECK(prefetch.steps == work_size);
+	order = 1;
+	for(i = 0; i < work_size; i++){
+		if ((work_gameids[i] != prefetch.gameids[i / 2]) || (work_steps[i] != ((i % 2) ? PREFETCH_STEP_ART : PREFETCH_STEP_META))){
+			order = 0;
+		}
+	}
+	TEST_CHECK(order);
+	TEST_CHECK(prefetch_Run(&prefetch) == 0);
+	
+	// A game with nothing to read ahead gives up its artwork step
+	fakeReset(1);
+	fake_skip = 5;
+	prefetch.budget = 1000;
+	prefetch_Plan(&prefetch, list, 25, 4, 10);
+	TEST_CHECK(prefetch_Run(&prefetch) == 2 * PREFETCH_MAX - 1);
+	TEST_CHECK((work_gameids[0] == 5) && (work_gameids[1] != 5));
+	
+	// No budget means no prefetching at all
+	fakeReset(3);
+	prefetch_Init(&prefetch, 0, fakeClock, fakePending, fakeWork, NULL);
+	prefetch_Plan(&prefetch, list, 25, 4, 10);
+	TEST_CHECK(prefetch_Run(&prefetch) == 0);
+	TEST_CHECK(work_size == 0);
+}
+
+static void testInput(){
+	/* Anything pressed stops prefetching before the next step, and a new cursor position starts again */
+	
+	prefetch_t prefetch;
+	int list[25];
+	int i;
+	
+	for(i = 0; i < 25; i++){
+		list[i] = i;
+	}
+	fakeReset(3);
+	prefetch_Init(&prefetch, 1000, fakeClock, fakePending, fakeWork, NULL);
+	prefetch_Plan(&prefetch, list, 25, 12, 10);
+	
+	// Pressed already: nothing is done
+	fake_pressed = 1;
+	TEST_CHECK(prefetch_Run(&prefetch) == 0);
+	TEST_CHECK(work_size == 0);
+	
+	// Pressed during the second step: that step finishes, and no more
+	fake_pressed = 0;
+	fake_press_after = 2;
+	TEST_CHECK(prefetch_Run(&prefetch) == 2);
+	TEST_CHECK((prefetch.next == 1) && (prefetch.step == PREFETCH_STEP_META));
+	
+	// Released: carries on with the next game
+	fake_pressed = 0;
+	TEST_CHECK(prefetch_Run(&prefetch) == 2 * PREFETCH_MAX - 2);
+	TEST_CHECK(work_gameids[2] == prefetch.gameids[1]);
+	
+	// The cursor moved: a new queue from the start; cancelled, nothing
+	prefetch_Plan(&prefetch, list, 25, 13, 10);
+	TEST_CHECK((prefetch.next == 0) && (prefetch.gameids[0] == 14));
+	prefetch_Cancel(&prefetch);
+	TEST_CHECK(prefetch_Run(&prefetch) == 0);
+}
+
+int main(int argc, char **argv){
+	test_Init(argc, argv);
+	testPlan();
+	testBudget();
+	testInput();
+	return test_Done("prefetch");
+}
@@ -0,0 +1,212 @@
+/* test_scan.c, Host tests of game directory scanning for x68Launcher.
+ Copyright (C) 2020  John Snowdon
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "test.h"
+
+static int sameGames(gametable_t *a, gametable_t *b){
+	/* Check that two game tables hold the same games, in the same order */
+	
+	char path_a[MAX_PATH_SIZE];
+	char path_b[MAX_PATH_SIZE];
+	gamedata_t *ga;
+	gamedata_t *gb;
+	int i;
+	
+	if (a->size != b->size){
+		return 0;
+	}
+	for(i = 0; i < a->size; i++){
+		ga = &a->games[i];
+		gb = &b->games[i];
+		getGamedataPath(ga, path_a);
+		getGamedataPath(gb, path_b);
+		if ((ga->gameid != gb->gameid) || (strcmp(path_a, path_b) != 0) || (strcmp(ga->name, gb->name) != 0)){
+			return 0;
+		}
+		if ((ga->has_dat != gb->has_dat) || (ga->dat_size != gb->dat_size) || (ga->stamp != gb->stamp)){
+			return 0;
+		}
+	}
+	return 1;
+}
+
+static void testRescan(){
+	/* Rescan a tree with a few changed game directories, re-using the rest */
+	
+	config_t config;
+	gamedir_t gamedir;
+	gametable_t first;
+	gametable_t rescan;
+	gametable_t full;
+	gamedata_t *gamedata;
+	char path[TEST_PATH_SIZE];
+	long full_opens;
+	int i;
+	
+	test_MakeGames("Games", 0, 200, 5);
+	test_MakeGames("More", 200, 50, 0);
+	for(i = 0; i < 250; i++){
+		sprintf(path, "%s/GAME%04d", (i < 200) ? "Games" : "More", i);
+		test_SetTime(path, 0);
+	}
+	test_Config(&config, &gamedir, "A:\\Games,A:\\More", 1);
+	
+	initGametable(&first);
+	dosshim_Reset();
+	TEST_CHECK(scanGamedirs(&config, &first, NULL, &test_scratch, NULL, NULL) == 250);
+	full_opens = dosshim_calls.open;
+	
+	// Three games get a new launch.dat, two are added and one is removed
+	for(i = 10; i < 40; i += 10){
+		sprintf(path, "Games/GAME%04d/" GAMEDAT, i);
+		test_WriteFile(path, "[default]\r\nname=Zzz Renamed\r\n");
+		sprintf(path, "Games/GAME%04d", i);
+		test_SetTime(path, 20);
+	}
+	test_MakeGame("More", 250, 1);
+	test_MakeGame("More", 251, 1);
+	test_HostPath("More/GAME0249/" GAMEDAT, path);
+	unlink(path);
+	test_HostPath("More/GAME0249", path);
+	rmdir(path);
+	test_SetTime("More", 20);
+	
+	initGametable(&rescan);
+	dosshim_Reset();
+	TEST_CHECK(scanGamedirs(&config, &rescan, &first, &test_scratch, NULL, NULL) == 251);
+	
+	// Only the new and changed games are read; plus one isDir() per search path
+	TEST_CHECK(dosshim_calls.open == 2 + 3 + 2);
+	TEST_CHECK(dosshim_calls.open < full_opens);
+	gamedata = &rescan.games[rescan.size - 1];
+	TEST_CHECK(strcmp(gamedata->name, "Zzz Renamed") == 0);
+	
+	// Same result as scanning everything again
+	initGametable(&full);
+	TEST_CHECK(scanGamedirs(&config, &full, NULL, &test_scratch, NULL, NULL) == 251);
+	TEST_CHECK(sameGames(&rescan, &full));
+	
+	removeGamedata(&first);
+	removeGamedata(&rescan);
+	removeGamedata(&full);
+	test_FreeConfig(&config);
+}
+
+static void testDiscovery(){
+	/* launch.dat is found, with its size, by listing each game directory once */
+	
+	config_t config;
+	gamedir_t gamedir;
+	gametable_t gametable;
+	gamedata_t *gamedata;
+	char path[TEST_PATH_SIZE];
+	char host[TEST_PATH_SIZE];
+	struct stat st;
+	int sizes_ok;
+	int dats;
+	int i;
+	
+	test_MakeGames("Found", 500, 100, 4);
+	test_Config(&config, &gamedir, "A:\\Found", 0);
+	
+	initGametable(&gametable);
+	dosshim_Reset();
+	TEST_CHECK(scanGamedirs(&config, &gametable, NULL, &test_scratch, NULL, NULL) == 100);
+	
+	// No file is opened, other than by isDir(); one listing of the search path, one
+	// exnfiles per entry and one lookup of launch.dat per game
+	TEST_CHECK(dosshim_calls.open == 1);
+	TEST_CHECK(dosshim_calls.read == 0);
+	TEST_CHECK(dosshim_calls.files <= 1 + 100 + 2 + 100 + 2);
+	printf("scan: %.2f DOS calls per game without preload_names\n", dosshim_Total() / 100.0);
+	
+	sizes_ok = 1;
+	dats = 0;
+	for(i = 0; i < gametable.size; i++){
+		gamedata = &gametable.games[i];
+		sprintf(path, "Found/%s/" GAMEDAT, gamedata->dir);
+		test_HostPath(path, host);
+		if (stat(host, &st) == 0){
+			dats++;
+			if ((gamedata->has_dat != 1) || (gamedata->dat_size != st.st_size)){
+				sizes_ok = 0;
+			}
+		} else if ((gamedata->has_dat != 0) || (gamedata->dat_size != 0)){
+			sizes_ok = 0;
+		}
+	}
+	TEST_CHECK(dats == 75);
+	TEST_CHECK(sizes_ok);
+	
+	removeGamedata(&gametable);
+	test_FreeConfig(&config);
+}
+
+static void benchRescan(){
+	/* Rescan of 5000 games with 10 changed, against a full scan */
+	
+	config_t config;
+	gamedir_t gamedir;
+	gametable_t first;
+	gametable_t rescan;
+	char path[TEST_PATH_SIZE];
+	double start;
+	double full_time;
+	double rescan_time;
+	long full_calls;
+	int i;
+	
+	test_MakeGames("Bench", 1000, 5000, 4);
+	for(i = 1000; i < 6000; i++){
+		sprintf(path, "Bench/GAME%04d", i);
+		test_SetTime(path, 0);
+	}
+	test_Config(&config, &gamedir, "A:\\Bench", 1);
+	
+	initGametable(&first);
+	dosshim_Reset();
+	start = test_Seconds();
+	TEST_CHECK(scanGamedirs(&config, &first, NULL, &test_scratch, NULL, NULL) == 5000);
+	full_time = test_Seconds() - start;
+	full_calls = dosshim_Total();
+	
+	for(i = 1000; i < 6000; i += 500){
+		sprintf(path, "Bench/GAME%04d", i);
+		test_SetTime(path, 40);
+	}
+	initGametable(&rescan);
+	dosshim_Reset();
+	start = test_Seconds();
+	TEST_CHECK(scanGamedirs(&config, &rescan, &first, &test_scratch, NULL, NULL) == 5000);
+	rescan_time = test_Seconds() - start;
+	
+	printf("scan: 5000 games, full scan %.3fs / %ld DOS calls, rescan of 10 changed %.3fs / %ld DOS calls\n", full_time, full_calls, rescan_time, dosshim_Total());
+	removeGamedata(&first);
+	removeGamedata(&rescan);
+	test_FreeConfig(&config);
+}
+
+int main(int argc, char **argv){
+	test_Init(argc, argv);
+	test_Root("scan");
+	testRescan();
+	testDiscovery();
+	if (test_bench){
+		benchRescan();
+	}
+	return test_Done("scan");
+}
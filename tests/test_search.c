@@ -0,0 +1,504 @@
+/* test_search.c, Host tests of type-ahead and fuzzy search for x68Launcher.
+ Copyright (C) 2020  John Snowdon
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <ctype.h>
+#include "test.h"
+
+static void mixedGames(gametable_t *gametable, int n){
+	/* A table of n games whose names are in upper, lower and mixed case */
+	
+	gamedata_t *gamedata;
+	char path[MAX_PATH_SIZE];
+	char name[MAX_NAME_SIZE];
+	int i;
+	int j;
+	
+	for(i = 0; i < n; i++){
+		gamedata = addGamedata(gametable);
+		sprintf(path, "A:\\Games\\GAME%04d", i);
+		test_Name(name, (int)(((long) i * 7919) % n));
+		for(j = 0; name[j] != '\0'; j++){
+			if ((i % 3) == 1){
+				name[j] = toupper((unsigned char) name[j]);
+			} else if ((i % 3) == 2){
+				name[j] = tolower((unsigned char) name[j]);
+			}
+		}
+		setGamedataPath(gametable, gamedata, path);
+		setGamedataName(gametable, gamedata, name);
+		gamedata->gameid = i;
+		gamedata->has_dat = 1;
+	}
+	sortGamedata(gametable);
+	indexGamedata(gametable);
+}
+
+static int startsWith(char *name, char *prefix){
+	// Reference: does a name start with a lower case prefix, ignoring case
+	
+	int i;
+	
+	for(i = 0; prefix[i] != '\0'; i++){
+		if (tolower((unsigned char) name[i]) != prefix[i]){
+			return 0;
+		}
+	}
+	return 1;
+}
+
+static int sameRange(gametable_t *gametable, char *prefix, int low, int high){
+	/* Check a range of the search index holds exactly the games whose names start with prefix */
+	
+	unsigned char *seen;
+	int same;
+	int n;
+	int i;
+	
+	seen = (unsigned char *) calloc(gametable->ids_size + 1, 1);
+	same = 1;
+	for(i = low; i < high; i++){
+		if (!startsWith(getGameid(gametable->search.order[i], gametable)->name, prefix) || seen[gametable->search.order[i]]){
+			same = 0;
+		}
+		seen[gametable->search.order[i]] = 1;
+	}
+	n = 0;
+	for(i = 0; i < gametable->size; i++){
+		if (startsWith(gametable->games[i].name, prefix)){
+			n++;
+		}
+	}
+	free(seen);
+	return same && (n == high - low);
+}
+
+static void testPrefix(){
+	/* Each keystroke narrows the range to every name starting with what has been typed, whatever its case */
+	
+	static char *typed[] = { "super blaster", "the ", "neo", "x", "dragon wars 1", "night zone 10", "" };
+	gametable_t gametable;
+	char prefix[MAXIMUM_SEARCH_SIZE];
+	char *name;
+	int low;
+	int high;
+	int full_low;
+	int full_high;
+	int same;
+	int t;
+	int i;
+	int j;
+	
+	initGametable(&gametable);
+	mixedGames(&gametable, 3000);
+	TEST_CHECK(search_Build(&gametable.search, &gametable) == SEARCH_OK);
+	TEST_CHECK(gametable.search.size == 3000);
+	
+	// Every game once, in order ignoring case
+	same = 1;
+	for(i = 1; i < gametable.search.size; i++){
+		if (strcasecmp(getGameid(gametable.search.order[i - 1], &gametable)->name, getGameid(gametable.search.order[i], &gametable)->name) > 0){
+			same = 0;
+		}
+	}
+	TEST_CHECK(same);
+	TEST_CHECK(sameRange(&gametable, "", 0, gametable.search.size));
+	
+	// Typing one character at a time, narrowing the last range each time
+	same = 1;
+	for(t = 0; typed[t][0] != '\0'; t++){
+		low = 0;
+		high = gametable.search.size;
+		for(i = 1; typed[t][i - 1] != '\0'; i++){
+			strncpy(prefix, typed[t], i);
+			prefix[i] = '\0';
+			search_Narrow(&gametable.search, &gametable, prefix, &low, &high);
+			full_low = 0;
+			full_high = gametable.search.size;
+			search_Narrow(&gametable.search, &gametable, prefix, &full_low, &full_high);
+			if (!sameRange(&gametable, prefix, low, high) || (low != full_low) || (high != full_high)){
+				same = 0;
+			}
+		}
+	}
+	TEST_CHECK(same);
+	
+	// The first few letters of every game
+	same = 1;
+	for(i = 0; i < gametable.size; i += 7){
+		name = gametable.games[i].name;
+		for(j = 0; (j < 6) && (name[j] != '\0'); j++){
+			prefix[j] = tolower((unsigned char) name[j]);
+		}
+		prefix[j] = '\0';
+		low = 0;
+		high = gametable.search.size;
+		if ((search_Narrow(&gametable.search, &gametable, prefix, &low, &high) < 1) || !sameRange(&gametable, prefix, low, high)){
+			same = 0;
+		}
+	}
+	TEST_CHECK(same);
+	
+	// Nothing starts with these
+	low = 0;
+	high = gametable.search.size;
+	TEST_CHECK(search_Narrow(&gametable.search, &gametable, "zzz", &low, &high) == 0);
+	low = 0;
+	high = gametable.search.size;
+	TEST_CHECK(search_Narrow(&gametable.search, &gametable, "0", &low, &high) == 0);
+	
+	removeGamedata(&gametable);
+}
+
+static void testTypeAhead(){
+	/* Typing into the browser selects the matching games, keeping any filter in use */
+	
+	gametable_t gametable;
+	state_t state;
+	launchdat_t *launchdat;
+	int same;
+	int n;
+	int i;
+	
+	initGametable(&gametable);
+	test_Games(&gametable, 2000);
+	test_Metadata(&gametable);
+	filter_StateInit(&state);
+	launchdat = test_NewLaunchdat();
+	filter_None(&state, &gametable);
+	
+	TEST_CHECK(filter_SearchReset(&state, &gametable) == FILTER_OK);
+	strcpy(state.search, "star");
+	TEST_CHECK(filter_Search(&state, &gametable) > 0);
+	same = (state.search_fuzzy == 0);
+	n = 0;
+	for(i = 0; i < gametable.size; i++){
+		if (startsWith(gametable.games[i].name, "star")){
+			n++;
+		}
+	}
+	for(i = 0; i < state.selected_max; i++){
+		if (!startsWith(getGameid(state.selected_list[i], &gametable)->name, "star")){
+			same = 0;
+		}
+	}
+	TEST_CHECK(same && (state.selected_max == n));
+	TEST_CHECK(state.selected_gameid == state.selected_list[0]);
+	
+	// Only the Puzzle games
+	filter_GetGenres(&state, &gametable, launchdat);
+	for(i = 0; i < state.available_filter_strings; i++){
+		if (strcmp(state.filter_strings[i], "Puzzle") == 0){
+			state.selected_filter_string = i;
+		}
+	}
+	filter_Genre(&state, &gametable, launchdat);
+	filter_SearchReset(&state, &gametable);
+	TEST_CHECK(filter_Search(&state, &gametable) > 0);
+	same = (state.selected_max < n);
+	for(i = 0; i < state.selected_max; i++){
+		if (!startsWith(getGameid(state.selected_list[i], &gametable)->name, "star") || (strcmp(meta_String(&gametable.meta, gametable.meta.genre[state.selected_list[i]]), "Puzzle") != 0)){
+			same = 0;
+		}
+	}
+	TEST_CHECK(same);
+	
+	// Nothing matches at all, so the selection is left alone
+	n = state.selected_max;
+	strcpy(state.search, "qqqq");
+	filter_SearchReset(&state, &gametable);
+	TEST_CHECK(filter_Search(&state, &gametable) == 0);
+	TEST_CHECK(state.selected_max == n);
+	
+	test_FreeLaunchdat(launchdat);
+	free(state.selected_list);
+	free(state.filter_bits);
+	filter_ClearStrings(&state);
+	free(state.filter_strings);
+	free(state.filter_counts);
+	free(state.filter_strings_selected);
+	for(i = 0; i < FILTER_CACHE_SIZE; i++){
+		free(state.filter_cache[i].bits);
+		free(state.filter_cache[i].list);
+	}
+	removeGamedata(&gametable);
+}
+
+static void benchPrefix(){
+	/* Typing a name into 10000 games, against testing every name on each keystroke */
+	
+	gametable_t gametable;
+	double start;
+	double build_time;
+	double narrow_time;
+	double linear_time;
+	char prefix[MAXIMUM_SEARCH_SIZE];
+	char *typed;
+	long total;
+	int low;
+	int high;
+	int r;
+	int i;
+	int g;
+	
+	initGametable(&gametable);
+	mixedGames(&gametable, 10000);
+	start = test_Seconds();
+	search_Build(&gametable.search, &gametable);
+	build_time = test_Seconds() - start;
+	
+	typed = "thunder knight 12";
+	total = 0;
+	start = test_Seconds();
+	for(r = 0; r < 1000; r++){
+		low = 0;
+		high = gametable.search.size;
+		for(i = 1; typed[i - 1] != '\0'; i++){
+			strncpy(prefix, typed, i);
+			prefix[i] = '\0';
+			total += search_Narrow(&gametable.search, &gametable, prefix, &low, &high);
+		}
+	}
+	narrow_time = (test_Seconds() - start) / 1000;
+	start = test_Seconds();
+	for(r = 0; r < 10; r++){
+		for(i = 1; typed[i - 1] != '\0'; i++){
+			strncpy(prefix, typed, i);
+			prefix[i] = '\0';
+			for(g = 0; g < gametable.size; g++){
+				total -= 100 * startsWith(gametable.games[g].name, prefix);
+			}
+		}
+	}
+	linear_time = (test_Seconds() - start) / 10;
+	TEST_CHECK(total == 0);
+	printf("search: index of 10000 names built in %.4fs; typing %d characters %.6fs, testing every name %.6fs\n", build_time, (int) strlen(typed), narrow_time, linear_time);
+	removeGamedata(&gametable);
+}
+
+static void fuzzyGames(gametable_t *gametable, int n){
+	/* n made up games, plus a few named in different ways, with their trigram index */
+	
+	static char *names[] = { "Chorensha", "Cho Ren Sha", "ChoRenSha68k", "Akumajou Dracula", "Akumajo Dracula X68k", "Star Wars", NULL };
+	gamedata_t *gamedata;
+	char path[MAX_PATH_SIZE];
+	char name[MAX_NAME_SIZE];
+	int i;
+	
+	for(i = 0; names[i] != NULL; i++){
+		gamedata = addGamedata(gametable);
+		sprintf(path, "A:\\Games\\EXTRA%d", i);
+		setGamedataPath(gametable, gamedata, path);
+		setGamedataName(gametable, gamedata, names[i]);
+		gamedata->gameid = i;
+	}
+	for(i = 0; i < n; i++){
+		gamedata = addGamedata(gametable);
+		sprintf(path, "A:\\Games\\GAME%04d", i);
+		test_Name(name, i);
+		setGamedataPath(gametable, gamedata, path);
+		setGamedataName(gametable, gamedata, name);
+		gamedata->gameid = gametable->size - 1;
+	}
+	sortGamedata(gametable);
+	indexGamedata(gametable);
+	search_BuildTrigrams(&gametable->trigrams, gametable);
+}
+
+static void foldTrigrams(char *s, char *folded){
+	// Reference: just the letters and digits of a string, in lower case
+	
+	int n;
+	
+	n = 0;
+	for(; *s != '\0'; s++){
+		if (isalnum((unsigned char) *s)){
+			folded[n] = tolower((unsigned char) *s);
+			n++;
+		}
+	}
+	folded[n] = '\0';
+}
+
+// Score and name length of each game for the reference fuzzy search
+static int *reference_score = NULL;
+static int *reference_length = NULL;
+
+static int compareFuzzy(const void *op1, const void *op2){
+	// Reference order: most trigrams in common, then the shorter name, then gameid
+	
+	int a;
+	int b;
+	
+	a = *(const int *) op1;
+	b = *(const int *) op2;
+	if (reference_score[a] != reference_score[b]){
+		return reference_score[b] - reference_score[a];
+	}
+	if (reference_length[a] != reference_length[b]){
+		return reference_length[a] - reference_length[b];
+	}
+	return a - b;
+}
+
+static int referenceFuzzy(gametable_t *gametable, char *query, int *results, int max){
+	/* Reference: score every game by the distinct trigrams of the query found in its name or directory */
+	
+	char folded[MAX_NAME_SIZE + MAX_PATH_SIZE];
+	char name[MAX_NAME_SIZE];
+	char dir[MAX_PATH_SIZE];
+	char trigram[4];
+	gamedata_t *gamedata;
+	int *list;
+	int trigrams;
+	int found;
+	int i;
+	int j;
+	int g;
+	
+	foldTrigrams(query, folded);
+	trigrams = (strlen(folded) > 2) ? strlen(folded) - 2 : 0;
+	reference_score = (int *) calloc(gametable->ids_size, sizeof(int));
+	reference_length = (int *) calloc(gametable->ids_size, sizeof(int));
+	list = (int *) malloc(gametable->ids_size * sizeof(int));
+	found = 0;
+	for(g = 0; g < gametable->size; g++){
+		gamedata = &gametable->games[g];
+		foldTrigrams(gamedata->name, name);
+		foldTrigrams(gamedata->dir, dir);
+		for(i = 0; i < trigrams; i++){
+			
+			// Each distinct trigram of the query counts once
+			for(j = 0; j < i; j++){
+				if (strncmp(folded + i, folded + j, 3) == 0){
+					break;
+				}
+			}
+			strncpy(trigram, folded + i, 3);
+			trigram[3] = '\0';
+			if ((j == i) && ((strstr(name, trigram) != NULL) || (strstr(dir, trigram) != NULL))){
+				reference_score[gamedata->gameid]++;
+			}
+		}
+		reference_length[gamedata->gameid] = strlen(gamedata->name);
+		if ((reference_score[gamedata->gameid] > 0) && ((reference_score[gamedata->gameid] * 2) >= trigrams)){
+			list[found] = gamedata->gameid;
+			found++;
+		}
+	}
+	qsort(list, found, sizeof(int), compareFuzzy);
+	if (found > max){
+		found = max;
+	}
+	memcpy(results, list, found * sizeof(int));
+	free(reference_score);
+	free(reference_length);
+	free(list);
+	reference_score = NULL;
+	reference_length = NULL;
+	return found;
+}
+
+static void testFuzzy(){
+	/* Fuzzy search finds names however they are spaced, ranked as scoring every game would */
+	
+	static char *queries[] = { "cho ren sha", "Chorensha", "CHO-REN-SHA 68K", "akumajo", "dracula x", "super blastr", "thunder nite 12", "galaxy saga", "extra3", "neo neo neo", "qqqq", "ab", "" };
+	gametable_t gametable;
+	int results[FILTER_FUZZY_MAX];
+	int expected[FILTER_FUZZY_MAX];
+	int found;
+	int same;
+	int max;
+	int q;
+	int i;
+	
+	initGametable(&gametable);
+	fuzzyGames(&gametable, 2000);
+	TEST_CHECK(gametable.trigrams.keys_size > 0);
+	
+	// "Cho Ren Sha" and "Chorensha" both find all three spellings first
+	found = search_Fuzzy(&gametable.trigrams, &gametable, "cho ren sha", results, 3);
+	same = (found == 3);
+	for(i = 0; (i < found) && same; i++){
+		same = (strncasecmp(getGameid(results[i], &gametable)->name, "Cho", 3) == 0);
+	}
+	TEST_CHECK(same);
+	TEST_CHECK(strcmp(getGameid(results[0], &gametable)->name, "Chorensha") == 0);
+	
+	same = 1;
+	for(max = 1; max <= FILTER_FUZZY_MAX; max += 13){
+		for(q = 0; q < (int)(sizeof(queries) / sizeof(char *)); q++){
+			found = search_Fuzzy(&gametable.trigrams, &gametable, queries[q], results, max);
+			if ((found != referenceFuzzy(&gametable, queries[q], expected, max)) || (memcmp(results, expected, found * sizeof(int)) != 0)){
+				printf("search: fuzzy search for [%s] differs from the reference\n", queries[q]);
+				same = 0;
+			}
+		}
+	}
+	TEST_CHECK(same);
+	TEST_CHECK(search_Fuzzy(&gametable.trigrams, &gametable, "qqqq", results, FILTER_FUZZY_MAX) == 0);
+	TEST_CHECK(search_Fuzzy(&gametable.trigrams, &gametable, "ab", results, FILTER_FUZZY_MAX) == 0);
+	
+	// The directory name counts as well as the name
+	found = search_Fuzzy(&gametable.trigrams, &gametable, "extra4", results, 1);
+	TEST_CHECK((found == 1) && (strcmp(getGameid(results[0], &gametable)->dir, "EXTRA4") == 0));
+	
+	removeGamedata(&gametable);
+}
+
+static void benchFuzzy(){
+	/* Fuzzy queries of 10000 titles, and the size of the trigram index */
+	
+	static char *queries[] = { "cho ren sha", "super blastr", "thunder nite 12", "galaxy saga", "dragon", "final fite 7" };
+	gametable_t gametable;
+	trigramindex_t *trigrams;
+	int results[FILTER_FUZZY_MAX];
+	double start;
+	double build_time;
+	double query_time;
+	long bytes;
+	int q;
+	int r;
+	
+	initGametable(&gametable);
+	fuzzyGames(&gametable, 10000);
+	trigrams = &gametable.trigrams;
+	start = test_Seconds();
+	search_BuildTrigrams(trigrams, &gametable);
+	build_time = test_Seconds() - start;
+	start = test_Seconds();
+	for(r = 0; r < 100; r++){
+		for(q = 0; q < 6; q++){
+			search_Fuzzy(trigrams, &gametable, queries[q], results, FILTER_FUZZY_MAX);
+		}
+	}
+	query_time = (test_Seconds() - start) / 600;
+	bytes = (trigrams->keys_size * (long)(sizeof(unsigned short) + sizeof(long))) + (trigrams->postings_size * (long) sizeof(unsigned short));
+	printf("search: trigrams of 10000 titles built in %.4fs, %d trigrams, %ld postings, %ld bytes; query %.6fs\n", build_time, trigrams->keys_size, trigrams->postings_size, bytes, query_time);
+	removeGamedata(&gametable);
+}
+
+int main(int argc, char **argv){
+	test_Init(argc, argv);
+	testPrefix();
+	testTypeAhead();
+	testFuzzy();
+	if (test_bench){
+		benchPrefix();
+		benchFuzzy();
+	}
+	return test_Done("search");
+}
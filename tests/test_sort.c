@@ -0,0 +1,348 @@
+/* test_sort.c, Host tests of game sorting for x68Launcher.
+ Copyright (C) 2020  John Snowdon
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "test.h"
+#include "collate.h"
+
+static void referenceSort(char **names, int *order, int n){
+	// Reference: insertion sort of positions by collate_Compare(), which is stable
+	
+	int i;
+	int j;
+	int t;
+	
+	for(i = 0; i < n; i++){
+		order[i] = i;
+	}
+	for(i = 1; i < n; i++){
+		t = order[i];
+		j = i - 1;
+		while ((j >= 0) && (collate_Compare(names[order[j]], names[t]) > 0)){
+			order[j + 1] = order[j];
+			j--;
+		}
+		order[j + 1] = t;
+	}
+}
+
+static void randomName(char *name){
+	/* A name from a small set, so that there are plenty of ties, in either case */
+	
+	static const char *words[] = { "Alpha", "alpha", "Beta", "The Beta", "Gamma 2", "Gamma 10", "gamma 9", "Delta" };
+	
+	sprintf(name, "%s %d", words[test_Random(8)], test_Random(6));
+}
+
+static int sortMatches(int n){
+	/* Sort n games with sortGamedata() and compare the order with the reference */
+	
+	gametable_t gametable;
+	gamedata_t *gamedata;
+	char path[MAX_PATH_SIZE];
+	char name[MAX_NAME_SIZE];
+	char **names;
+	int *order;
+	int same;
+	int i;
+	
+	initGametable(&gametable);
+	names = (char **) malloc((n + 1) * sizeof(char *));
+	order = (int *) malloc((n + 1) * sizeof(int));
+	for(i = 0; i < n; i++){
+		gamedata = addGamedata(&gametable);
+		sprintf(path, "A:\\Games\\GAME%04d", i);
+		randomName(name);
+		setGamedataPath(&gametable, gamedata, path);
+		setGamedataName(&gametable, gamedata, name);
+		gamedata->gameid = i;					// As findDirs() hands them out
+		gamedata->stamp = i;					// Where it was before sorting
+		names[i] = gamedata->name;
+	}
+	referenceSort(names, order, n);
+	
+	same = (sortGamedata(&gametable) == 0);
+	for(i = 0; i < n; i++){
+		gamedata = &gametable.games[i];
+		if ((gamedata->stamp != order[i]) || (gamedata->gameid != i)){
+			same = 0;
+		}
+		sprintf(path, "GAME%04d", order[i]);
+		if ((strcmp(gamedata->dir, path) != 0) || (gamedata->name != names[order[i]])){
+			same = 0;
+		}
+	}
+	free(names);
+	free(order);
+	removeGamedata(&gametable);
+	return same;
+}
+
+static void testSortGamedata(){
+	/* sortGamedata() gives the same, stable, order as the reference for every size up to 70, and some larger */
+	
+	int n;
+	int ok;
+	
+	ok = 1;
+	for(n = 0; n <= 70; n++){
+		if (!sortMatches(n)){
+			printf("sort: sortGamedata() differs from the reference for %d games\n", n);
+			ok = 0;
+		}
+	}
+	TEST_CHECK(ok);
+	TEST_CHECK(sortMatches(127));
+	TEST_CHECK(sortMatches(128));
+	TEST_CHECK(sortMatches(129));
+	TEST_CHECK(sortMatches(1000));
+}
+
+static void benchSortGamedata(){
+	/* Sorting 10000 games, against the reference insertion sort of 3000 */
+	
+	gametable_t gametable;
+	gamedata_t *gamedata;
+	char path[MAX_PATH_SIZE];
+	char name[MAX_NAME_SIZE];
+	char **names;
+	int *order;
+	double start;
+	double sort_time;
+	double reference_time;
+	int i;
+	
+	initGametable(&gametable);
+	for(i = 0; i < 10000; i++){
+		gamedata = addGamedata(&gametable);
+		sprintf(path, "A:\\Games\\GAME%04d", i);
+		test_Name(name, (int)(((long) i * 7919) % 10000));
+		setGamedataPath(&gametable, gamedata, path);
+		setGamedataName(&gametable, gamedata, name);
+		gamedata->gameid = i;
+	}
+	names = (char **) malloc(3000 * sizeof(char *));
+	order = (int *) malloc(3000 * sizeof(int));
+	for(i = 0; i < 3000; i++){
+		names[i] = gametable.games[i].name;
+	}
+	
+	start = test_Seconds();
+	sortGamedata(&gametable);
+	sort_time = test_Seconds() - start;
+	start = test_Seconds();
+	referenceSort(names, order, 3000);
+	reference_time = test_Seconds() - start;
+	printf("sort: sortGamedata() of 10000 games %.4fs, reference insertion sort of 3000 %.4fs\n", sort_time, reference_time);
+	
+	free(names);
+	free(order);
+	removeGamedata(&gametable);
+}
+
+// Sort key of each game for the reference orders; a string, or NULL to sort last
+static char **reference_keys = NULL;
+
+static int compareReference(const void *op1, const void *op2){
+	// Reference order: by key, with missing keys last, then by gameid
+	
+	int a;
+	int b;
+	int compare;
+	
+	a = *(const int *) op1;
+	b = *(const int *) op2;
+	if ((reference_keys[a] != NULL) && (reference_keys[b] != NULL)){
+		compare = collate_Compare(reference_keys[a], reference_keys[b]);
+		if (compare != 0){
+			return compare;
+		}
+	} else if (reference_keys[a] != NULL){
+		return -1;
+	} else if (reference_keys[b] != NULL){
+		return 1;
+	}
+	return (a < b) ? -1 : (a > b);
+}
+
+static void referenceOrder(gametable_t *gametable, int order, int *list){
+	/* Work out an order of every game the slow way, from the metadata strings */
+	
+	metaindex_t *meta;
+	unsigned short *column;
+	char (*years)[8];
+	int n;
+	int g;
+	
+	meta = &gametable->meta;
+	n = meta->size;
+	reference_keys = (char **) malloc(n * sizeof(char *));
+	years = malloc(n * 8);
+	column = (order == SORT_PUBLISHER) ? meta->publisher : ((order == SORT_DEVELOPER) ? meta->developer : meta->genre);
+	for(g = 0; g < n; g++){
+		list[g] = g;
+		reference_keys[g] = NULL;
+		if (meta->state[g] != META_STATE_LOADED){
+			continue;
+		}
+		if (order == SORT_YEAR){
+			if (meta->year[g] > 0){
+				sprintf(years[g], "%d", meta->year[g]);
+				reference_keys[g] = years[g];
+			}
+		} else if (column[g] != META_NONE){
+			reference_keys[g] = meta_String(meta, column[g]);
+		}
+	}
+	qsort(list, n, sizeof(int), compareReference);
+	free(reference_keys);
+	free(years);
+	reference_keys = NULL;
+}
+
+static void testOrders(){
+	/* Every order built by sort_Build() matches the reference, for every game or a subset */
+	
+	gametable_t gametable;
+	unsigned long *bits;
+	int *list;
+	int *expected;
+	int words;
+	int order;
+	int same;
+	int n;
+	int i;
+	int j;
+	
+	initGametable(&gametable);
+	test_Games(&gametable, 2000);
+	test_Metadata(&gametable);
+	
+	// Some games have no launch.dat at all
+	for(i = 0; i < gametable.meta.size; i += 13){
+		gametable.meta.state[i] = META_STATE_MISSING;
+	}
+	TEST_CHECK(sort_Build(&gametable.sort, &gametable) == SORT_OK);
+	
+	list = (int *) malloc(2000 * sizeof(int));
+	expected = (int *) malloc(2000 * sizeof(int));
+	words = meta_BitsetWords(&gametable.meta);
+	bits = (unsigned long *) calloc(words, sizeof(unsigned long));
+	for(i = 0; i < 2000; i += 3){
+		bits[i / META_BITSET_BITS] |= 1UL << (i % META_BITSET_BITS);
+	}
+	for(order = SORT_YEAR; order <= SORT_GENRE; order++){
+		referenceOrder(&gametable, order, expected);
+		n = sort_List(&gametable.sort, order, NULL, 0, list);
+		TEST_CHECK((n == 2000) && (memcmp(list, expected, n * sizeof(int)) == 0));
+		
+		// The same order, of every third game
+		n = sort_List(&gametable.sort, order, bits, words, list);
+		same = (n == 667);
+		for(i = 0, j = 0; (i < 2000) && same; i++){
+			if ((expected[i] % 3) == 0){
+				same = (list[j] == expected[i]);
+				j++;
+			}
+		}
+		TEST_CHECK(same);
+	}
+	
+	// Name order is gameid order, and is never a built permutation
+	n = sort_List(&gametable.sort, SORT_NAME, bits, words, list);
+	same = (n == 667);
+	for(i = 0; (i < n) && same; i++){
+		same = (list[i] == i * 3);
+	}
+	TEST_CHECK(same);
+	TEST_CHECK(sort_List(&gametable.sort, SORT_NAME, NULL, 0, list) == 0);
+	
+	free(bits);
+	free(list);
+	free(expected);
+	removeGamedata(&gametable);
+}
+
+static void testRecent(){
+	/* Recently played games come first, most recent first, then the rest by name */
+	
+	gametable_t gametable;
+	int list[100];
+	int same;
+	int i;
+	
+	initGametable(&gametable);
+	test_Games(&gametable, 100);
+	test_Metadata(&gametable);
+	TEST_CHECK(sort_AddRecent(getGameid(40, &gametable)) == SORT_OK);
+	TEST_CHECK(sort_AddRecent(getGameid(7, &gametable)) == SORT_OK);
+	TEST_CHECK(sort_AddRecent(getGameid(90, &gametable)) == SORT_OK);
+	TEST_CHECK(sort_AddRecent(getGameid(40, &gametable)) == SORT_OK);
+	TEST_CHECK(sort_Build(&gametable.sort, &gametable) == SORT_OK);
+	
+	TEST_CHECK(sort_List(&gametable.sort, SORT_RECENT, NULL, 0, list) == 100);
+	TEST_CHECK((list[0] == 40) && (list[1] == 90) && (list[2] == 7));
+	same = 1;
+	for(i = 4; i < 100; i++){
+		if (list[i] <= list[i - 1]){
+			same = 0;
+		}
+	}
+	TEST_CHECK(same && (list[3] == 0));
+	removeGamedata(&gametable);
+}
+
+static void benchOrders(){
+	/* Building every order of 10000 games, and listing each of them */
+	
+	gametable_t gametable;
+	int *list;
+	double start;
+	double build_time;
+	double list_time;
+	int order;
+	
+	initGametable(&gametable);
+	test_Games(&gametable, 10000);
+	test_Metadata(&gametable);
+	list = (int *) malloc(10000 * sizeof(int));
+	
+	start = test_Seconds();
+	TEST_CHECK(sort_Build(&gametable.sort, &gametable) == SORT_OK);
+	build_time = test_Seconds() - start;
+	start = test_Seconds();
+	for(order = SORT_YEAR; order <= SORT_MAX; order++){
+		sort_List(&gametable.sort, order, NULL, 0, list);
+	}
+	list_time = (test_Seconds() - start) / SORT_MAX;
+	printf("sort: sort_Build() of 10000 games %.4fs, changing order %.6fs\n", build_time, list_time);
+	
+	free(list);
+	removeGamedata(&gametable);
+}
+
+int main(int argc, char **argv){
+	test_Init(argc, argv);
+	test_Root("sort");
+	testSortGamedata();
+	testOrders();
+	testRecent();
+	if (test_bench){
+		benchSortGamedata();
+		benchOrders();
+	}
+	return test_Done("sort");
+}
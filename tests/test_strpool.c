@@ -0,0 +1,258 @@
+/* test_strpool.c, Host tests of the string pool and interned strings for x68Launcher.
+ Copyright (C) 2020  John Snowdon
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "test.h"
+
+static void testPool(){
+	/* Strings never move once stored, however many blocks the pool grows to */
+	
+	strpool_t pool;
+	char **stored;
+	char buffer[STRPOOL_BLOCK_SIZE * 2];
+	char *p;
+	char *q;
+	int same;
+	int i;
+	
+	strpool_Init(&pool);
+	TEST_CHECK(pool.block == NULL);
+	
+	stored = (char **) malloc(20000 * sizeof(char *));
+	for(i = 0; i < 20000; i++){
+		sprintf(buffer, "String number %d", i);
+		stored[i] = strpool_Add(&pool, buffer);
+	}
+	same = 1;
+	for(i = 0; i < 20000; i++){
+		sprintf(buffer, "String number %d", i);
+		if ((stored[i] == NULL) || (strcmp(stored[i], buffer) != 0)){
+			same = 0;
+		}
+	}
+	TEST_CHECK(same);
+	TEST_CHECK(pool.strings == 20000);
+	TEST_CHECK(pool.bytes_allocated >= pool.bytes_used);
+	
+	// Only part of a string, and one bigger than a block
+	p = strpool_AddLength(&pool, "FinalFight", 5);
+	TEST_CHECK(strcmp(p, "Final") == 0);
+	memset(buffer, 'x', sizeof(buffer) - 1);
+	buffer[sizeof(buffer) - 1] = '\0';
+	p = strpool_Add(&pool, buffer);
+	TEST_CHECK((p != NULL) && (strlen(p) == sizeof(buffer) - 1));
+	
+	// Prefixes are stored once
+	p = strpool_AddPrefix(&pool, "A:\\Games\\FinalFight", 9);
+	q = strpool_AddPrefix(&pool, "A:\\Games\\Gradius", 9);
+	TEST_CHECK((p == q) && (strcmp(p, "A:\\Games\\") == 0));
+	q = strpool_AddPrefix(&pool, "A:\\GamesX\\Gradius", 10);
+	TEST_CHECK((p != q) && (strcmp(q, "A:\\GamesX\\") == 0));
+	TEST_CHECK(pool.shared == 1);
+	
+	strpool_Free(&pool);
+	TEST_CHECK((pool.block == NULL) && (pool.strings == 0) && (pool.bytes_allocated == 0));
+	free(stored);
+}
+
+static void testBytesPerGame(){
+	/* Memory used by a realistic table of 3000 games, against a fixed size entry per game */
+	
+	static const char *paths[] = { "A:\\Games\\", "C:\\Games\\Shooters\\", "D:\\More\\" };
+	gametable_t gametable;
+	gamedata_t *gamedata;
+	char path[MAX_PATH_SIZE];
+	char name[MAX_NAME_SIZE];
+	long before;
+	long after;
+	int shared;
+	int i;
+	
+	initGametable(&gametable);
+	for(i = 0; i < 3000; i++){
+		gamedata = addGamedata(&gametable);
+		sprintf(path, "%sGAME%d", paths[i % 3], i);
+		setGamedataPath(&gametable, gamedata, path);
+		
+		// Most games have a realname preloaded from launch.dat
+		if ((i % 10) < 7){
+			test_Name(name, i);
+			setGamedataName(&gametable, gamedata, name);
+		} else {
+			setGamedataName(&gametable, gamedata, gamedata->dir);
+		}
+		gamedata->gameid = i;
+	}
+	
+	// One copy of each search path prefix, and no copy of a name that is the directory
+	shared = 1;
+	for(i = 3; i < gametable.size; i++){
+		if (gametable.games[i].prefix != gametable.games[i % 3].prefix){
+			shared = 0;
+		}
+		if (((i % 10) >= 7) && (gametable.games[i].name != gametable.games[i].dir)){
+			shared = 0;
+		}
+	}
+	TEST_CHECK(shared);
+	TEST_CHECK(gametable.strings.shared == 3000 - 3);
+	
+	// A fixed size entry per game, as each game used to be; a linked list of
+	// separately allocated entries each holding the full path and name
+	before = 3000L * (sizeof(int) + sizeof(char) + MAX_PATH_SIZE + MAX_NAME_SIZE + sizeof(int) + sizeof(void *));
+	after = (gametable.capacity * sizeof(gamedata_t)) + gametable.strings.bytes_allocated;
+	TEST_CHECK(after < before);
+	
+	// The strings themselves, which were most of each entry, take a quarter of the space
+	TEST_CHECK(gametable.strings.bytes_allocated < 3000L * (MAX_PATH_SIZE + MAX_NAME_SIZE) / 4);
+	printf("strpool: 3000 games, %ld bytes per game before, %ld bytes per game now (%d byte entries, %ld bytes of strings)\n", before / 3000, after / 3000, (int) sizeof(gamedata_t), gametable.strings.bytes_allocated);
+	removeGamedata(&gametable);
+}
+
+static int referenceIntern(char **list, int *size, char *s){
+	// Reference: linear search of every distinct string so far, as the filters used to do
+	
+	int i;
+	
+	for(i = 0; i < *size; i++){
+		if (strncmp(list[i], s, MAX_STRING_SIZE - 1) == 0){
+			return i + 1;
+		}
+	}
+	list[*size] = s;
+	*size += 1;
+	return *size;
+}
+
+static void testIntern(){
+	/* 10000 games with 300 distinct values intern to the same ids as a linear search would give */
+	
+	metaindex_t meta;
+	char (*values)[MAX_STRING_SIZE];
+	char **list;
+	char value[64];
+	char other[64];
+	int size;
+	int same;
+	int id;
+	int i;
+	
+	meta_Init(&meta);
+	values = malloc(300 * MAX_STRING_SIZE);
+	list = (char **) malloc(300 * sizeof(char *));
+	for(i = 0; i < 300; i++){
+		sprintf(values[i], "Company %d", (i * 7) % 300);
+	}
+	size = 0;
+	same = 1;
+	for(i = 0; i < 10000; i++){
+		id = meta_Intern(&meta, values[(i * 31) % 300]);
+		if ((id != referenceIntern(list, &size, values[(i * 31) % 300])) || (strcmp(meta_String(&meta, id), values[(i * 31) % 300]) != 0)){
+			same = 0;
+		}
+	}
+	TEST_CHECK(same);
+	TEST_CHECK(meta.strings_size == 301);
+	same = 1;
+	for(i = 0; i < 300; i++){
+		if (meta_Find(&meta, list[i]) != i + 1){
+			same = 0;
+		}
+	}
+	TEST_CHECK(same);
+	
+	// Empty and unknown strings
+	TEST_CHECK(meta_Intern(&meta, "") == META_NONE);
+	TEST_CHECK(meta_Find(&meta, "") == META_NONE);
+	TEST_CHECK(meta_Find(&meta, "Company 300") == META_NONE);
+	TEST_CHECK(strcmp(meta_String(&meta, META_NONE), "") == 0);
+	
+	// Only the characters a launchdat_t field holds count
+	memset(value, 'a', 40);
+	value[40] = '\0';
+	strcpy(other, value);
+	other[35] = 'b';
+	id = meta_Intern(&meta, value);
+	TEST_CHECK(meta_Intern(&meta, other) == id);
+	TEST_CHECK(strlen(meta_String(&meta, id)) == MAX_STRING_SIZE - 1);
+	
+	// Many more strings than the hash table starts with
+	same = 1;
+	for(i = 0; i < 20000; i++){
+		sprintf(value, "Series %d", i);
+		id = meta_Intern(&meta, value);
+		if ((id < 1) || (strcmp(meta_String(&meta, id), value) != 0) || (meta_Find(&meta, value) != id)){
+			same = 0;
+		}
+	}
+	TEST_CHECK(same);
+	TEST_CHECK(meta.strings_size == 301 + 1 + 20000);
+	TEST_CHECK(meta.hash_size >= meta.strings_size * 2);
+	
+	meta_Free(&meta);
+	free(values);
+	free(list);
+}
+
+static void benchIntern(){
+	/* Interning 10000 games x 300 distinct values, against a linear search */
+	
+	metaindex_t meta;
+	char (*values)[MAX_STRING_SIZE];
+	char **list;
+	double start;
+	double intern_time;
+	double linear_time;
+	long total;
+	int size;
+	int i;
+	
+	meta_Init(&meta);
+	values = malloc(300 * MAX_STRING_SIZE);
+	list = (char **) malloc(300 * sizeof(char *));
+	for(i = 0; i < 300; i++){
+		sprintf(values[i], "Software House %d", i);
+	}
+	total = 0;
+	start = test_Seconds();
+	for(i = 0; i < 10000; i++){
+		total += meta_Intern(&meta, values[(i * 31) % 300]);
+	}
+	intern_time = test_Seconds() - start;
+	size = 0;
+	start = test_Seconds();
+	for(i = 0; i < 10000; i++){
+		total -= referenceIntern(list, &size, values[(i * 31) % 300]);
+	}
+	linear_time = test_Seconds() - start;
+	TEST_CHECK(total == 0);
+	printf("strpool: 10000 x 300 values, interned %.5fs, linear search %.5fs\n", intern_time, linear_time);
+	
+	meta_Free(&meta);
+	free(values);
+	free(list);
+}
+
+int main(int argc, char **argv){
+	test_Init(argc, argv);
+	testPool();
+	testBytesPerGame();
+	testIntern();
+	if (test_bench){
+		benchIntern();
+	}
+	return test_Done("strpool");
+}